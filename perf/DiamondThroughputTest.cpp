@@ -0,0 +1,213 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <memory>
+
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "Util.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/BlockingQueue.hpp"
+#include "support/Events.hpp"
+
+/**
+ * Produce an event replicated to two event processors and fold back to a single third event processor.
+ *
+ * <pre>
+ *           +-----+
+ *    +----->| EP1 |------+
+ *    |      +-----+      |
+ *    |                   v
+ * +----+              +-----+
+ * | P1 |              | EP3 |
+ * +----+              +-----+
+ *    |                   ^
+ *    |      +-----+      |
+ *    +----->| EP2 |------+
+ *           +-----+
+ * </pre>
+ */
+namespace varont {
+namespace perf {
+
+enum class FizzBuzzStep {
+  Fizz,
+  Buzz,
+  FizzBuzz
+};
+
+class FizzBuzzEventHandler
+  : public LifecycleAwareEventHandler<FizzBuzzEvent>
+{
+  const FizzBuzzStep step_;
+  long fizzBuzzCounter_;
+
+public:
+  FizzBuzzEventHandler(const FizzBuzzStep step)
+    : step_(step)
+    , fizzBuzzCounter_(0L)
+  {}
+
+  void onEvent(FizzBuzzEvent& event, long sequence, bool endOfBatch) {
+    switch (step_) {
+    case FizzBuzzStep::Fizz:
+      event.fizz = (0L == (event.value % 3L));
+      break;
+    case FizzBuzzStep::Buzz:
+      event.buzz = (0L == (event.value % 5L));
+      break;
+    case FizzBuzzStep::FizzBuzz:
+      if (event.fizz && event.buzz) {
+        ++fizzBuzzCounter_;
+      }
+      break;
+    }
+  }
+
+  long getFizzBuzzCounter() const {
+    return fizzBuzzCounter_;
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+class DiamondThroughputTest {
+  static const char* name() { return "DiamondThroughput"; }
+
+  static long expectedResult(const long iterations) {
+    long result = 0L;
+    for (long i = 0; i < iterations; ++i) {
+      if (0L == (i % 3L) && 0L == (i % 5L)) {
+        ++result;
+      }
+    }
+    return result;
+  }
+
+public:
+  /** Threads the scenario runs, the publisher included. */
+  static const int NUM_THREADS = 4;
+
+  template <typename Claim, typename Wait>
+  void run(const Options& options) {
+    const long expected = expectedResult(options.iterations);
+
+    for (int run = 0; run < options.runs; ++run) {
+      Claim claimStrategy(options.bufferSize);
+      Wait waitStrategy;
+      RingBuffer<FizzBuzzEvent> ringBuffer(claimStrategy, waitStrategy);
+
+      FizzBuzzEventHandler fizzHandler(FizzBuzzStep::Fizz);
+      FizzBuzzEventHandler buzzHandler(FizzBuzzStep::Buzz);
+      FizzBuzzEventHandler fizzBuzzHandler(FizzBuzzStep::FizzBuzz);
+
+      std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+      BatchEventProcessor<FizzBuzzEvent> fizzProcessor(ringBuffer, *sequenceBarrier, fizzHandler);
+      BatchEventProcessor<FizzBuzzEvent> buzzProcessor(ringBuffer, *sequenceBarrier, buzzHandler);
+
+      std::unique_ptr<SequenceBarrier> fizzBuzzBarrier =
+        ringBuffer.newBarrier({ &fizzProcessor.getSequence(), &buzzProcessor.getSequence() });
+      BatchEventProcessor<FizzBuzzEvent> fizzBuzzProcessor(ringBuffer, *fizzBuzzBarrier, fizzBuzzHandler);
+
+      ringBuffer.setGatingSequences({ &fizzBuzzProcessor.getSequence() });
+
+      std::thread fizzThread(std::ref(fizzProcessor));
+      std::thread buzzThread(std::ref(buzzProcessor));
+      std::thread fizzBuzzThread(std::ref(fizzBuzzProcessor));
+
+      const long start = util::nanoTime();
+      for (long i = 0; i < options.iterations; ++i) {
+        long sequence = ringBuffer.next();
+        ringBuffer.get(sequence).value = i;
+        ringBuffer.publish(sequence);
+      }
+      waitForSequence(fizzBuzzProcessor.getSequence(), options.iterations - 1L);
+      const long elapsed = util::nanoTime() - start;
+
+      fizzProcessor.halt();
+      buzzProcessor.halt();
+      fizzBuzzProcessor.halt();
+      fizzThread.join();
+      buzzThread.join();
+      fizzBuzzThread.join();
+
+      reportThroughput(name(), "RingBuffer", StrategyName<Claim>::get(), StrategyName<Wait>::get(),
+                       run, options.iterations, elapsed, expected == fizzBuzzHandler.getFizzBuzzCounter());
+    }
+  }
+
+  void runQueue(const Options& options) {
+    const long expected = expectedResult(options.iterations);
+
+    for (int run = 0; run < options.runs; ++run) {
+      BlockingQueue<long> fizzInputQueue(options.bufferSize);
+      BlockingQueue<long> buzzInputQueue(options.bufferSize);
+      BlockingQueue<bool> fizzOutputQueue(options.bufferSize);
+      BlockingQueue<bool> buzzOutputQueue(options.bufferSize);
+      long fizzBuzzCounter = 0L;
+
+      const long start = util::nanoTime();
+      std::thread fizzThread([&] {
+          for (long i = 0; i < options.iterations; ++i) {
+            fizzOutputQueue.put(0L == (fizzInputQueue.take() % 3L));
+          }
+        });
+      std::thread buzzThread([&] {
+          for (long i = 0; i < options.iterations; ++i) {
+            buzzOutputQueue.put(0L == (buzzInputQueue.take() % 5L));
+          }
+        });
+      std::thread fizzBuzzThread([&] {
+          for (long i = 0; i < options.iterations; ++i) {
+            const bool fizz = fizzOutputQueue.take();
+            const bool buzz = buzzOutputQueue.take();
+            if (fizz && buzz) {
+              ++fizzBuzzCounter;
+            }
+          }
+        });
+
+      for (long i = 0; i < options.iterations; ++i) {
+        fizzInputQueue.put(i);
+        buzzInputQueue.put(i);
+      }
+      fizzThread.join();
+      buzzThread.join();
+      fizzBuzzThread.join();
+      const long elapsed = util::nanoTime() - start;
+
+      reportThroughput(name(), "BlockingQueue", nullptr, nullptr,
+                       run, options.iterations, elapsed, expected == fizzBuzzCounter);
+    }
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::Options options(1000L * 1000L * 10L);
+  options.parse(argc, argv);
+
+  varont::perf::DiamondThroughputTest test;
+  varont::perf::runWithEachStrategy(test, options, true);
+  test.runQueue(options);
+
+  return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <memory>
+
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "Util.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/BlockingQueue.hpp"
+#include "support/ValueMutationHandler.hpp"
+#include "support/Events.hpp"
+
+/**
+ * UniCast a series of items between 1 publisher and 1 event processor.
+ *
+ * <pre>
+ * +----+    +-----+
+ * | P1 |--->| EP1 |
+ * +----+    +-----+
+ * </pre>
+ */
+namespace varont {
+namespace perf {
+
+class OneToOneThroughputTest {
+  static const char* name() { return "OneToOneThroughput"; }
+
+  static long expectedResult(const long iterations) {
+    long result = 0L;
+    for (long i = 0; i < iterations; ++i) {
+      result = applyOperation(Operation::Addition, result, i);
+    }
+    return result;
+  }
+
+public:
+  /** Threads the scenario runs, the publisher included. */
+  static const int NUM_THREADS = 2;
+
+  template <typename Claim, typename Wait>
+  void run(const Options& options) {
+    const long expected = expectedResult(options.iterations);
+
+    for (int run = 0; run < options.runs; ++run) {
+      Claim claimStrategy(options.bufferSize);
+      Wait waitStrategy;
+      RingBuffer<ValueEvent> ringBuffer(claimStrategy, waitStrategy);
+      std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+      ValueMutationHandler handler(Operation::Addition);
+      BatchEventProcessor<ValueEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+      ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+      std::thread processorThread(std::ref(batchEventProcessor));
+
+      const long start = util::nanoTime();
+      for (long i = 0; i < options.iterations; ++i) {
+        long sequence = ringBuffer.next();
+        ringBuffer.get(sequence).value = i;
+        ringBuffer.publish(sequence);
+      }
+      waitForSequence(batchEventProcessor.getSequence(), options.iterations - 1L);
+      const long elapsed = util::nanoTime() - start;
+
+      batchEventProcessor.halt();
+      processorThread.join();
+
+      reportThroughput(name(), "RingBuffer", StrategyName<Claim>::get(), StrategyName<Wait>::get(),
+                       run, options.iterations, elapsed, expected == handler.getValue());
+    }
+  }
+
+  void runQueue(const Options& options) {
+    const long expected = expectedResult(options.iterations);
+
+    for (int run = 0; run < options.runs; ++run) {
+      BlockingQueue<long> queue(options.bufferSize);
+      long result = 0L;
+
+      const long start = util::nanoTime();
+      std::thread consumerThread([&] {
+          for (long i = 0; i < options.iterations; ++i) {
+            result = applyOperation(Operation::Addition, result, queue.take());
+          }
+        });
+
+      for (long i = 0; i < options.iterations; ++i) {
+        queue.put(i);
+      }
+      consumerThread.join();
+      const long elapsed = util::nanoTime() - start;
+
+      reportThroughput(name(), "BlockingQueue", nullptr, nullptr,
+                       run, options.iterations, elapsed, expected == result);
+    }
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::Options options(1000L * 1000L * 10L);
+  options.parse(argc, argv);
+
+  varont::perf::OneToOneThroughputTest test;
+  varont::perf::runWithEachStrategy(test, options, true);
+  test.runQueue(options);
+
+  return 0;
+}
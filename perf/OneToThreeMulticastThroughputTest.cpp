@@ -0,0 +1,173 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <memory>
+#include <vector>
+
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "Util.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/BlockingQueue.hpp"
+#include "support/ValueMutationHandler.hpp"
+#include "support/Events.hpp"
+
+/**
+ * MultiCast a series of items between 1 publisher and 3 event processors.
+ *
+ * <pre>
+ *           +-----+
+ *    +----->| EP1 |
+ *    |      +-----+
+ *    |
+ * +----+    +-----+
+ * | P1 |--->| EP2 |
+ * +----+    +-----+
+ *    |
+ *    |      +-----+
+ *    +----->| EP3 |
+ *           +-----+
+ * </pre>
+ */
+namespace varont {
+namespace perf {
+
+class OneToThreeMulticastThroughputTest {
+  static const int NUM_CONSUMERS = 3;
+
+  static const char* name() { return "OneToThreeMulticastThroughput"; }
+
+  static Operation operation(const int index) {
+    static const Operation operations[NUM_CONSUMERS] = {
+      Operation::Addition, Operation::Subtraction, Operation::And
+    };
+    return operations[index];
+  }
+
+  static long expectedResult(const Operation operation, const long iterations) {
+    long result = 0L;
+    for (long i = 0; i < iterations; ++i) {
+      result = applyOperation(operation, result, i);
+    }
+    return result;
+  }
+
+public:
+  /** Threads the scenario runs, the publisher included. */
+  static const int NUM_THREADS = 4;
+
+  template <typename Claim, typename Wait>
+  void run(const Options& options) {
+    for (int run = 0; run < options.runs; ++run) {
+      Claim claimStrategy(options.bufferSize);
+      Wait waitStrategy;
+      RingBuffer<ValueEvent> ringBuffer(claimStrategy, waitStrategy);
+      std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+
+      ValueMutationHandler handler0(operation(0));
+      ValueMutationHandler handler1(operation(1));
+      ValueMutationHandler handler2(operation(2));
+      BatchEventProcessor<ValueEvent> processor0(ringBuffer, *sequenceBarrier, handler0);
+      BatchEventProcessor<ValueEvent> processor1(ringBuffer, *sequenceBarrier, handler1);
+      BatchEventProcessor<ValueEvent> processor2(ringBuffer, *sequenceBarrier, handler2);
+      ringBuffer.setGatingSequences({
+          &processor0.getSequence(), &processor1.getSequence(), &processor2.getSequence()
+        });
+
+      std::thread thread0(std::ref(processor0));
+      std::thread thread1(std::ref(processor1));
+      std::thread thread2(std::ref(processor2));
+
+      const long start = util::nanoTime();
+      for (long i = 0; i < options.iterations; ++i) {
+        long sequence = ringBuffer.next();
+        ringBuffer.get(sequence).value = i;
+        ringBuffer.publish(sequence);
+      }
+      waitForSequence(processor0.getSequence(), options.iterations - 1L);
+      waitForSequence(processor1.getSequence(), options.iterations - 1L);
+      waitForSequence(processor2.getSequence(), options.iterations - 1L);
+      const long elapsed = util::nanoTime() - start;
+
+      processor0.halt();
+      processor1.halt();
+      processor2.halt();
+      thread0.join();
+      thread1.join();
+      thread2.join();
+
+      const bool valid = expectedResult(operation(0), options.iterations) == handler0.getValue()
+        && expectedResult(operation(1), options.iterations) == handler1.getValue()
+        && expectedResult(operation(2), options.iterations) == handler2.getValue();
+
+      reportThroughput(name(), "RingBuffer", StrategyName<Claim>::get(), StrategyName<Wait>::get(),
+                       run, options.iterations, elapsed, valid);
+    }
+  }
+
+  void runQueue(const Options& options) {
+    for (int run = 0; run < options.runs; ++run) {
+      BlockingQueue<long> queue0(options.bufferSize);
+      BlockingQueue<long> queue1(options.bufferSize);
+      BlockingQueue<long> queue2(options.bufferSize);
+      BlockingQueue<long>* queues[NUM_CONSUMERS] = { &queue0, &queue1, &queue2 };
+      long results[NUM_CONSUMERS] = { 0L, 0L, 0L };
+
+      const long start = util::nanoTime();
+      std::vector<std::thread> consumerThreads;
+      for (int c = 0; c < NUM_CONSUMERS; ++c) {
+        consumerThreads.push_back(std::thread([&, c] {
+              for (long i = 0; i < options.iterations; ++i) {
+                results[c] = applyOperation(operation(c), results[c], queues[c]->take());
+              }
+            }));
+      }
+
+      for (long i = 0; i < options.iterations; ++i) {
+        queue0.put(i);
+        queue1.put(i);
+        queue2.put(i);
+      }
+      for (std::thread& consumerThread : consumerThreads) {
+        consumerThread.join();
+      }
+      const long elapsed = util::nanoTime() - start;
+
+      bool valid = true;
+      for (int c = 0; c < NUM_CONSUMERS; ++c) {
+        valid = valid && expectedResult(operation(c), options.iterations) == results[c];
+      }
+
+      reportThroughput(name(), "BlockingQueue", nullptr, nullptr,
+                       run, options.iterations, elapsed, valid);
+    }
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::Options options(1000L * 1000L * 10L);
+  options.parse(argc, argv);
+
+  varont::perf::OneToThreeMulticastThroughputTest test;
+  varont::perf::runWithEachStrategy(test, options, true);
+  test.runQueue(options);
+
+  return 0;
+}
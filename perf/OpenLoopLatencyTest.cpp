@@ -0,0 +1,288 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <memory>
+
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "Histogram.hpp"
+#include "Util.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/LatencyTestSupport.hpp"
+#include "support/ThreadAffinity.hpp"
+#include "support/Events.hpp"
+
+/**
+ * Publish on a fixed schedule, independent of how quickly events are consumed, and record
+ * the time from each event's intended publication to its consumption.  Measuring from the
+ * intended rather than the actual time includes the delay of events held up behind a
+ * backed up RingBuffer, which a closed loop test, waiting for each event before sending
+ * the next, omits.
+ *
+ * <pre>
+ * +----+    +-----+
+ * | P1 |--->| EP1 |
+ * +----+    +-----+
+ * </pre>
+ *
+ * For each claim and wait strategy the offered rate is doubled from --min-rate until the
+ * achieved rate falls below 95% of that offered, the saturation knee, or --max-rate is
+ * reached.  Each point is printed as a line of JSON.
+ *
+ *   --profile=constant|poisson|bursty  arrival profile
+ *   --burst-size=N                     events per burst for the bursty profile
+ *   --min-rate=N, --max-rate=N         offered rates to sweep, in events per second
+ *   --duration-millis=N                length of each point
+ *   --cpus=P1,EP1                      pins the publisher and event processor threads
+ */
+namespace varont {
+namespace perf {
+
+enum class ArrivalProfile {
+  Constant,
+  Poisson,
+  Bursty
+};
+
+inline const char* getName(const ArrivalProfile profile) {
+  switch (profile) {
+  case ArrivalProfile::Constant:
+    return "constant";
+  case ArrivalProfile::Poisson:
+    return "poisson";
+  case ArrivalProfile::Bursty:
+    return "bursty";
+  }
+  return "unknown";
+}
+
+struct OpenLoopOptions
+  : public LatencyOptions
+{
+  ArrivalProfile profile;
+  int burstSize;
+  long minRate;
+  long maxRate;
+  long durationMillis;
+
+  OpenLoopOptions()
+    : LatencyOptions(0L)
+    , profile(ArrivalProfile::Constant)
+    , burstSize(100)
+    , minRate(10L * 1000L)
+    , maxRate(100L * 1000L * 1000L)
+    , durationMillis(1000L)
+  {
+    runs = 1;
+  }
+
+protected:
+  bool parseOption(const char* arg) {
+    if (0 == std::strcmp(arg, "--profile=constant")) {
+      profile = ArrivalProfile::Constant;
+      return true;
+    }
+    if (0 == std::strcmp(arg, "--profile=poisson")) {
+      profile = ArrivalProfile::Poisson;
+      return true;
+    }
+    if (0 == std::strcmp(arg, "--profile=bursty")) {
+      profile = ArrivalProfile::Bursty;
+      return true;
+    }
+
+    return LatencyOptions::parseOption(arg)
+      || parsePositiveInt(arg, "--burst-size=", burstSize)
+      || parsePositiveLong(arg, "--min-rate=", minRate)
+      || parseLong(arg, "--max-rate=", maxRate)
+      || parseLong(arg, "--duration-millis=", durationMillis);
+  }
+};
+
+/**
+ * Generates the intended publication time of each event, in nanoseconds from the
+ * start of a point.
+ */
+class ArrivalSchedule {
+  const ArrivalProfile profile_;
+  const double intervalNanos_;
+  const int burstSize_;
+  std::mt19937_64 random_;
+  std::exponential_distribution<double> exponential_;
+  double nextNanos_;
+  long count_;
+
+public:
+  ArrivalSchedule(const ArrivalProfile profile, const long rate, const int burstSize)
+    : profile_(profile)
+    , intervalNanos_(1e9 / (double)rate)
+    , burstSize_(burstSize)
+    , random_(rate)
+    , exponential_(1.0 / intervalNanos_)
+    , nextNanos_(0.0)
+    , count_(0L)
+  {}
+
+  long next() {
+    const long intended = (long)nextNanos_;
+
+    switch (profile_) {
+    case ArrivalProfile::Constant:
+      nextNanos_ += intervalNanos_;
+      break;
+    case ArrivalProfile::Poisson:
+      nextNanos_ += exponential_(random_);
+      break;
+    case ArrivalProfile::Bursty:
+      if (0L == (count_ + 1L) % burstSize_) {
+        nextNanos_ += intervalNanos_ * burstSize_;
+      }
+      break;
+    }
+
+    ++count_;
+    return intended;
+  }
+};
+
+class IntendedTimeEventHandler
+  : public LifecycleAwareEventHandler<ValueEvent>
+{
+  Histogram& histogram_;
+  const int cpu_;
+
+public:
+  IntendedTimeEventHandler(Histogram& histogram, const int cpu)
+    : histogram_(histogram)
+    , cpu_(cpu)
+  {}
+
+  void onEvent(ValueEvent& event, long sequence, bool endOfBatch) {
+    histogram_.record(util::nanoTime() - event.value);
+  }
+
+  void onStart() {
+    pinCurrentThread(cpu_);
+  }
+
+  void onShutdown() { }
+};
+
+class OpenLoopLatencyTest {
+  static const long SLEEP_THRESHOLD_NANOS = 100L * 1000L;
+  static const long SPIN_MARGIN_NANOS = 50L * 1000L;
+
+  static const char* name() { return "OpenLoopLatency"; }
+
+  static void awaitIntendedTime(const long intended) {
+    long remaining;
+    while ((remaining = intended - util::nanoTime()) > 0L) {
+      if (remaining > SLEEP_THRESHOLD_NANOS) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - SPIN_MARGIN_NANOS));
+      }
+    }
+  }
+
+public:
+  /** Threads the scenario runs, the publisher included. */
+  static const int NUM_THREADS = 2;
+
+  template <typename Claim, typename Wait>
+  void run(const OpenLoopOptions& options) {
+    for (long rate = options.minRate; rate <= options.maxRate; rate *= 2L) {
+      if (!runPoint<Claim, Wait>(options, rate)) {
+        break;
+      }
+    }
+  }
+
+private:
+  /* Returns false once the saturation knee has been passed. */
+  template <typename Claim, typename Wait>
+  bool runPoint(const OpenLoopOptions& options, const long rate) {
+    const long iterations = std::max(1L, rate * options.durationMillis / 1000L);
+
+    Claim claimStrategy(options.bufferSize);
+    Wait waitStrategy;
+    RingBuffer<ValueEvent> ringBuffer(claimStrategy, waitStrategy);
+    std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+
+    Histogram histogram;
+    IntendedTimeEventHandler handler(histogram, options.getCpu(1));
+    BatchEventProcessor<ValueEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+    ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+    std::thread processorThread(std::ref(batchEventProcessor));
+
+    long start;
+    std::thread publisherThread([&] {
+        pinCurrentThread(options.getCpu(0));
+
+        ArrivalSchedule schedule(options.profile, rate, options.burstSize);
+        start = util::nanoTime();
+
+        for (long i = 0; i < iterations; ++i) {
+          const long intended = start + schedule.next();
+          awaitIntendedTime(intended);
+
+          long sequence = ringBuffer.next();
+          ringBuffer.get(sequence).value = intended;
+          ringBuffer.publish(sequence);
+        }
+      });
+
+    publisherThread.join();
+    waitForSequence(batchEventProcessor.getSequence(), iterations - 1L);
+    const long elapsed = util::nanoTime() - start;
+
+    batchEventProcessor.halt();
+    processorThread.join();
+
+    const double achievedRate = (double)iterations * 1e9 / (double)std::max(1L, elapsed);
+    const bool saturated = achievedRate < 0.95 * (double)rate;
+    const Histogram::Snapshot snapshot = histogram.snapshot();
+
+    std::printf("{\"test\":\"%s\",\"profile\":\"%s\",\"claimStrategy\":\"%s\",\"waitStrategy\":\"%s\","
+                "\"offeredRate\":%ld,\"achievedRate\":%.0f,\"count\":%ld,\"mean\":%.0f,"
+                "\"p50\":%ld,\"p99\":%ld,\"p99.9\":%ld,\"max\":%ld,\"saturated\":%s}\n",
+                name(), getName(options.profile), StrategyName<Claim>::get(), StrategyName<Wait>::get(),
+                rate, achievedRate, snapshot.getTotalCount(), snapshot.getMean(),
+                snapshot.getValueAtPercentile(50.0), snapshot.getValueAtPercentile(99.0),
+                snapshot.getValueAtPercentile(99.9), snapshot.getMax(), saturated ? "true" : "false");
+    std::fflush(stdout);
+
+    return !saturated;
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::OpenLoopOptions options;
+  options.parse(argc, argv);
+
+  varont::perf::OpenLoopLatencyTest test;
+  varont::perf::runWithEachStrategy(test, options, true);
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <memory>
+
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "Histogram.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/LatencyTestSupport.hpp"
+#include "support/ThreadAffinity.hpp"
+#include "support/TscClock.hpp"
+#include "support/Events.hpp"
+
+/**
+ * Ping pong an event between two event processors over a pair of RingBuffers,
+ * recording the round trip time of each exchange.
+ *
+ * <pre>
+ * +----------+    ping    +----------+
+ * |          |----------->|          |
+ * |  Pinger  |            |  Ponger  |
+ * |          |<-----------|          |
+ * +----------+    pong    +----------+
+ * </pre>
+ *
+ * --cpus=PING,PONG pins the pinger and ponger threads.
+ */
+namespace varont {
+namespace perf {
+
+class Pinger
+  : public LifecycleAwareEventHandler<ValueEvent>
+{
+  RingBuffer<ValueEvent>& pingBuffer_;
+  const TscClock& clock_;
+  Histogram& histogram_;
+  const long iterations_;
+  const int cpu_;
+  long count_;
+
+public:
+  Pinger(RingBuffer<ValueEvent>& pingBuffer, const TscClock& clock, Histogram& histogram,
+         const long iterations, const int cpu)
+    : pingBuffer_(pingBuffer)
+    , clock_(clock)
+    , histogram_(histogram)
+    , iterations_(iterations)
+    , cpu_(cpu)
+    , count_(0L)
+  {}
+
+  void onEvent(ValueEvent& event, long sequence, bool endOfBatch) {
+    histogram_.record(clock_.toNanos(TscClock::ticks() - event.value));
+
+    if (++count_ < iterations_) {
+      ping();
+    }
+  }
+
+  void onStart() {
+    pinCurrentThread(cpu_);
+    ping();
+  }
+
+  void onShutdown() { }
+
+private:
+  void ping() {
+    long sequence = pingBuffer_.next();
+    pingBuffer_.get(sequence).value = TscClock::ticks();
+    pingBuffer_.publish(sequence);
+  }
+};
+
+class Ponger
+  : public LifecycleAwareEventHandler<ValueEvent>
+{
+  RingBuffer<ValueEvent>& pongBuffer_;
+  const int cpu_;
+
+public:
+  Ponger(RingBuffer<ValueEvent>& pongBuffer, const int cpu)
+    : pongBuffer_(pongBuffer)
+    , cpu_(cpu)
+  {}
+
+  void onEvent(ValueEvent& event, long sequence, bool endOfBatch) {
+    long pongSequence = pongBuffer_.next();
+    pongBuffer_.get(pongSequence).value = event.value;
+    pongBuffer_.publish(pongSequence);
+  }
+
+  void onStart() {
+    pinCurrentThread(cpu_);
+  }
+
+  void onShutdown() { }
+};
+
+class PingPongLatencyTest {
+  static const char* name() { return "PingPongLatency"; }
+
+  const TscClock clock_;
+
+public:
+  template <typename Wait>
+  void run(const LatencyOptions& options) {
+    for (int run = 0; run < options.runs; ++run) {
+      SingleThreadedClaimStrategy pingClaimStrategy(options.bufferSize);
+      SingleThreadedClaimStrategy pongClaimStrategy(options.bufferSize);
+      Wait pingWaitStrategy;
+      Wait pongWaitStrategy;
+      RingBuffer<ValueEvent> pingBuffer(pingClaimStrategy, pingWaitStrategy);
+      RingBuffer<ValueEvent> pongBuffer(pongClaimStrategy, pongWaitStrategy);
+      std::unique_ptr<SequenceBarrier> pingBarrier = pingBuffer.newBarrier({ });
+      std::unique_ptr<SequenceBarrier> pongBarrier = pongBuffer.newBarrier({ });
+
+      Histogram histogram;
+      Pinger pinger(pingBuffer, clock_, histogram, options.iterations, options.getCpu(0));
+      Ponger ponger(pongBuffer, options.getCpu(1));
+      BatchEventProcessor<ValueEvent> pingerProcessor(pongBuffer, *pongBarrier, pinger);
+      BatchEventProcessor<ValueEvent> pongerProcessor(pingBuffer, *pingBarrier, ponger);
+      pongBuffer.setGatingSequences({ &pingerProcessor.getSequence() });
+      pingBuffer.setGatingSequences({ &pongerProcessor.getSequence() });
+
+      std::thread pongerThread(std::ref(pongerProcessor));
+      std::thread pingerThread(std::ref(pingerProcessor));
+
+      waitForSequence(pingerProcessor.getSequence(), options.iterations - 1L);
+
+      pingerProcessor.halt();
+      pongerProcessor.halt();
+      pingerThread.join();
+      pongerThread.join();
+
+      reportLatency(name(), StrategyName<Wait>::get(), TscClock::getName(), run, histogram.snapshot());
+    }
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::LatencyOptions options(1000L * 1000L);
+  options.parse(argc, argv);
+
+  varont::perf::PingPongLatencyTest test;
+  varont::perf::runWithEachLatencyWaitStrategy(test, options, 2);
+
+  return 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include "Sequence.hpp"
+#include "Sequencer.hpp"
+#include "ClaimStrategy.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "MultiThreadedClaimStrategy.hpp"
+#include "MultiThreadedLowContentionClaimStrategy.hpp"
+#include "Util.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/PerfCounters.hpp"
+
+/**
+ * Measure the primitives the RingBuffer is built from, with hardware performance counters
+ * where perf_event_open allows them:
+ *
+ *   Sequence.get, Sequence.set and Sequence.compareAndSet, set and compareAndSet across
+ *   threads to expose false and true sharing respectively;
+ *   util::getMinimumSequence over 1 to 64 sequences;
+ *   ClaimStrategy::incrementAndGet and serialisePublishing for each claim strategy.
+ *
+ * The claim strategies are gated on a sequence that is never behind, so only the cost of
+ * claiming and publishing is measured.  Each measurement is printed as a line of JSON giving
+ * the wall clock nanoseconds per operation and each counter per operation, summed over
+ * the threads, or null where a counter is unavailable.
+ *
+ *   --iterations=N    operations per measurement, shared between the threads
+ *   --max-threads=N   largest thread count, swept in powers of 2 from 1
+ *   --hitm-event=N    cpu specific raw perf event counting HITM loads, e.g. 0x04d2
+ */
+namespace varont {
+namespace perf {
+
+struct MicroBenchmarkOptions
+  : public Options
+{
+  int maxThreads;
+  unsigned long hitmEvent;
+
+  MicroBenchmarkOptions()
+    : Options(1000L * 1000L * 10L)
+    , maxThreads(16)
+    , hitmEvent(0UL)
+  {
+    runs = 1;
+  }
+
+protected:
+  bool parseOption(const char* arg) {
+    static const char* HITM_EVENT = "--hitm-event=";
+
+    if (0 == std::strncmp(arg, HITM_EVENT, std::strlen(HITM_EVENT))) {
+      hitmEvent = std::strtoul(arg + std::strlen(HITM_EVENT), nullptr, 0);
+      return true;
+    }
+
+    return Options::parseOption(arg)
+      || parseInt(arg, "--max-threads=", maxThreads);
+  }
+};
+
+/**
+ * A gating sequence that never holds back a publisher.
+ */
+class UnboundedSequence
+  : public Sequence
+{
+public:
+  long get() {
+    return LONG_MAX;
+  }
+};
+
+/* Written with results that must not be optimised away. */
+std::atomic_long sink;
+
+class PrimitiveMicroBenchmark {
+  const MicroBenchmarkOptions& options_;
+
+public:
+  PrimitiveMicroBenchmark(const MicroBenchmarkOptions& options)
+    : options_(options)
+  {}
+
+  void run() {
+    measureSequence();
+    measureGetMinimumSequence();
+
+    measureClaimStrategy<SingleThreadedClaimStrategy>(1);
+    measureClaimStrategy<MultiThreadedClaimStrategy>(options_.maxThreads);
+    measureClaimStrategy<MultiThreadedLowContentionClaimStrategy>(options_.maxThreads);
+  }
+
+private:
+  void measureSequence() {
+    Sequence sequence(0L);
+
+    measure("Sequence.get", "", 0, 1, [&](int thread, long operations) {
+        long sum = 0L;
+        for (long i = 0; i < operations; ++i) {
+          sum += sequence.get();
+        }
+        sink += sum;
+      });
+
+    for (int threads = 1; threads <= options_.maxThreads; threads *= 2) {
+      /* Adjacent sequences share cache lines, so this shows the cost of false sharing. */
+      std::vector<Sequence> sequences(threads, Sequence(0L));
+
+      measure("Sequence.set", "adjacent", 0, threads, [&](int thread, long operations) {
+          Sequence& own = sequences[thread];
+          for (long i = 0; i < operations; ++i) {
+            own.set(i);
+          }
+        });
+    }
+
+    for (int threads = 1; threads <= options_.maxThreads; threads *= 2) {
+      Sequence shared(0L);
+
+      measure("Sequence.compareAndSet", "shared", 0, threads, [&](int thread, long operations) {
+          long failures = 0L;
+          for (long i = 0; i < operations; ++i) {
+            const long value = shared.get();
+            if (!shared.compareAndSet(value, value + 1L)) {
+              ++failures;
+            }
+          }
+          sink += failures;
+        });
+    }
+  }
+
+  void measureGetMinimumSequence() {
+    for (int count = 1; count <= 64; count *= 2) {
+      std::vector<Sequence> sequences(count, Sequence(0L));
+      std::vector<Sequence*> pointers;
+      for (Sequence& sequence : sequences) {
+        pointers.push_back(&sequence);
+      }
+
+      measure("util::getMinimumSequence", "", count, 1, [&](int thread, long operations) {
+          long sum = 0L;
+          for (long i = 0; i < operations; ++i) {
+            sum += util::getMinimumSequence(pointers);
+          }
+          sink += sum;
+        });
+    }
+  }
+
+  template <typename Claim>
+  void measureClaimStrategy(const int maxThreads) {
+    const char* name = StrategyName<Claim>::get();
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+      Claim claimStrategy(options_.bufferSize);
+      UnboundedSequence gatingSequence;
+      std::vector<Sequence*> gatingSequences = { &gatingSequence };
+
+      measure("ClaimStrategy::incrementAndGet", name, 0, threads, [&](int thread, long operations) {
+          long sum = 0L;
+          for (long i = 0; i < operations; ++i) {
+            sum += claimStrategy.incrementAndGet(gatingSequences);
+          }
+          sink += sum;
+        });
+    }
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+      /* Publishers busy spin for their turn, which starves the publisher holding it when
+         there are more publishers than cores. */
+      if (typeid(Claim) == typeid(MultiThreadedLowContentionClaimStrategy)
+          && (unsigned)threads > std::thread::hardware_concurrency())
+      {
+        std::fprintf(stderr, "skipping %s serialisePublishing with %d threads: too few cores\n", name, threads);
+        break;
+      }
+
+      Claim claimStrategy(options_.bufferSize);
+      UnboundedSequence gatingSequence;
+      std::vector<Sequence*> gatingSequences = { &gatingSequence };
+      Sequence cursor(Sequencer::INITIAL_CURSOR_VALUE);
+
+      measure("ClaimStrategy::serialisePublishing", name, 0, threads, [&](int thread, long operations) {
+          for (long i = 0; i < operations; ++i) {
+            const long sequence = claimStrategy.incrementAndGet(gatingSequences);
+            claimStrategy.serialisePublishing(sequence, cursor, 1);
+          }
+        });
+    }
+  }
+
+  /**
+   * Run operation on threads threads at once, each given an equal share of the iterations,
+   * and report the cost per operation.
+   */
+  template <typename Operation>
+  void measure(const char* benchmark, const char* variant, const int parameter, const int threads,
+               Operation operation)
+  {
+    const long operationsPerThread = options_.iterations / threads;
+    const long operations = operationsPerThread * threads;
+
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    bool started = false;
+    PerfCounters::Values totals;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.push_back(std::thread([&, t] {
+            PerfCounters counters(options_.hitmEvent);
+            {
+              std::unique_lock<std::mutex> lock(mutex);
+              while (!started) {
+                startCondition.wait(lock);
+              }
+            }
+
+            counters.start();
+            operation(t, operationsPerThread);
+            counters.stop();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            totals += counters.read();
+          }));
+    }
+
+    /* Let the workers reach the start gate before timing. */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    const long start = util::nanoTime();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      started = true;
+    }
+    startCondition.notify_all();
+
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    const long elapsed = util::nanoTime() - start;
+
+    std::printf("{\"benchmark\":\"%s\",\"variant\":\"%s\",\"parameter\":%d,\"threads\":%d,"
+                "\"operations\":%ld,\"nanosPerOp\":%.3f",
+                benchmark, variant, parameter, threads, operations, (double)elapsed / (double)operations);
+    for (int i = 0; i < PerfCounters::COUNTER_COUNT; ++i) {
+      std::printf(",\"%sPerOp\":", PerfCounters::getName(i));
+      if (totals.available[i]) {
+        std::printf("%.3f", (double)totals.counts[i] / (double)operations);
+      }
+      else {
+        std::printf("null");
+      }
+    }
+    std::printf("}\n");
+    std::fflush(stdout);
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::MicroBenchmarkOptions options;
+  options.parse(argc, argv);
+
+  for (int run = 0; run < options.runs; ++run) {
+    varont::perf::PrimitiveMicroBenchmark benchmark(options);
+    benchmark.run();
+  }
+
+  return 0;
+}
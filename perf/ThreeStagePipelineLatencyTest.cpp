@@ -0,0 +1,152 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <memory>
+
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "Histogram.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/LatencyTestSupport.hpp"
+#include "support/ThreadAffinity.hpp"
+#include "support/TscClock.hpp"
+#include "support/Events.hpp"
+
+/**
+ * Pipeline a series of stages from a publisher to ultimate event processor, recording
+ * the time from publication to the last stage for each event.  The publisher pauses
+ * between events so that the latency, rather than the queueing delay, is measured.
+ *
+ * <pre>
+ * +----+    +-----+    +-----+    +-----+
+ * | P1 |--->| EP1 |--->| EP2 |--->| EP3 |
+ * +----+    +-----+    +-----+    +-----+
+ * </pre>
+ *
+ * --cpus=P1,EP1,EP2,EP3 pins the publisher and event processor threads, and
+ * --pause-nanos sets the delay between publications.
+ */
+namespace varont {
+namespace perf {
+
+class LatencyStepEventHandler
+  : public LifecycleAwareEventHandler<ValueEvent>
+{
+  const TscClock& clock_;
+  Histogram* histogram_;
+  const int cpu_;
+
+public:
+  /**
+   * @param histogram to record into, or nullptr for an intermediate stage.
+   */
+  LatencyStepEventHandler(const TscClock& clock, Histogram* histogram, const int cpu)
+    : clock_(clock)
+    , histogram_(histogram)
+    , cpu_(cpu)
+  {}
+
+  void onEvent(ValueEvent& event, long sequence, bool endOfBatch) {
+    if (nullptr != histogram_) {
+      histogram_->record(clock_.toNanos(TscClock::ticks() - event.value));
+    }
+  }
+
+  void onStart() {
+    pinCurrentThread(cpu_);
+  }
+
+  void onShutdown() { }
+};
+
+class ThreeStagePipelineLatencyTest {
+  static const char* name() { return "ThreeStagePipelineLatency"; }
+
+  const TscClock clock_;
+
+public:
+  template <typename Wait>
+  void run(const LatencyOptions& options) {
+    for (int run = 0; run < options.runs; ++run) {
+      SingleThreadedClaimStrategy claimStrategy(options.bufferSize);
+      Wait waitStrategy;
+      RingBuffer<ValueEvent> ringBuffer(claimStrategy, waitStrategy);
+
+      Histogram histogram;
+      LatencyStepEventHandler stepOneHandler(clock_, nullptr, options.getCpu(1));
+      LatencyStepEventHandler stepTwoHandler(clock_, nullptr, options.getCpu(2));
+      LatencyStepEventHandler stepThreeHandler(clock_, &histogram, options.getCpu(3));
+
+      std::unique_ptr<SequenceBarrier> stepOneBarrier = ringBuffer.newBarrier({ });
+      BatchEventProcessor<ValueEvent> stepOneProcessor(ringBuffer, *stepOneBarrier, stepOneHandler);
+
+      std::unique_ptr<SequenceBarrier> stepTwoBarrier = ringBuffer.newBarrier({ &stepOneProcessor.getSequence() });
+      BatchEventProcessor<ValueEvent> stepTwoProcessor(ringBuffer, *stepTwoBarrier, stepTwoHandler);
+
+      std::unique_ptr<SequenceBarrier> stepThreeBarrier = ringBuffer.newBarrier({ &stepTwoProcessor.getSequence() });
+      BatchEventProcessor<ValueEvent> stepThreeProcessor(ringBuffer, *stepThreeBarrier, stepThreeHandler);
+
+      ringBuffer.setGatingSequences({ &stepThreeProcessor.getSequence() });
+
+      std::thread stepOneThread(std::ref(stepOneProcessor));
+      std::thread stepTwoThread(std::ref(stepTwoProcessor));
+      std::thread stepThreeThread(std::ref(stepThreeProcessor));
+
+      std::thread publisherThread([&] {
+          pinCurrentThread(options.getCpu(0));
+
+          for (long i = 0; i < options.iterations; ++i) {
+            long sequence = ringBuffer.next();
+            ringBuffer.get(sequence).value = TscClock::ticks();
+            ringBuffer.publish(sequence);
+
+            const long pauseEnd = util::nanoTime() + options.pauseNanos;
+            while (util::nanoTime() < pauseEnd) {
+              // busy spin
+            }
+          }
+        });
+
+      publisherThread.join();
+      waitForSequence(stepThreeProcessor.getSequence(), options.iterations - 1L);
+
+      stepOneProcessor.halt();
+      stepTwoProcessor.halt();
+      stepThreeProcessor.halt();
+      stepOneThread.join();
+      stepTwoThread.join();
+      stepThreeThread.join();
+
+      reportLatency(name(), StrategyName<Wait>::get(), TscClock::getName(), run, histogram.snapshot());
+    }
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::LatencyOptions options(1000L * 1000L);
+  options.parse(argc, argv);
+
+  varont::perf::ThreeStagePipelineLatencyTest test;
+  varont::perf::runWithEachLatencyWaitStrategy(test, options, 4);
+
+  return 0;
+}
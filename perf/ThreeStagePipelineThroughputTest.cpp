@@ -0,0 +1,226 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <memory>
+
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "Util.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/BlockingQueue.hpp"
+#include "support/Events.hpp"
+
+/**
+ * Pipeline a series of stages from a publisher to ultimate event processor.
+ * Each event processor depends on the output of the event processor before it.
+ *
+ * <pre>
+ * +----+    +-----+    +-----+    +-----+
+ * | P1 |--->| EP1 |--->| EP2 |--->| EP3 |
+ * +----+    +-----+    +-----+    +-----+
+ * </pre>
+ */
+namespace varont {
+namespace perf {
+
+enum class FunctionStep {
+  One,
+  Two,
+  Three
+};
+
+inline long stepOne(const long operandOne, const long operandTwo) {
+  return operandOne + operandTwo;
+}
+
+inline long stepTwo(const long stepOneResult) {
+  return stepOneResult + 3L;
+}
+
+inline bool stepThree(const long stepTwoResult) {
+  return 4L == (stepTwoResult & 4L);
+}
+
+class FunctionEventHandler
+  : public LifecycleAwareEventHandler<FunctionEvent>
+{
+  const FunctionStep step_;
+  long stepThreeCounter_;
+
+public:
+  FunctionEventHandler(const FunctionStep step)
+    : step_(step)
+    , stepThreeCounter_(0L)
+  {}
+
+  void onEvent(FunctionEvent& event, long sequence, bool endOfBatch) {
+    switch (step_) {
+    case FunctionStep::One:
+      event.stepOneResult = stepOne(event.operandOne, event.operandTwo);
+      break;
+    case FunctionStep::Two:
+      event.stepTwoResult = stepTwo(event.stepOneResult);
+      break;
+    case FunctionStep::Three:
+      if (stepThree(event.stepTwoResult)) {
+        ++stepThreeCounter_;
+      }
+      break;
+    }
+  }
+
+  long getStepThreeCounter() const {
+    return stepThreeCounter_;
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+class ThreeStagePipelineThroughputTest {
+  static const long OPERAND_TWO_INITIAL_VALUE = 777L;
+
+  static const char* name() { return "ThreeStagePipelineThroughput"; }
+
+  static long expectedResult(const long iterations) {
+    long result = 0L;
+    long operandTwo = OPERAND_TWO_INITIAL_VALUE;
+    for (long i = 0; i < iterations; ++i) {
+      if (stepThree(stepTwo(stepOne(i, operandTwo--)))) {
+        ++result;
+      }
+    }
+    return result;
+  }
+
+public:
+  /** Threads the scenario runs, the publisher included. */
+  static const int NUM_THREADS = 4;
+
+  template <typename Claim, typename Wait>
+  void run(const Options& options) {
+    const long expected = expectedResult(options.iterations);
+
+    for (int run = 0; run < options.runs; ++run) {
+      Claim claimStrategy(options.bufferSize);
+      Wait waitStrategy;
+      RingBuffer<FunctionEvent> ringBuffer(claimStrategy, waitStrategy);
+
+      FunctionEventHandler stepOneHandler(FunctionStep::One);
+      FunctionEventHandler stepTwoHandler(FunctionStep::Two);
+      FunctionEventHandler stepThreeHandler(FunctionStep::Three);
+
+      std::unique_ptr<SequenceBarrier> stepOneBarrier = ringBuffer.newBarrier({ });
+      BatchEventProcessor<FunctionEvent> stepOneProcessor(ringBuffer, *stepOneBarrier, stepOneHandler);
+
+      std::unique_ptr<SequenceBarrier> stepTwoBarrier = ringBuffer.newBarrier({ &stepOneProcessor.getSequence() });
+      BatchEventProcessor<FunctionEvent> stepTwoProcessor(ringBuffer, *stepTwoBarrier, stepTwoHandler);
+
+      std::unique_ptr<SequenceBarrier> stepThreeBarrier = ringBuffer.newBarrier({ &stepTwoProcessor.getSequence() });
+      BatchEventProcessor<FunctionEvent> stepThreeProcessor(ringBuffer, *stepThreeBarrier, stepThreeHandler);
+
+      ringBuffer.setGatingSequences({ &stepThreeProcessor.getSequence() });
+
+      std::thread stepOneThread(std::ref(stepOneProcessor));
+      std::thread stepTwoThread(std::ref(stepTwoProcessor));
+      std::thread stepThreeThread(std::ref(stepThreeProcessor));
+
+      const long start = util::nanoTime();
+      long operandTwo = OPERAND_TWO_INITIAL_VALUE;
+      for (long i = 0; i < options.iterations; ++i) {
+        long sequence = ringBuffer.next();
+        FunctionEvent& event = ringBuffer.get(sequence);
+        event.operandOne = i;
+        event.operandTwo = operandTwo--;
+        ringBuffer.publish(sequence);
+      }
+      waitForSequence(stepThreeProcessor.getSequence(), options.iterations - 1L);
+      const long elapsed = util::nanoTime() - start;
+
+      stepOneProcessor.halt();
+      stepTwoProcessor.halt();
+      stepThreeProcessor.halt();
+      stepOneThread.join();
+      stepTwoThread.join();
+      stepThreeThread.join();
+
+      reportThroughput(name(), "RingBuffer", StrategyName<Claim>::get(), StrategyName<Wait>::get(),
+                       run, options.iterations, elapsed, expected == stepThreeHandler.getStepThreeCounter());
+    }
+  }
+
+  void runQueue(const Options& options) {
+    const long expected = expectedResult(options.iterations);
+
+    for (int run = 0; run < options.runs; ++run) {
+      BlockingQueue<FunctionEvent> stepOneQueue(options.bufferSize);
+      BlockingQueue<long> stepTwoQueue(options.bufferSize);
+      BlockingQueue<long> stepThreeQueue(options.bufferSize);
+      long stepThreeCounter = 0L;
+
+      const long start = util::nanoTime();
+      std::thread stepOneThread([&] {
+          for (long i = 0; i < options.iterations; ++i) {
+            FunctionEvent event = stepOneQueue.take();
+            stepTwoQueue.put(stepOne(event.operandOne, event.operandTwo));
+          }
+        });
+      std::thread stepTwoThread([&] {
+          for (long i = 0; i < options.iterations; ++i) {
+            stepThreeQueue.put(stepTwo(stepTwoQueue.take()));
+          }
+        });
+      std::thread stepThreeThread([&] {
+          for (long i = 0; i < options.iterations; ++i) {
+            if (stepThree(stepThreeQueue.take())) {
+              ++stepThreeCounter;
+            }
+          }
+        });
+
+      long operandTwo = OPERAND_TWO_INITIAL_VALUE;
+      for (long i = 0; i < options.iterations; ++i) {
+        FunctionEvent event;
+        event.operandOne = i;
+        event.operandTwo = operandTwo--;
+        stepOneQueue.put(event);
+      }
+      stepOneThread.join();
+      stepTwoThread.join();
+      stepThreeThread.join();
+      const long elapsed = util::nanoTime() - start;
+
+      reportThroughput(name(), "BlockingQueue", nullptr, nullptr,
+                       run, options.iterations, elapsed, expected == stepThreeCounter);
+    }
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::Options options(1000L * 1000L * 10L);
+  options.parse(argc, argv);
+
+  varont::perf::ThreeStagePipelineThroughputTest test;
+  varont::perf::runWithEachStrategy(test, options, true);
+  test.runQueue(options);
+
+  return 0;
+}
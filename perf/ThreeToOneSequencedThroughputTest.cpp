@@ -0,0 +1,171 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <memory>
+#include <vector>
+
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "Util.hpp"
+
+#include "support/PerfTestSupport.hpp"
+#include "support/BlockingQueue.hpp"
+#include "support/ValueMutationHandler.hpp"
+#include "support/Events.hpp"
+
+/**
+ * Sequence a series of events from multiple publishers going to one event processor.
+ *
+ * <pre>
+ * +----+
+ * | P1 |------+
+ * +----+      |
+ *             v
+ * +----+    +-----+
+ * | P2 |--->| EP1 |
+ * +----+    +-----+
+ *             ^
+ * +----+      |
+ * | P3 |------+
+ * +----+
+ * </pre>
+ *
+ * Only the multi threaded claim strategies are exercised.  The low contention claim
+ * strategy busy spins publishers waiting for their turn to publish, so it is skipped
+ * when there are fewer cores than publishing and processing threads.
+ */
+namespace varont {
+namespace perf {
+
+class ThreeToOneSequencedThroughputTest {
+public:
+  static const int NUM_PUBLISHERS = 3;
+  static const int NUM_THREADS = NUM_PUBLISHERS + 1;
+
+private:
+  static const char* name() { return "ThreeToOneSequencedThroughput"; }
+
+  static long iterationsPerPublisher(const Options& options) {
+    return options.iterations / NUM_PUBLISHERS;
+  }
+
+  static long expectedResult(const Options& options) {
+    long result = 0L;
+    for (long i = 0; i < iterationsPerPublisher(options); ++i) {
+      result += NUM_PUBLISHERS * i;
+    }
+    return result;
+  }
+
+public:
+  template <typename Claim, typename Wait>
+  void run(const Options& options) {
+    const long expected = expectedResult(options);
+    const long perPublisher = iterationsPerPublisher(options);
+    const long total = perPublisher * NUM_PUBLISHERS;
+
+    for (int run = 0; run < options.runs; ++run) {
+      Claim claimStrategy(options.bufferSize);
+      Wait waitStrategy;
+      RingBuffer<ValueEvent> ringBuffer(claimStrategy, waitStrategy);
+      std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+      ValueMutationHandler handler(Operation::Addition);
+      BatchEventProcessor<ValueEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+      ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+      std::thread processorThread(std::ref(batchEventProcessor));
+
+      const long start = util::nanoTime();
+      std::vector<std::thread> publisherThreads;
+      for (int p = 0; p < NUM_PUBLISHERS; ++p) {
+        publisherThreads.push_back(std::thread([&] {
+              for (long i = 0; i < perPublisher; ++i) {
+                long sequence = ringBuffer.next();
+                ringBuffer.get(sequence).value = i;
+                ringBuffer.publish(sequence);
+              }
+            }));
+      }
+      for (std::thread& publisherThread : publisherThreads) {
+        publisherThread.join();
+      }
+      waitForSequence(batchEventProcessor.getSequence(), total - 1L);
+      const long elapsed = util::nanoTime() - start;
+
+      batchEventProcessor.halt();
+      processorThread.join();
+
+      reportThroughput(name(), "RingBuffer", StrategyName<Claim>::get(), StrategyName<Wait>::get(),
+                       run, total, elapsed, expected == handler.getValue());
+    }
+  }
+
+  void runQueue(const Options& options) {
+    const long expected = expectedResult(options);
+    const long perPublisher = iterationsPerPublisher(options);
+    const long total = perPublisher * NUM_PUBLISHERS;
+
+    for (int run = 0; run < options.runs; ++run) {
+      BlockingQueue<long> queue(options.bufferSize);
+      long result = 0L;
+
+      const long start = util::nanoTime();
+      std::thread consumerThread([&] {
+          for (long i = 0; i < total; ++i) {
+            result += queue.take();
+          }
+        });
+
+      std::vector<std::thread> publisherThreads;
+      for (int p = 0; p < NUM_PUBLISHERS; ++p) {
+        publisherThreads.push_back(std::thread([&] {
+              for (long i = 0; i < perPublisher; ++i) {
+                queue.put(i);
+              }
+            }));
+      }
+      for (std::thread& publisherThread : publisherThreads) {
+        publisherThread.join();
+      }
+      consumerThread.join();
+      const long elapsed = util::nanoTime() - start;
+
+      reportThroughput(name(), "BlockingQueue", nullptr, nullptr,
+                       run, total, elapsed, expected == result);
+    }
+  }
+};
+
+}
+}
+
+int main(int argc, char** argv) {
+  varont::perf::Options options(1000L * 1000L * 10L);
+  options.parse(argc, argv);
+
+  typedef varont::perf::ThreeToOneSequencedThroughputTest Test;
+  Test test;
+  varont::perf::runWithEachWaitStrategy<Test, varont::MultiThreadedClaimStrategy>(test, options);
+  if (std::thread::hardware_concurrency() > (unsigned)Test::NUM_PUBLISHERS) {
+    varont::perf::runWithEachWaitStrategy<Test, varont::MultiThreadedLowContentionClaimStrategy>(test, options);
+  }
+  else {
+    std::fprintf(stderr, "skipping MultiThreadedLowContention: fewer than %d cores\n", Test::NUM_PUBLISHERS + 1);
+  }
+  test.runQueue(options);
+
+  return 0;
+}
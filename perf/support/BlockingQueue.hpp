@@ -0,0 +1,70 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PERF_BLOCKINGQUEUE_HPP__
+#define __VARONT_PERF_BLOCKINGQUEUE_HPP__
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace varont {
+namespace perf {
+
+/**
+ * Bounded queue guarded by a mutex and two condition variables, the
+ * baseline against which the RingBuffer is measured.
+ */
+template <typename T>
+class BlockingQueue {
+  const std::size_t capacity_;
+  std::deque<T> queue_;
+  std::mutex mutex_;
+  std::condition_variable notEmpty_;
+  std::condition_variable notFull_;
+
+public:
+  BlockingQueue(const std::size_t capacity)
+    : capacity_(capacity)
+  {}
+
+  void put(const T& value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (queue_.size() >= capacity_) {
+      notFull_.wait(lock);
+    }
+    queue_.push_back(value);
+    notEmpty_.notify_one();
+  }
+
+  T take() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (queue_.empty()) {
+      notEmpty_.wait(lock);
+    }
+    T value = queue_.front();
+    queue_.pop_front();
+    notFull_.notify_one();
+    return value;
+  }
+
+  BlockingQueue(const BlockingQueue&) = delete;
+  BlockingQueue& operator=(const BlockingQueue&) = delete;
+};
+
+}
+}
+
+#endif /* __VARONT_PERF_BLOCKINGQUEUE_HPP__ */
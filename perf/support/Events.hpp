@@ -0,0 +1,59 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PERF_EVENTS_HPP__
+#define __VARONT_PERF_EVENTS_HPP__
+
+namespace varont {
+namespace perf {
+
+struct ValueEvent {
+  long value;
+
+  ValueEvent()
+    : value(0L)
+  {}
+};
+
+struct FunctionEvent {
+  long operandOne;
+  long operandTwo;
+  long stepOneResult;
+  long stepTwoResult;
+
+  FunctionEvent()
+    : operandOne(0L)
+    , operandTwo(0L)
+    , stepOneResult(0L)
+    , stepTwoResult(0L)
+  {}
+};
+
+struct FizzBuzzEvent {
+  long value;
+  bool fizz;
+  bool buzz;
+
+  FizzBuzzEvent()
+    : value(0L)
+    , fizz(false)
+    , buzz(false)
+  {}
+};
+
+}
+}
+
+#endif /* __VARONT_PERF_EVENTS_HPP__ */
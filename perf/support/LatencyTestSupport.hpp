@@ -0,0 +1,116 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PERF_LATENCYTESTSUPPORT_HPP__
+#define __VARONT_PERF_LATENCYTESTSUPPORT_HPP__
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "Histogram.hpp"
+
+#include "PerfTestSupport.hpp"
+
+namespace varont {
+namespace perf {
+
+/**
+ * Options for the latency tests, adding to those of {@link Options}:
+ *
+ *   --cpus=A,B,...   cpus to pin the test's threads to, in the order the test documents
+ *   --pause-nanos=N  delay between publications for tests with an open publisher
+ */
+struct LatencyOptions
+  : public Options
+{
+  std::vector<int> cpus;
+  long pauseNanos;
+
+  LatencyOptions(const long defaultIterations)
+    : Options(defaultIterations)
+    , pauseNanos(1000L)
+  {}
+
+  /**
+   * Get the cpu for the thread at index, or -1 if it is to be left unbound.
+   */
+  int getCpu(const std::size_t index) const {
+    return index < cpus.size() ? cpus[index] : -1;
+  }
+
+protected:
+  bool parseOption(const char* arg) {
+    static const char* CPUS = "--cpus=";
+
+    if (0 == std::strncmp(arg, CPUS, std::strlen(CPUS))) {
+      cpus.clear();
+      const char* next = arg + std::strlen(CPUS);
+      while ('\0' != *next) {
+        char* end;
+        cpus.push_back((int)std::strtol(next, &end, 10));
+        next = (',' == *end) ? end + 1 : end;
+        if (end == next && '\0' != *end) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    return Options::parseOption(arg)
+      || parseLong(arg, "--pause-nanos=", pauseNanos);
+  }
+};
+
+/**
+ * Print the latency distribution of one run, in nanoseconds, as a line of JSON.
+ */
+inline void reportLatency(const char* test, const char* waitStrategy, const char* clock,
+                          const int run, const Histogram::Snapshot& snapshot)
+{
+  std::printf("{\"test\":\"%s\",\"waitStrategy\":\"%s\",\"clock\":\"%s\",\"run\":%d,\"count\":%ld,"
+              "\"mean\":%.0f,\"p50\":%ld,\"p99\":%ld,\"p99.9\":%ld,\"max\":%ld}\n",
+              test, waitStrategy, clock, run, snapshot.getTotalCount(), snapshot.getMean(),
+              snapshot.getValueAtPercentile(50.0), snapshot.getValueAtPercentile(99.0),
+              snapshot.getValueAtPercentile(99.9), snapshot.getMax());
+  std::fflush(stdout);
+}
+
+/**
+ * Run a latency scenario against every wait strategy.  The busy spin strategy is skipped
+ * when there are fewer cores than the scenario's threads, as the spinning threads would
+ * then only hand over at the end of each scheduler time slice.
+ */
+template <typename Scenario>
+void runWithEachLatencyWaitStrategy(Scenario& scenario, const LatencyOptions& options, const unsigned threads) {
+  scenario.template run<BlockingWaitStrategy>(options);
+  scenario.template run<SleepingWaitStrategy>(options);
+  scenario.template run<EventFdWaitStrategy>(options);
+  scenario.template run<YieldingWaitStrategy>(options);
+
+  if (std::thread::hardware_concurrency() >= threads) {
+    scenario.template run<BusySpinWaitStrategy>(options);
+  }
+  else {
+    std::fprintf(stderr, "skipping BusySpin: fewer than %u cores\n", threads);
+  }
+}
+
+}
+}
+
+#endif /* __VARONT_PERF_LATENCYTESTSUPPORT_HPP__ */
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PERF_PERFCOUNTERS_HPP__
+#define __VARONT_PERF_PERFCOUNTERS_HPP__
+
+#include <cstdint>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace varont {
+namespace perf {
+
+/**
+ * Hardware performance counters for the calling thread, read through perf_event_open.
+ *
+ * Each counter is opened on its own so that one the kernel or cpu doesn't support, or
+ * that perf_event_paranoid forbids, is reported as unavailable without losing the rest.
+ * Counts are scaled for any time the counter was multiplexed off the PMU.
+ *
+ * HITM (loads hitting a line modified in another core's cache, the signature of false
+ * sharing) has no generic event, so it is counted only when given the cpu specific raw
+ * event code, e.g. 0x04d2 for MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM on Skylake.
+ */
+class PerfCounters {
+public:
+  enum Counter {
+    Cycles,
+    Instructions,
+    CacheMisses,
+    Hitm,
+    COUNTER_COUNT
+  };
+
+  struct Values {
+    long counts[COUNTER_COUNT];
+    bool available[COUNTER_COUNT];
+
+    Values() {
+      for (int i = 0; i < COUNTER_COUNT; ++i) {
+        counts[i] = 0L;
+        available[i] = false;
+      }
+    }
+
+    Values& operator+=(const Values& other) {
+      for (int i = 0; i < COUNTER_COUNT; ++i) {
+        counts[i] += other.counts[i];
+        available[i] = available[i] || other.available[i];
+      }
+      return *this;
+    }
+  };
+
+  static const char* getName(const int counter) {
+    static const char* NAMES[COUNTER_COUNT] = { "cycles", "instructions", "cacheMisses", "hitm" };
+    return NAMES[counter];
+  }
+
+private:
+  int fds_[COUNTER_COUNT];
+
+public:
+  /**
+   * @param hitmRawEvent raw event code counting HITM, or 0 to leave that counter unavailable.
+   */
+  PerfCounters(const unsigned long hitmRawEvent = 0UL) {
+    fds_[Cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds_[Instructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds_[CacheMisses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fds_[Hitm] = (0UL == hitmRawEvent) ? -1 : open(PERF_TYPE_RAW, hitmRawEvent);
+  }
+
+  ~PerfCounters() {
+    for (int fd : fds_) {
+      if (-1 != fd) {
+        ::close(fd);
+      }
+    }
+  }
+
+  void start() {
+    for (int fd : fds_) {
+      if (-1 != fd) {
+        ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  void stop() {
+    for (int fd : fds_) {
+      if (-1 != fd) {
+        ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+  }
+
+  Values read() const {
+    Values values;
+
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+      uint64_t buffer[3];
+      if (-1 != fds_[i] && sizeof(buffer) == ::read(fds_[i], buffer, sizeof(buffer))) {
+        const uint64_t enabled = buffer[1];
+        const uint64_t running = buffer[2];
+        values.counts[i] = (0 == running) ? 0L : (long)((double)buffer[0] * enabled / running);
+        values.available[i] = true;
+      }
+    }
+
+    return values;
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+private:
+  static int open(const uint32_t type, const uint64_t config) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+};
+
+}
+}
+
+#endif /* __VARONT_PERF_PERFCOUNTERS_HPP__ */
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PERF_PERFTESTSUPPORT_HPP__
+#define __VARONT_PERF_PERFTESTSUPPORT_HPP__
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "Sequence.hpp"
+#include "Util.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "MultiThreadedClaimStrategy.hpp"
+#include "MultiThreadedLowContentionClaimStrategy.hpp"
+#include "BlockingWaitStrategy.hpp"
+#include "BusySpinWaitStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+#include "EventFdWaitStrategy.hpp"
+#include "YieldingWaitStrategy.hpp"
+
+namespace varont {
+namespace perf {
+
+/**
+ * Command line options shared by the perf tests:
+ *
+ *   --iterations=N   events published per run
+ *   --runs=N         runs per strategy combination
+ *   --buffer-size=N  size of each RingBuffer and queue, a power of 2
+ */
+struct Options {
+  long iterations;
+  int runs;
+  int bufferSize;
+
+  Options(const long defaultIterations)
+    : iterations(defaultIterations)
+    , runs(3)
+    , bufferSize(1024 * 64)
+  {}
+
+  void parse(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+      if (!parseOption(argv[i])) {
+        std::fprintf(stderr, "unrecognised option: %s\n", argv[i]);
+        std::exit(1);
+      }
+    }
+  }
+
+protected:
+  virtual bool parseOption(const char* arg) {
+    return parseLong(arg, "--iterations=", iterations)
+      || parseInt(arg, "--runs=", runs)
+      || parseInt(arg, "--buffer-size=", bufferSize);
+  }
+
+  static bool parseLong(const char* arg, const char* name, long& value) {
+    const std::size_t length = std::strlen(name);
+    if (0 != std::strncmp(arg, name, length)) {
+      return false;
+    }
+    value = std::atol(arg + length);
+    return true;
+  }
+
+  static bool parseInt(const char* arg, const char* name, int& value) {
+    long parsed;
+    if (!parseLong(arg, name, parsed)) {
+      return false;
+    }
+    value = (int)parsed;
+    return true;
+  }
+
+  /* Like parseLong, but exits on a value below 1, which would divide by zero or never advance. */
+  static bool parsePositiveLong(const char* arg, const char* name, long& value) {
+    if (!parseLong(arg, name, value)) {
+      return false;
+    }
+    if (value < 1L) {
+      std::fprintf(stderr, "option must be at least 1: %s\n", arg);
+      std::exit(1);
+    }
+    return true;
+  }
+
+  static bool parsePositiveInt(const char* arg, const char* name, int& value) {
+    long parsed;
+    if (!parsePositiveLong(arg, name, parsed)) {
+      return false;
+    }
+    value = (int)parsed;
+    return true;
+  }
+
+public:
+  virtual ~Options() {}
+};
+
+template <typename S> struct StrategyName;
+
+template <> struct StrategyName<SingleThreadedClaimStrategy> {
+  static const char* get() { return "SingleThreaded"; }
+};
+
+template <> struct StrategyName<MultiThreadedClaimStrategy> {
+  static const char* get() { return "MultiThreaded"; }
+};
+
+template <> struct StrategyName<MultiThreadedLowContentionClaimStrategy> {
+  static const char* get() { return "MultiThreadedLowContention"; }
+};
+
+template <> struct StrategyName<BlockingWaitStrategy> {
+  static const char* get() { return "Blocking"; }
+};
+
+template <> struct StrategyName<SleepingWaitStrategy> {
+  static const char* get() { return "Sleeping"; }
+};
+
+template <> struct StrategyName<EventFdWaitStrategy> {
+  static const char* get() { return "EventFd"; }
+};
+
+template <> struct StrategyName<YieldingWaitStrategy> {
+  static const char* get() { return "Yielding"; }
+};
+
+template <> struct StrategyName<BusySpinWaitStrategy> {
+  static const char* get() { return "BusySpin"; }
+};
+
+inline void printJsonString(const char* value) {
+  if (nullptr == value) {
+    std::printf("null");
+  }
+  else {
+    std::printf("\"%s\"", value);
+  }
+}
+
+/**
+ * Print one throughput measurement as a line of JSON.  Strategies are
+ * null for the queue baselines.
+ */
+inline void reportThroughput(const char* test, const char* implementation,
+                             const char* claimStrategy, const char* waitStrategy,
+                             const int run, const long iterations, const long elapsedNanos,
+                             const bool valid)
+{
+  const double opsPerSecond = (double)iterations * 1e9 / (double)std::max(1L, elapsedNanos);
+
+  std::printf("{\"test\":\"%s\",\"implementation\":\"%s\",\"claimStrategy\":", test, implementation);
+  printJsonString(claimStrategy);
+  std::printf(",\"waitStrategy\":");
+  printJsonString(waitStrategy);
+  std::printf(",\"run\":%d,\"iterations\":%ld,\"opsPerSecond\":%.0f,\"valid\":%s}\n",
+              run, iterations, opsPerSecond, valid ? "true" : "false");
+  std::fflush(stdout);
+}
+
+/**
+ * Spin until a consumer has reached the expected sequence.
+ */
+inline void waitForSequence(Sequence& sequence, const long expected) {
+  while (sequence.get() < expected) {
+    std::this_thread::yield();
+  }
+}
+
+/**
+ * Run a scenario with a claim strategy against every wait strategy.  The busy spin strategy
+ * is skipped when there are fewer cores than the scenario's NUM_THREADS, as the spinning
+ * threads would then only hand over at the end of each scheduler time slice.
+ */
+template <typename Scenario, typename Claim, typename ScenarioOptions>
+void runWithEachWaitStrategy(Scenario& scenario, const ScenarioOptions& options) {
+  scenario.template run<Claim, BlockingWaitStrategy>(options);
+  scenario.template run<Claim, SleepingWaitStrategy>(options);
+  scenario.template run<Claim, EventFdWaitStrategy>(options);
+  scenario.template run<Claim, YieldingWaitStrategy>(options);
+
+  if (std::thread::hardware_concurrency() >= (unsigned)Scenario::NUM_THREADS) {
+    scenario.template run<Claim, BusySpinWaitStrategy>(options);
+  }
+  else {
+    std::fprintf(stderr, "skipping BusySpin: fewer than %d cores\n", (int)Scenario::NUM_THREADS);
+  }
+}
+
+/**
+ * Run a scenario against every combination of claim and wait strategy.
+ * The single threaded claim strategy is only used by scenarios with a
+ * single publisher.
+ */
+template <typename Scenario, typename ScenarioOptions>
+void runWithEachStrategy(Scenario& scenario, const ScenarioOptions& options, const bool singlePublisher) {
+  if (singlePublisher) {
+    runWithEachWaitStrategy<Scenario, SingleThreadedClaimStrategy>(scenario, options);
+  }
+  runWithEachWaitStrategy<Scenario, MultiThreadedClaimStrategy>(scenario, options);
+  runWithEachWaitStrategy<Scenario, MultiThreadedLowContentionClaimStrategy>(scenario, options);
+}
+
+}
+}
+
+#endif /* __VARONT_PERF_PERFTESTSUPPORT_HPP__ */
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PERF_THREADAFFINITY_HPP__
+#define __VARONT_PERF_THREADAFFINITY_HPP__
+
+#include <cstdio>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace varont {
+namespace perf {
+
+/**
+ * Bind the calling thread to a single cpu.  A negative cpu leaves the thread unbound.
+ *
+ * @return false, after printing a warning, if the affinity could not be set.
+ */
+inline bool pinCurrentThread(const int cpu) {
+  if (cpu < 0) {
+    return true;
+  }
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpu, &cpuSet);
+
+  const int rc = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuSet), &cpuSet);
+  if (0 != rc) {
+    std::fprintf(stderr, "unable to pin thread to cpu %d: %s\n", cpu, std::strerror(rc));
+    return false;
+  }
+
+  return true;
+}
+
+}
+}
+
+#endif /* __VARONT_PERF_THREADAFFINITY_HPP__ */
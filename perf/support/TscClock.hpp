@@ -0,0 +1,84 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PERF_TSCCLOCK_HPP__
+#define __VARONT_PERF_TSCCLOCK_HPP__
+
+#include <chrono>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define VARONT_PERF_HAVE_TSC 1
+#endif
+
+#include "Util.hpp"
+
+namespace varont {
+namespace perf {
+
+/**
+ * Cheap timestamps for latency measurement.  On x86 the time stamp counter is read
+ * directly and calibrated against the steady clock on construction; elsewhere the
+ * steady clock is used and ticks are nanoseconds.
+ *
+ * Comparing ticks taken on different cores relies on an invariant, synchronised TSC,
+ * which holds on current x86 parts but should be checked (constant_tsc and
+ * nonstop_tsc in /proc/cpuinfo) before trusting one way results.
+ */
+class TscClock {
+  static const long CALIBRATION_MILLIS = 50L;
+
+  double nanosPerTick_;
+
+public:
+  TscClock()
+    : nanosPerTick_(1.0)
+  {
+#ifdef VARONT_PERF_HAVE_TSC
+    const long startNanos = util::nanoTime();
+    const long startTicks = ticks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(CALIBRATION_MILLIS));
+    const long elapsedNanos = util::nanoTime() - startNanos;
+    const long elapsedTicks = ticks() - startTicks;
+    nanosPerTick_ = (double)elapsedNanos / (double)elapsedTicks;
+#endif
+  }
+
+  static long ticks() {
+#ifdef VARONT_PERF_HAVE_TSC
+    return (long)__rdtsc();
+#else
+    return util::nanoTime();
+#endif
+  }
+
+  long toNanos(const long ticks) const {
+    return (long)((double)ticks * nanosPerTick_);
+  }
+
+  static const char* getName() {
+#ifdef VARONT_PERF_HAVE_TSC
+    return "tsc";
+#else
+    return "steady_clock";
+#endif
+  }
+};
+
+}
+}
+
+#endif /* __VARONT_PERF_TSCCLOCK_HPP__ */
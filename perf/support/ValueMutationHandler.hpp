@@ -0,0 +1,74 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PERF_VALUEMUTATIONHANDLER_HPP__
+#define __VARONT_PERF_VALUEMUTATIONHANDLER_HPP__
+
+#include "LifecycleAwareEventHandler.hpp"
+
+#include "Events.hpp"
+
+namespace varont {
+namespace perf {
+
+enum class Operation {
+  Addition,
+  Subtraction,
+  And
+};
+
+inline long applyOperation(const Operation operation, const long value, const long operand) {
+  switch (operation) {
+  case Operation::Addition:
+    return value + operand;
+  case Operation::Subtraction:
+    return value - operand;
+  case Operation::And:
+    return value & operand;
+  }
+  return value;
+}
+
+/**
+ * Folds every event's value into a running result.
+ */
+class ValueMutationHandler
+  : public LifecycleAwareEventHandler<ValueEvent>
+{
+  const Operation operation_;
+  long value_;
+
+public:
+  ValueMutationHandler(const Operation operation)
+    : operation_(operation)
+    , value_(0L)
+  {}
+
+  void onEvent(ValueEvent& event, long sequence, bool endOfBatch) {
+    value_ = applyOperation(operation_, value_, event.value);
+  }
+
+  long getValue() const {
+    return value_;
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+}
+}
+
+#endif /* __VARONT_PERF_VALUEMUTATIONHANDLER_HPP__ */
@@ -22,6 +22,7 @@
 #include "ClaimStrategy.hpp"
 #include "Sequencer.hpp"
 #include "PaddedLong.hpp"
+#include "Metrics.hpp"
 #include "Util.hpp"
 
 namespace varont {
@@ -33,12 +34,14 @@ class AbstractMultithreadedClaimStrategy
   const int bufferSize_;
   Sequence claimSequence_;
   long minGatingSequence_;
+  ProducerMetrics* metrics_;
 
 public:
   AbstractMultithreadedClaimStrategy(const int bufferSize)
     : bufferSize_(bufferSize)
     , claimSequence_(Sequencer::INITIAL_CURSOR_VALUE)
     , minGatingSequence_(Sequencer::INITIAL_CURSOR_VALUE)
+    , metrics_(nullptr)
   {}
 
   virtual const int getBufferSize() const {
@@ -64,7 +67,17 @@ public:
   }
 
   virtual long checkAndIncrement(const int availableCapacity, const int delta, std::vector<Sequence*>& gatingSequences)
-    throw(InsufficientCapacityException)
+  {
+    const long nextSequence = checkAndIncrement(availableCapacity, delta, gatingSequences, std::nothrow);
+    if (INSUFFICIENT_CAPACITY == nextSequence) {
+      throw InsufficientCapacityException("");
+    }
+
+    return nextSequence;
+  }
+
+  virtual long checkAndIncrement(const int availableCapacity, const int delta, std::vector<Sequence*>& gatingSequences,
+                                 const std::nothrow_t&)
   {
     for (;;) {
       long sequence = claimSequence_.get();
@@ -75,7 +88,7 @@ public:
         }
       }
       else {
-        throw InsufficientCapacityException("");
+        return INSUFFICIENT_CAPACITY;
       }
     }
   }
@@ -94,6 +107,10 @@ public:
 
   virtual void serialisePublishing(const long sequence, Sequence& cursor, const long batchSize) { }
 
+  virtual void setMetrics(ProducerMetrics* metrics) {
+    metrics_ = metrics;
+  }
+
 private:
   void waitForCapacity(std::vector<Sequence*>& dependentSequences, long& minGatingSequence) {
     const long wrapPoint = (claimSequence_.get() + 1L) - bufferSize_;
@@ -112,8 +129,17 @@ private:
     const long wrapPoint = sequence - bufferSize_;
     if (wrapPoint > minGatingSequence) {
       long minSequence;
-      while (wrapPoint > (minSequence = util::getMinimumSequence(dependentSequences))) {
-        std::this_thread::sleep_for(std::chrono::nanoseconds(1L));
+      if (wrapPoint > (minSequence = util::getMinimumSequence(dependentSequences))) {
+        const long stallStart = (nullptr != metrics_) ? util::nanoTime() : 0L;
+
+        do {
+          std::this_thread::sleep_for(std::chrono::nanoseconds(1L));
+        } while (wrapPoint > (minSequence = util::getMinimumSequence(dependentSequences)));
+
+        if (nullptr != metrics_) {
+          metrics_->stalls.increment();
+          metrics_->stallNanos.increment(util::nanoTime() - stallStart);
+        }
       }
 
       /* XXX: should be reference?  or not? */
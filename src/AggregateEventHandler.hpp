@@ -48,6 +48,15 @@ class AggregateEventHandler
     }
   }
 
+  void onEvent(T& event, long sequence, bool endOfBatch, std::error_code& error) {
+    for (EventHandler<T>* eventHandler : eventHandlers_) {
+      eventHandler->onEvent(event, sequence, endOfBatch, error);
+      if (error) {
+        return;
+      }
+    }
+  }
+
   void onStart() {
     for (EventHandler<T>* eventHandler : eventHandlers_) {
     }
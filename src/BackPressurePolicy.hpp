@@ -0,0 +1,35 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_BACKPRESSUREPOLICY_HPP__
+#define __VARONT_BACKPRESSUREPOLICY_HPP__
+
+namespace varont {
+  /**
+   * What an {@link EventPublisher} does with an event when the {@link RingBuffer} is full.
+   */
+  enum class BackPressurePolicy {
+    /** Wait for the consumers to free a slot. */
+    Block,
+    /** Discard the event. */
+    DropNewest,
+    /** Wait for a slot up to a timeout, then discard the event. */
+    BlockWithTimeout,
+    /** Hand the event to an {@link OverflowHandler}. */
+    Redirect
+  };
+}
+
+#endif /* __VARONT_BACKPRESSUREPOLICY_HPP__ */
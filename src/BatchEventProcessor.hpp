@@ -24,6 +24,11 @@
 #include "Sequencer.hpp"
 #include "Sequence.hpp"
 #include "EventProcessor.hpp"
+#include "Histogram.hpp"
+#include "Metrics.hpp"
+#include "PublishTimestamps.hpp"
+#include "Trace.hpp"
+#include "Util.hpp"
 
 #include "IllegalStateException.hpp"
 #include "FatalExceptionHandler.hpp"
@@ -53,6 +58,10 @@ class BatchEventProcessor
   LifecycleAwareEventHandler<T>& eventHandler_;
   Sequence sequence_;
 
+  Histogram* latencyHistogram_;
+  long latencySampleMask_;
+  ProcessorMetrics* metrics_;
+
  public:
   BatchEventProcessor(RingBuffer<T>& ringBuffer, SequenceBarrier& sequenceBarrier, LifecycleAwareEventHandler<T>& eventHandler)
       : running_(false)
@@ -61,6 +70,9 @@ class BatchEventProcessor
       , sequenceBarrier_(sequenceBarrier)
       , eventHandler_(eventHandler)
       , sequence_(Sequencer::INITIAL_CURSOR_VALUE)
+      , latencyHistogram_(nullptr)
+      , latencySampleMask_(0L)
+      , metrics_(nullptr)
   {}
 
   Sequence& getSequence() {
@@ -79,6 +91,37 @@ class BatchEventProcessor
     exceptionHandler_ = &exceptionHandler;
   }
 
+  /**
+   * Record into histogram the delay, in nanoseconds, between each event being published and
+   * becoming available to this processor.  Requires the {@link RingBuffer} to have
+   * {@link PublishTimestamps} set; as the timestamps are taken at publication, the histogram
+   * of a processor further down a pipeline measures the delay from end to end.
+   *
+   * XXX: This method must be called before the processor is started.
+   *
+   * @param histogram to record into.
+   * @param sampleRate record one event in sampleRate, which must be a power of 2.
+   */
+  void setLatencyHistogram(Histogram& histogram, const int sampleRate = 1) {
+    if (util::bitCount(sampleRate) != 1) {
+      throw std::out_of_range("sampleRate must be a power of 2");
+    }
+
+    latencyHistogram_ = &histogram;
+    latencySampleMask_ = sampleRate - 1;
+  }
+
+  /**
+   * Record the size of each batch, and count handler exceptions and errors, into metrics.
+   *
+   * XXX: This method must be called before the processor is started.
+   *
+   * @param metrics to update.
+   */
+  void setMetrics(ProcessorMetrics& metrics) {
+    metrics_ = &metrics;
+  }
+
   /**
    * It is ok to have another thread rerun this method after a halt().
    */
@@ -93,25 +136,56 @@ class BatchEventProcessor
     notifyStart();
 
     T* event = nullptr;
+    std::error_code error;
     long nextSequence = sequence_.get() + 1L;
 
     while (true) {
+      long availableSequence = sequenceBarrier_.waitFor(nextSequence, std::nothrow);
+      if (SequenceBarrier::ALERTED == availableSequence) {
+        if (!running_.load()) {
+          break;
+        }
+        continue;
+      }
+
+      if (nullptr != latencyHistogram_) {
+        recordLatency(nextSequence, availableSequence);
+      }
+
+      if (nullptr != metrics_) {
+        metrics_->batchSizes.record(availableSequence - nextSequence + 1L);
+      }
+      VARONT_TRACE(batch_start, nextSequence, availableSequence);
+
       try {
-        long availableSequence = sequenceBarrier_.waitFor(nextSequence);
         while (nextSequence <= availableSequence) {
           event = &ringBuffer_.get(nextSequence);
-          eventHandler_.onEvent(*event, nextSequence, nextSequence == availableSequence);
+          eventHandler_.onEvent(*event, nextSequence, nextSequence == availableSequence, error);
+          if (error) {
+            if (nullptr != metrics_) {
+              metrics_->errors.increment();
+            }
+            if (!exceptionHandler_->handleEventError(error, nextSequence)) {
+              running_.store(false);
+              break;
+            }
+            error.clear();
+          }
           nextSequence++;
         }
 
         sequence_.set(nextSequence - 1L);
-      }
-      catch (AlertException ex) {
-        if (!running_.load()) {
+        VARONT_TRACE(batch_end, nextSequence - 1L, 0);
+        if (error) {
           break;
         }
       }
-      catch (std::exception ex) {
+      catch (std::exception& ex) {
+        /* An exception from handleEventError is the error already counted, not a second failure. */
+        if (nullptr != metrics_ && !error) {
+          metrics_->exceptions.increment();
+        }
+        error.clear();
         exceptionHandler_->handleEventException(ex, nextSequence);
         sequence_.set(nextSequence);
         nextSequence++;
@@ -124,6 +198,20 @@ class BatchEventProcessor
   }
 
  private:
+  void recordLatency(const long firstSequence, const long lastSequence) {
+    PublishTimestamps* publishTimestamps = ringBuffer_.getPublishTimestamps();
+    if (nullptr == publishTimestamps) {
+      return;
+    }
+
+    const long now = util::nanoTime();
+    for (long sequence = (firstSequence + latencySampleMask_) & ~latencySampleMask_;
+         sequence <= lastSequence;
+         sequence += latencySampleMask_ + 1L) {
+      latencyHistogram_->record(now - publishTimestamps->get(sequence));
+    }
+  }
+
   void notifyStart() {
     try {
       eventHandler_.onStart();
@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <chrono>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
@@ -25,13 +26,15 @@
 #include "WaitStrategy.hpp"
 #include "Util.hpp"
 #include "TimeUnit.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
 
 namespace varont {
 
 class WaiterGuard {
-  int& numWaiters_;
+  std::atomic_int& numWaiters_;
 public:
-  WaiterGuard(int &numWaiters)
+  WaiterGuard(std::atomic_int& numWaiters)
     : numWaiters_(numWaiters)
   {
     ++numWaiters_;
@@ -52,11 +55,16 @@ class BlockingWaitStrategy
 {
   std::mutex lock_;
   std::condition_variable processorNotifyCondition_;
-  int numWaiters_;
+  std::atomic_int numWaiters_;
+  WaitMetrics* metrics_;
 
 public:
+  BlockingWaitStrategy()
+    : numWaiters_(0)
+    , metrics_(nullptr)
+  {}
+
   long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier)
-    throw(AlertException)
   {
     long availableSequence;
 
@@ -65,14 +73,21 @@ public:
       WaiterGuard waiterGuard(numWaiters_);
 
       while ((availableSequence = cursor.get()) < sequence) {
-        barrier.checkAlert();
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        countPark();
+        VARONT_TRACE(park, 0, 0);
         processorNotifyCondition_.wait(lock);
+        VARONT_TRACE(wake, 0, 0);
       }
     }
 
     if (0 != dependents.size()) {
       while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
-        barrier.checkAlert();
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
       }
     }
 
@@ -81,7 +96,6 @@ public:
 
   long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier,
                long timeout, TimeUnit sourceUnit)
-    throw(AlertException)
   {
     long availableSequence;
 
@@ -90,9 +104,15 @@ public:
       WaiterGuard waiterGuard(numWaiters_);
 
       while ((availableSequence = cursor.get()) < sequence) {
-        barrier.checkAlert();
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
 
-        if (std::cv_status::timeout == processorNotifyCondition_.wait_for(lock, std::chrono::milliseconds(timeout))) {
+        countPark();
+        VARONT_TRACE(park, 0, 0);
+        const std::cv_status status = processorNotifyCondition_.wait_for(lock, std::chrono::milliseconds(timeout));
+        VARONT_TRACE(wake, 0, 0);
+        if (std::cv_status::timeout == status) {
           break;
         }
       }
@@ -100,7 +120,9 @@ public:
 
     if (0 != dependents.size()) {
       while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
-        barrier.checkAlert();
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
       }
     }
 
@@ -111,9 +133,23 @@ public:
     if (0 != numWaiters_) {
       std::lock_guard<std::mutex> lock(lock_);
       processorNotifyCondition_.notify_all();
+
+      if (nullptr != metrics_) {
+        metrics_->wakeups.increment();
+      }
     }
   }
 
+  void setMetrics(WaitMetrics* metrics) {
+    metrics_ = metrics;
+  }
+
+private:
+  void countPark() {
+    if (nullptr != metrics_) {
+      metrics_->parks.increment();
+    }
+  }
 
 };
 
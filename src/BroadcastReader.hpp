@@ -0,0 +1,133 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_BROADCASTREADER_HPP__
+#define __VARONT_BROADCASTREADER_HPP__
+
+#include <atomic>
+#include <cstring>
+
+#include "BroadcastRingBuffer.hpp"
+
+namespace varont {
+
+/**
+ * Reader of a {@link BroadcastRingBuffer}, which the publisher never waits for.  Readers
+ * are independent of each other and of the publisher, so any number may be created and
+ * dropped at any time, each used by one thread.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class BroadcastReader {
+ public:
+  /**
+   * Outcome of a call to read.
+   */
+  enum class ReadStatus {
+    /** The next event was copied out. */
+    Ok,
+    /** The next event has not been published yet. */
+    Unavailable,
+    /** The next event was overwritten before it could be read; the reader has skipped to the oldest event. */
+    Lapped
+  };
+
+ private:
+  BroadcastRingBuffer<T>& ringBuffer_;
+  long sequence_;
+  long lostCount_;
+
+ public:
+  /**
+   * Create a reader of the events published from now on.
+   *
+   * @param ringBuffer to read.
+   */
+  BroadcastReader(BroadcastRingBuffer<T>& ringBuffer)
+      : ringBuffer_(ringBuffer)
+      , sequence_(ringBuffer.getCursor() + 1L)
+      , lostCount_(0L)
+  {}
+
+  /**
+   * Create a reader starting at a given sequence.
+   *
+   * @param ringBuffer to read.
+   * @param sequence of the first event to read.
+   */
+  BroadcastReader(BroadcastRingBuffer<T>& ringBuffer, const long sequence)
+      : ringBuffer_(ringBuffer)
+      , sequence_(sequence)
+      , lostCount_(0L)
+  {}
+
+  /**
+   * Get the sequence of the next event to be read.
+   */
+  long getSequence() const {
+    return sequence_;
+  }
+
+  /**
+   * Get the number of events skipped because the reader was lapped.
+   */
+  long getLostCount() const {
+    return lostCount_;
+  }
+
+  /**
+   * Copy out the next event without waiting.
+   *
+   * @param event to copy the next event into, left unspecified unless Ok is returned.
+   * @return whether the event was read, is not yet available, or was lost.
+   */
+  ReadStatus read(T& event) {
+    typename BroadcastRingBuffer<T>::Slot& slot = ringBuffer_.getSlot(sequence_);
+    const long stamp = slot.stamp.load(std::memory_order_acquire);
+
+    if (stamp == 2L * sequence_) {
+      std::memcpy(static_cast<void*>(&event), static_cast<const void*>(&slot.value), sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.stamp.load(std::memory_order_relaxed) == stamp) {
+        ++sequence_;
+        return ReadStatus::Ok;
+      }
+    }
+    else if (stamp < 2L * sequence_ + 2L) {
+      return ReadStatus::Unavailable;
+    }
+
+    resynchronize();
+    return ReadStatus::Lapped;
+  }
+
+  BroadcastReader(const BroadcastReader&) = delete;
+  BroadcastReader& operator=(const BroadcastReader&) = delete;
+
+ private:
+  /* Skips to the oldest event that the publisher is not about to overwrite. */
+  void resynchronize() {
+    const long oldestSequence = ringBuffer_.getCursor() + 2L - ringBuffer_.getBufferSize();
+    if (oldestSequence > sequence_) {
+      lostCount_ += oldestSequence - sequence_;
+      sequence_ = oldestSequence;
+    }
+  }
+};
+
+}
+
+#endif /* __VARONT_BROADCASTREADER_HPP__ */
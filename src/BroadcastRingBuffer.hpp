@@ -0,0 +1,151 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_BROADCASTRINGBUFFER_HPP__
+#define __VARONT_BROADCASTRINGBUFFER_HPP__
+
+#include <atomic>
+#include <type_traits>
+#include <stdexcept>
+
+#include "Sequence.hpp"
+#include "Sequencer.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+/**
+ * Lossy ring buffer for broadcasting to any number of readers which must never slow the
+ * publisher, such as telemetry and monitoring.  The publisher does not wait on readers;
+ * it overwrites the oldest slot, and a {@link BroadcastReader} which falls more than a
+ * buffer behind is told that it has been lapped and skips ahead.
+ *
+ * Each slot carries a stamp acting as a seqlock: twice the sequence it holds, plus one
+ * while the publisher is writing it.  A reader copies the value out and only accepts the
+ * copy if the stamp was the same before and after, so events must be trivially copyable.
+ * There must be a single publisher.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class BroadcastRingBuffer {
+  static_assert(std::is_trivially_copyable<T>::value, "events must be trivially copyable");
+
+ public:
+  struct Slot {
+    std::atomic_long stamp;
+    T value;
+
+    Slot()
+      : stamp(2L * Sequencer::INITIAL_CURSOR_VALUE)
+      , value()
+    {}
+  };
+
+ private:
+  const int bufferSize_;
+  const int indexMask_;
+  Slot* slots_;
+  Sequence cursor_;
+
+ public:
+  /**
+   * @param bufferSize number of slots, which must be a power of 2.
+   */
+  BroadcastRingBuffer(const int bufferSize)
+      : bufferSize_(bufferSize)
+      , indexMask_(bufferSize - 1)
+      , slots_(nullptr)
+      , cursor_(Sequencer::INITIAL_CURSOR_VALUE)
+  {
+    if (bufferSize < 1 || util::bitCount(bufferSize) != 1) {
+      throw std::out_of_range("bufferSize must be a power of 2");
+    }
+
+    slots_ = new Slot[bufferSize];
+  }
+
+  ~BroadcastRingBuffer() {
+    delete [] slots_;
+  }
+
+  const int getBufferSize() const {
+    return bufferSize_;
+  }
+
+  /**
+   * Get the sequence of the last published event.
+   */
+  long getCursor() {
+    return cursor_.get();
+  }
+
+  /**
+   * Claim the next slot, marking it as being written so that readers of the event it
+   * held discard their copies.  Never waits.
+   *
+   * @return the claimed sequence.
+   */
+  long next() {
+    const long sequence = cursor_.get() + 1L;
+    getSlot(sequence).stamp.store(2L * sequence + 1L, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence;
+  }
+
+  /**
+   * Get the event of a claimed sequence for writing.
+   */
+  T& get(const long sequence) {
+    return getSlot(sequence).value;
+  }
+
+  /**
+   * Make the event of a claimed sequence visible to readers.
+   *
+   * @param sequence returned by next().
+   */
+  void publish(const long sequence) {
+    getSlot(sequence).stamp.store(2L * sequence, std::memory_order_release);
+    cursor_.set(sequence);
+  }
+
+  /**
+   * Publish a copy of an event.
+   *
+   * @param event to copy into the next slot.
+   * @return the sequence of the event.
+   */
+  long publish(const T& event) {
+    const long sequence = next();
+    get(sequence) = event;
+    publish(sequence);
+    return sequence;
+  }
+
+  /**
+   * Get the slot for a sequence, for use by a {@link BroadcastReader}.
+   */
+  Slot& getSlot(const long sequence) {
+    return slots_[(int)sequence & indexMask_];
+  }
+
+  BroadcastRingBuffer(const BroadcastRingBuffer&) = delete;
+  BroadcastRingBuffer& operator=(const BroadcastRingBuffer&) = delete;
+};
+
+}
+
+#endif /* __VARONT_BROADCASTRINGBUFFER_HPP__ */
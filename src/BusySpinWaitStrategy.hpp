@@ -0,0 +1,97 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_BUSYSPINWAITSTRATEGY_HPP__
+#define __VARONT_BUSYSPINWAITSTRATEGY_HPP__
+
+#include <vector>
+
+#include "SequenceBarrier.hpp"
+#include "WaitStrategy.hpp"
+#include "Util.hpp"
+#include "TimeUnit.hpp"
+
+namespace varont {
+/**
+ * Busy Spin strategy that uses a busy spin loop for {@link EventProcessor}s waiting on a barrier.
+ *
+ * This strategy will use CPU resource to avoid syscalls which can introduce latency jitter.  It is best
+ * used when threads can be bound to specific CPU cores.
+ */
+class BusySpinWaitStrategy
+  : public WaitStrategy
+{
+public:
+  long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier)
+  {
+    long availableSequence;
+
+    if (dependents.empty()) {
+      while ((availableSequence = cursor.get()) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+      }
+    }
+    else {
+      while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+      }
+    }
+
+    return availableSequence;
+  }
+
+  long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier,
+               long timeout, TimeUnit sourceUnit)
+  {
+    const long deadline = util::nanoTime() + util::toNanos(timeout, sourceUnit);
+    long availableSequence;
+
+    if (dependents.empty()) {
+      while ((availableSequence = cursor.get()) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+
+        if (util::nanoTime() > deadline) {
+          break;
+        }
+      }
+    }
+    else {
+      while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+
+        if (util::nanoTime() > deadline) {
+          break;
+        }
+      }
+    }
+
+    return availableSequence;
+  }
+
+  void signalAllWhenBlocking() {
+  }
+};
+
+}
+
+#endif /* __VARONT_BUSYSPINWAITSTRATEGY_HPP__ */
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_BYTERECORDHANDLER_HPP__
+#define __VARONT_BYTERECORDHANDLER_HPP__
+
+#include "LifecycleAware.hpp"
+#include "ByteRingBuffer.hpp"
+
+namespace varont {
+
+/**
+ * Callback interface to be implemented for processing records as they become available
+ * in a {@link ByteRingBuffer}.
+ */
+class ByteRecordHandler
+    : public LifecycleAware
+{
+ public:
+  /**
+   * Called when a publisher has published a record to the {@link ByteRingBuffer}.
+   * Padding records are skipped.
+   *
+   * @param record view of the published record, valid only for the duration of the call.
+   * @param sequence of the last unit of the record.
+   * @param endOfBatch flag to indicate if this is the last record in a batch from the {@link ByteRingBuffer}
+   */
+  virtual void onRecord(const ByteRecord& record, long sequence, bool endOfBatch) = 0;
+
+ protected:
+  ~ByteRecordHandler() {}
+};
+
+}
+
+#endif /* __VARONT_BYTERECORDHANDLER_HPP__ */
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_BYTERECORDPROCESSOR_HPP__
+#define __VARONT_BYTERECORDPROCESSOR_HPP__
+
+#include <atomic>
+#include <new>
+
+#include "ByteRingBuffer.hpp"
+#include "ByteRecordHandler.hpp"
+#include "SequenceBarrier.hpp"
+#include "Sequencer.hpp"
+#include "Sequence.hpp"
+#include "EventProcessor.hpp"
+#include "Trace.hpp"
+
+#include "IllegalStateException.hpp"
+#include "FatalExceptionHandler.hpp"
+
+namespace varont {
+
+/**
+ * Consumes the records of a {@link ByteRingBuffer} in batches, delegating each record
+ * other than padding to a {@link ByteRecordHandler}.
+ *
+ * The processor's {@link Sequence} is the last unit of the last record processed, and
+ * must be added to the gating sequences of the {@link ByteRingBuffer}.
+ */
+class ByteRecordProcessor
+    : public EventProcessor
+{
+  std::atomic_bool running_;
+
+  FatalExceptionHandler defaultExceptionHandler_;
+  ExceptionHandler* exceptionHandler_;
+
+  ByteRingBuffer& ringBuffer_;
+  SequenceBarrier& sequenceBarrier_;
+  ByteRecordHandler& recordHandler_;
+  Sequence sequence_;
+
+ public:
+  ByteRecordProcessor(ByteRingBuffer& ringBuffer, SequenceBarrier& sequenceBarrier, ByteRecordHandler& recordHandler)
+      : running_(false)
+      , exceptionHandler_(&defaultExceptionHandler_)
+      , ringBuffer_(ringBuffer)
+      , sequenceBarrier_(sequenceBarrier)
+      , recordHandler_(recordHandler)
+      , sequence_(Sequencer::INITIAL_CURSOR_VALUE)
+  {}
+
+  Sequence& getSequence() {
+    return sequence_;
+  }
+
+  void halt() {
+    running_.store(false);
+    sequenceBarrier_.alert();
+  }
+
+  /**
+   * Set a new ExceptionHandler for handling exceptions propagated out of the ByteRecordProcessor.
+   */
+  void setExceptionHandler(ExceptionHandler& exceptionHandler) {
+    exceptionHandler_ = &exceptionHandler;
+  }
+
+  /**
+   * It is ok to have another thread rerun this method after a halt().
+   */
+  void operator()() {
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+      throw IllegalStateException("Thread is already running");
+    }
+
+    sequenceBarrier_.clearAlert();
+
+    notifyStart();
+
+    long nextSequence = sequence_.get() + 1L;
+
+    while (true) {
+      const long availableSequence = sequenceBarrier_.waitFor(nextSequence, std::nothrow);
+      if (SequenceBarrier::ALERTED == availableSequence) {
+        if (!running_.load()) {
+          break;
+        }
+        continue;
+      }
+
+      VARONT_TRACE(batch_start, nextSequence, availableSequence);
+
+      nextSequence = skipPadding(nextSequence, availableSequence);
+      while (nextSequence <= availableSequence) {
+        const ByteRecord record = ringBuffer_.get(nextSequence);
+        const long endSequence = nextSequence + ByteRingBuffer::getUnits(record.length) - 1L;
+        nextSequence = skipPadding(endSequence + 1L, availableSequence);
+
+        try {
+          recordHandler_.onRecord(record, endSequence, nextSequence > availableSequence);
+        }
+        catch (std::exception& ex) {
+          exceptionHandler_->handleEventException(ex, endSequence);
+        }
+      }
+
+      sequence_.set(availableSequence);
+      VARONT_TRACE(batch_end, availableSequence, 0);
+    }
+
+    notifyShutdown();
+
+    running_.store(false);
+  }
+
+  ByteRecordProcessor(const ByteRecordProcessor&) = delete;
+  ByteRecordProcessor& operator=(const ByteRecordProcessor&) = delete;
+
+ private:
+  long skipPadding(long sequence, const long availableSequence) {
+    while (sequence <= availableSequence) {
+      const ByteRecord record = ringBuffer_.get(sequence);
+      if (ByteRingBuffer::PADDING_TYPE != record.type) {
+        break;
+      }
+      sequence += ByteRingBuffer::getUnits(record.length);
+    }
+    return sequence;
+  }
+
+  void notifyStart() {
+    try {
+      recordHandler_.onStart();
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleOnStartException(ex);
+    }
+  }
+
+  void notifyShutdown() {
+    try {
+      recordHandler_.onShutdown();
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleOnShutdownException(ex);
+    }
+  }
+};
+
+}
+
+#endif /* __VARONT_BYTERECORDPROCESSOR_HPP__ */
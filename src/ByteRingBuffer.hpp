@@ -0,0 +1,216 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_BYTERINGBUFFER_HPP__
+#define __VARONT_BYTERINGBUFFER_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "Sequencer.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+/**
+ * Zero-copy view of a record in a {@link ByteRingBuffer}, valid until the consumer's
+ * {@link Sequence} moves past it.
+ */
+struct ByteRecord {
+  const char* data;
+  int length;
+  int type;
+};
+
+/**
+ * Extent of a record claimed for publishing in a {@link ByteRingBuffer}.  The payload
+ * is written to data before the claim is passed to publish.
+ */
+struct ByteRecordClaim {
+  long sequence;
+  int units;
+  char* data;
+  int length;
+};
+
+/**
+ * Ring of variable length records stored contiguously, each prefixed by its length
+ * and type.
+ *
+ * Every sequence of the {@link Sequencer} stands for one ALIGNMENT byte unit of the
+ * buffer, so that a record of n bytes is claimed as HEADER_LENGTH + n bytes rounded up
+ * to whole units through the {@link ClaimStrategy}.  A claim that would straddle the
+ * end of the buffer is published as padding, which consumers skip, and claimed again
+ * from the start of the buffer.  Records take at most half of the buffer, so that the
+ * second claim always fits before the end.
+ *
+ * Records can take many units, so use a {@link SingleThreadedClaimStrategy}
+ * or a {@link MultiThreadedLowContentionClaimStrategy}; the
+ * {@link MultiThreadedClaimStrategy} cannot serialise a batch larger than its pending
+ * buffer.
+ */
+class ByteRingBuffer
+  : public Sequencer
+{
+public:
+  static const int ALIGNMENT = 8;
+  static const int HEADER_LENGTH = 8;
+
+  /** Type of the records filling the space skipped at the end of the buffer. */
+  static const int PADDING_TYPE = -1;
+
+private:
+  struct RecordHeader {
+    int32_t length;
+    int32_t type;
+  };
+
+  int indexMask_;
+  int bufferSize_;
+  uint64_t* units_;
+
+public:
+  /**
+   * @param claimStrategy whose buffer size, a power of 2, is the capacity in ALIGNMENT byte units.
+   * @param waitStrategy waiting strategy employed by consumers waiting on records becoming available.
+   */
+  ByteRingBuffer(ClaimStrategy& claimStrategy, WaitStrategy& waitStrategy)
+    : Sequencer(claimStrategy, waitStrategy)
+    , indexMask_(claimStrategy.getBufferSize() - 1)
+    , bufferSize_(claimStrategy.getBufferSize())
+    , units_(nullptr)
+  {
+    if (util::bitCount(bufferSize_) != 1) {
+      throw std::out_of_range("bufferSize must be a power of 2");
+    }
+
+    units_ = new uint64_t[bufferSize_]();
+  }
+
+  ~ByteRingBuffer() {
+    delete [] units_;
+  }
+
+  /**
+   * Get the capacity of the buffer in bytes.
+   */
+  int getCapacity() const {
+    return bufferSize_ * ALIGNMENT;
+  }
+
+  /**
+   * Get the largest record length that can be claimed, a record and its header taking
+   * at most half the capacity.
+   */
+  int getMaxRecordLength() const {
+    return getCapacity() / 2 - HEADER_LENGTH;
+  }
+
+  /**
+   * Get the number of units taken by a record of length bytes.
+   */
+  static int getUnits(const int length) {
+    return (HEADER_LENGTH + length + ALIGNMENT - 1) / ALIGNMENT;
+  }
+
+  /**
+   * Claim a contiguous extent for a record, waiting for consumers to free the space.
+   *
+   * @param length of the record payload in bytes.
+   * @param type of the record, which must not be negative.
+   * @return the claim, whose data is to be filled before passing it to publish.
+   */
+  ByteRecordClaim next(const int length, const int type) {
+    if (length < 0 || length > getMaxRecordLength()) {
+      throw std::out_of_range("length must not be negative or greater than the maximum record length");
+    }
+
+    if (type < 0) {
+      throw std::out_of_range("type must not be negative");
+    }
+
+    const int units = getUnits(length);
+    while (true) {
+      const long end = Sequencer::next(units);
+      const long start = end - units + 1L;
+      const int index = (int)start & indexMask_;
+
+      if (index + units <= bufferSize_) {
+        writeHeader(index, length, type);
+        return ByteRecordClaim{ end, units, reinterpret_cast<char*>(&units_[index + 1]), length };
+      }
+
+      /* Pad the tail of the buffer and the part claimed past the wrap, then try again from the start. */
+      const int tailUnits = bufferSize_ - index;
+      writeHeader(index, tailUnits * ALIGNMENT - HEADER_LENGTH, PADDING_TYPE);
+      writeHeader(0, (units - tailUnits) * ALIGNMENT - HEADER_LENGTH, PADDING_TYPE);
+      Sequencer::publish(end, units);
+    }
+  }
+
+  /**
+   * Publish a claimed record, making it visible to consumers.
+   *
+   * @param claim returned by next.
+   */
+  void publish(const ByteRecordClaim& claim) {
+    Sequencer::publish(claim.sequence, claim.units);
+  }
+
+  using Sequencer::next;
+  using Sequencer::publish;
+
+  /**
+   * Claim, copy and publish a record.
+   *
+   * @param type of the record, which must not be negative.
+   * @param data to copy into the record.
+   * @param length of data in bytes.
+   * @return the sequence of the last unit of the record.
+   */
+  long publish(const int type, const void* data, const int length) {
+    ByteRecordClaim claim = next(length, type);
+    std::memcpy(claim.data, data, length);
+    publish(claim);
+    return claim.sequence;
+  }
+
+  /**
+   * Get the record starting at a sequence.  Padding records have PADDING_TYPE.
+   *
+   * @param sequence of the first unit of a published record.
+   * @return view of the record.
+   */
+  ByteRecord get(const long sequence) const {
+    const int index = (int)sequence & indexMask_;
+    const RecordHeader* header = reinterpret_cast<const RecordHeader*>(&units_[index]);
+    return ByteRecord{ reinterpret_cast<const char*>(&units_[index + 1]), header->length, header->type };
+  }
+
+  ByteRingBuffer(const ByteRingBuffer&) = delete;
+  ByteRingBuffer& operator=(const ByteRingBuffer&) = delete;
+
+private:
+  void writeHeader(const int index, const int length, const int type) {
+    RecordHeader* header = reinterpret_cast<RecordHeader*>(&units_[index]);
+    header->length = length;
+    header->type = type;
+  }
+};
+
+}
+
+#endif /* __VARONT_BYTERINGBUFFER_HPP__ */
@@ -16,12 +16,15 @@
 #ifndef __VARONT_CLAIMSTRATEGY_HPP__
 #define __VARONT_CLAIMSTRATEGY_HPP__
 
+#include <climits>
+#include <new>
 #include <vector>
 
 #include "InsufficientCapacityException.hpp"
 
 namespace varont {
 class Seqeunce;
+struct ProducerMetrics;
 
 /**
  * Strategy contract for claiming the sequence of events in the {@link
@@ -29,6 +32,12 @@ class Seqeunce;
  */
 class ClaimStrategy {
 public:
+  /**
+   * Returned by the non-throwing variant of checkAndIncrement in place of a sequence when
+   * the capacity is not available.
+   */
+  static const long INSUFFICIENT_CAPACITY = LONG_MIN;
+
   /**
    * Get the size of the data structure used to buffer events.
    *
@@ -99,8 +108,26 @@ public:
    * @return the slot after incrementing
    * @throws InsufficientCapacityException thrown if capacity is not available
    */
-  virtual long checkAndIncrement(const int availableCapacity, const int delta, std::vector<Sequence*>& gatingSequences)
-    throw(InsufficientCapacityException) = 0;
+  virtual long checkAndIncrement(const int availableCapacity, const int delta, std::vector<Sequence*>& gatingSequences) = 0;
+
+  /**
+   * Atomically checks the available capacity of the ring buffer and claims the next sequence,
+   * without raising an {@link InsufficientCapacityException}.
+   *
+   * @param availableCapacity the capacity that should be available before claiming the next slot
+   * @param delta the number of slots to claim
+   * @param gatingSequences the set of sequences to check to ensure capacity is available
+   * @return the slot after incrementing or INSUFFICIENT_CAPACITY if the capacity is not available.
+   */
+  virtual long checkAndIncrement(const int availableCapacity, const int delta, std::vector<Sequence*>& gatingSequences,
+                                 const std::nothrow_t&) = 0;
+
+  /**
+   * Count the stalls of publishers waiting for a free slot into metrics.
+   *
+   * @param metrics to update, or nullptr to stop counting.
+   */
+  virtual void setMetrics(ProducerMetrics* metrics) { }
 
 protected:
   ~ClaimStrategy() {}
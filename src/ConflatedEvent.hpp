@@ -0,0 +1,56 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_CONFLATEDEVENT_HPP__
+#define __VARONT_CONFLATEDEVENT_HPP__
+
+#include <atomic>
+
+namespace varont {
+
+/**
+ * Slot of a {@link RingBuffer} carrying keyed updates published by a
+ * {@link ConflatingPublisher} and consumed by a {@link ConflatingEventHandler}.
+ *
+ * The state decides who may touch the value: the publisher may overwrite it in place only
+ * while it is Pending, and the consumer takes it before reading, after which it is never
+ * overwritten.
+ *
+ * @param <T> value of an update.
+ * @param <K> key of an update, such as a symbol.
+ */
+template <typename T, typename K>
+struct ConflatedEvent {
+  enum State {
+    /** Published and not yet taken, so a later update for the key may replace the value. */
+    Pending,
+    /** Being overwritten by the publisher. */
+    Writing,
+    /** Taken by the consumer. */
+    Taken
+  };
+
+  std::atomic_int state;
+  K key;
+  T value;
+
+  ConflatedEvent()
+    : state(Taken)
+  {}
+};
+
+}
+
+#endif /* __VARONT_CONFLATEDEVENT_HPP__ */
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_CONFLATINGEVENTHANDLER_HPP__
+#define __VARONT_CONFLATINGEVENTHANDLER_HPP__
+
+#include <thread>
+
+#include "ConflatedEvent.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+
+namespace varont {
+
+/**
+ * Consumer of the updates published by a {@link ConflatingPublisher}.  Each update is taken
+ * from its slot before being handed to onUpdate, after which the publisher no longer
+ * overwrites it, so onUpdate always sees a complete value which is the latest for its key
+ * at the time it was taken.
+ *
+ * @param <T> value of an update.
+ * @param <K> key of an update.
+ */
+template <typename T, typename K>
+class ConflatingEventHandler
+    : public LifecycleAwareEventHandler<ConflatedEvent<T, K>>
+{
+ public:
+  /**
+   * Called with the latest update for a key.
+   *
+   * @param key of the update.
+   * @param value of the update.
+   * @param sequence of the slot holding the update.
+   * @param endOfBatch flag to indicate if this is the last event in a batch from the {@link RingBuffer}
+   */
+  virtual void onUpdate(const K& key, const T& value, long sequence, bool endOfBatch) = 0;
+
+  void onEvent(ConflatedEvent<T, K>& event, long sequence, bool endOfBatch) {
+    int expected = ConflatedEvent<T, K>::Pending;
+    while (!event.state.compare_exchange_weak(expected, ConflatedEvent<T, K>::Taken, std::memory_order_acquire)) {
+      /* The publisher is overwriting the value, which takes a moment. */
+      expected = ConflatedEvent<T, K>::Pending;
+      std::this_thread::yield();
+    }
+
+    onUpdate(event.key, event.value, sequence, endOfBatch);
+  }
+
+  void onStart() { }
+
+  void onShutdown() { }
+
+ protected:
+  ~ConflatingEventHandler() {}
+};
+
+}
+
+#endif /* __VARONT_CONFLATINGEVENTHANDLER_HPP__ */
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_CONFLATINGPUBLISHER_HPP__
+#define __VARONT_CONFLATINGPUBLISHER_HPP__
+
+#include <functional>
+#include <unordered_map>
+
+#include "ConflatedEvent.hpp"
+#include "RingBuffer.hpp"
+
+namespace varont {
+
+/**
+ * Publisher of keyed updates, such as quotes per symbol, for which only the latest value
+ * of each key matters.  While an update for a key is still waiting to be consumed a new
+ * update for the key overwrites it in place instead of claiming a slot, so a slow
+ * consumer sees only the latest value of each key and the {@link RingBuffer} holds at
+ * most one pending update per key.
+ *
+ * The publisher keeps an index of the pending slot of each key, so it must be the only
+ * publisher to its {@link RingBuffer}, and the updates must be consumed by exactly one
+ * {@link ConflatingEventHandler}.  Other {@link EventProcessor}s may safely read the
+ * updates only by depending on that handler's processor.
+ *
+ * @param <T> value of an update.
+ * @param <K> key of an update.
+ * @param <H> hash of the key.
+ */
+template <typename T, typename K, typename H = std::hash<K>>
+class ConflatingPublisher {
+  RingBuffer<ConflatedEvent<T, K>>& ringBuffer_;
+  std::unordered_map<K, long, H> pendingSequences_;
+  long conflatedCount_;
+
+ public:
+  /**
+   * @param ringBuffer to publish to.
+   */
+  ConflatingPublisher(RingBuffer<ConflatedEvent<T, K>>& ringBuffer)
+      : ringBuffer_(ringBuffer)
+      , conflatedCount_(0L)
+  {}
+
+  /**
+   * Publish an update, replacing the pending update for the key if there is one.
+   *
+   * @param key of the update.
+   * @param value of the update.
+   * @return true if a pending update was replaced, false if a slot was claimed.
+   */
+  bool publish(const K& key, const T& value) {
+    auto pending = pendingSequences_.find(key);
+    if (pendingSequences_.end() != pending && overwrite(pending->second, value)) {
+      ++conflatedCount_;
+      return true;
+    }
+
+    const long sequence = ringBuffer_.next();
+    ConflatedEvent<T, K>& event = ringBuffer_.get(sequence);
+    event.key = key;
+    event.value = value;
+    event.state.store(ConflatedEvent<T, K>::Pending, std::memory_order_relaxed);
+    ringBuffer_.publish(sequence);
+
+    if (pendingSequences_.end() != pending) {
+      pending->second = sequence;
+    }
+    else {
+      pendingSequences_.emplace(key, sequence);
+    }
+    return false;
+  }
+
+  /**
+   * Get the number of updates which replaced a pending update.
+   */
+  long getConflatedCount() const {
+    return conflatedCount_;
+  }
+
+  ConflatingPublisher(const ConflatingPublisher&) = delete;
+  ConflatingPublisher& operator=(const ConflatingPublisher&) = delete;
+
+ private:
+  /* Returns false if the slot has been taken by the consumer or reused for a later sequence. */
+  bool overwrite(const long sequence, const T& value) {
+    if (ringBuffer_.getCursor() - sequence >= ringBuffer_.getBufferSize()) {
+      return false;
+    }
+
+    ConflatedEvent<T, K>& event = ringBuffer_.get(sequence);
+    int expected = ConflatedEvent<T, K>::Pending;
+    if (!event.state.compare_exchange_strong(expected, ConflatedEvent<T, K>::Writing, std::memory_order_acquire)) {
+      return false;
+    }
+
+    event.value = value;
+    event.state.store(ConflatedEvent<T, K>::Pending, std::memory_order_release);
+    return true;
+  }
+};
+
+}
+
+#endif /* __VARONT_CONFLATINGPUBLISHER_HPP__ */
@@ -0,0 +1,330 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_COROUTINESCHEDULER_HPP__
+#define __VARONT_COROUTINESCHEDULER_HPP__
+
+#if !defined(__cpp_impl_coroutine)
+#error "CoroutineScheduler.hpp requires C++20 coroutines, compile with $(CXX20STD)"
+#endif
+
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <stdexcept>
+#include <condition_variable>
+
+namespace varont {
+
+class CoroutineScheduler;
+
+/**
+ * Something waiting in a {@link CoroutineScheduler} to be run on one of its threads.
+ */
+class Resumable {
+ public:
+  /**
+   * Called on a scheduler thread.  Either resumes a coroutine or schedules itself again.
+   */
+  virtual void resume() = 0;
+
+ protected:
+  ~Resumable() {}
+};
+
+/**
+ * A coroutine run by a {@link CoroutineScheduler}.  The coroutine does not start until it
+ * is passed to CoroutineScheduler::spawn and its result, if any, is discarded.
+ *
+ * <pre>
+ *   Task consume(CoroutineWaitStrategy& waitStrategy, SequenceBarrier& barrier, Sequence& sequence) {
+ *     long nextSequence = sequence.get() + 1L;
+ *     for (;;) {
+ *       const long availableSequence = co_await waitStrategy.wait(barrier, nextSequence);
+ *       if (SequenceBarrier::ALERTED == availableSequence) {
+ *         co_return;
+ *       }
+ *       ...
+ *     }
+ *   }
+ * </pre>
+ */
+class Task {
+ public:
+  class promise_type
+      : public Resumable
+  {
+    CoroutineScheduler* scheduler_;
+
+   public:
+    promise_type()
+        : scheduler_(nullptr)
+    {}
+
+    ~promise_type();
+
+    CoroutineScheduler& getScheduler() {
+      return *scheduler_;
+    }
+
+    void setScheduler(CoroutineScheduler& scheduler) {
+      scheduler_ = &scheduler;
+    }
+
+    void resume() {
+      std::coroutine_handle<promise_type>::from_promise(*this).resume();
+    }
+
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return { };
+    }
+
+    std::suspend_never final_suspend() noexcept {
+      return { };
+    }
+
+    void return_void() { }
+
+    void unhandled_exception() {
+      std::terminate();
+    }
+  };
+
+  typedef std::coroutine_handle<promise_type> Handle;
+
+ private:
+  Handle handle_;
+
+ public:
+  explicit Task(Handle handle)
+      : handle_(handle)
+  {}
+
+  Task(Task&& task)
+      : handle_(task.handle_)
+  {
+    task.handle_ = nullptr;
+  }
+
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  /**
+   * Give up ownership of the coroutine, which then destroys itself when it completes.
+   */
+  Handle release() {
+    Handle handle = handle_;
+    handle_ = nullptr;
+    return handle;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+};
+
+/**
+ * Runs {@link Task}s on a fixed set of threads, so that many low rate consumers and
+ * publishers can share a few threads instead of each owning one.
+ *
+ * A task runs on a scheduler thread until it suspends in an awaitable of a
+ * {@link CoroutineWaitStrategy}, after which it is resumed on whichever thread is free.
+ * Tasks are scheduled in FIFO order and must not block their thread.  Work scheduled
+ * after a delay joins the back of the queue once the delay has elapsed.
+ */
+class CoroutineScheduler {
+  typedef std::chrono::steady_clock Clock;
+
+  std::mutex lock_;
+  std::condition_variable readyCondition_;
+  std::condition_variable idleCondition_;
+  std::deque<Resumable*> ready_;
+  std::multimap<Clock::time_point, Resumable*> delayed_;
+  std::vector<std::thread> threads_;
+  long numTasks_;
+  bool running_;
+
+ public:
+  /**
+   * Await the next turn of the calling {@link Task}, letting the other ready tasks run.
+   */
+  class YieldAwaiter {
+   public:
+    bool await_ready() {
+      return false;
+    }
+
+    void await_suspend(Task::Handle handle) {
+      handle.promise().getScheduler().schedule(handle.promise());
+    }
+
+    void await_resume() { }
+  };
+
+  /**
+   * @param numThreads to run the tasks on.
+   */
+  explicit CoroutineScheduler(const int numThreads)
+      : numTasks_(0)
+      , running_(true)
+  {
+    if (numThreads < 1) {
+      throw std::out_of_range("numThreads must be greater than 0");
+    }
+
+    for (int i = 0; i < numThreads; ++i) {
+      threads_.emplace_back([this] { run(); });
+    }
+  }
+
+  /**
+   * Stops the threads.  Tasks which have not completed are abandoned, so they should be
+   * brought to an end, for instance by alerting their barriers, and joined first.
+   */
+  ~CoroutineScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      running_ = false;
+    }
+    readyCondition_.notify_all();
+
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  /**
+   * Start running a {@link Task}.
+   *
+   * @param task to run, which is owned by the scheduler from now on.
+   */
+  void spawn(Task&& task) {
+    Task::Handle handle = task.release();
+    handle.promise().setScheduler(*this);
+
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      ++numTasks_;
+    }
+    schedule(handle.promise());
+  }
+
+  /**
+   * Add to the back of the queue of work ready to run.
+   */
+  void schedule(Resumable& resumable) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      ready_.push_back(&resumable);
+    }
+    readyCondition_.notify_one();
+  }
+
+  /**
+   * Add to the back of the queue of work ready to run once a delay has elapsed.
+   *
+   * @param resumable to run.
+   * @param delayNanos after which it is ready.
+   */
+  void scheduleAfter(Resumable& resumable, const long delayNanos) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      delayed_.emplace(Clock::now() + std::chrono::nanoseconds(delayNanos), &resumable);
+    }
+    /* A thread waiting for work must recompute its deadline. */
+    readyCondition_.notify_one();
+  }
+
+  /**
+   * Wait until every spawned {@link Task} has completed.
+   */
+  void join() {
+    std::unique_lock<std::mutex> lock(lock_);
+    idleCondition_.wait(lock, [this] { return 0L == numTasks_; });
+  }
+
+  static YieldAwaiter yield() {
+    return YieldAwaiter();
+  }
+
+  CoroutineScheduler(const CoroutineScheduler&) = delete;
+  CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+ private:
+  friend class Task::promise_type;
+
+  void complete() {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (0L == --numTasks_) {
+      idleCondition_.notify_all();
+    }
+  }
+
+  void run() {
+    for (;;) {
+      Resumable* resumable;
+      {
+        std::unique_lock<std::mutex> lock(lock_);
+        for (;;) {
+          if (!running_) {
+            return;
+          }
+
+          const Clock::time_point now = Clock::now();
+          while (!delayed_.empty() && delayed_.begin()->first <= now) {
+            ready_.push_back(delayed_.begin()->second);
+            delayed_.erase(delayed_.begin());
+          }
+
+          if (!ready_.empty()) {
+            break;
+          }
+
+          if (delayed_.empty()) {
+            readyCondition_.wait(lock);
+          }
+          else {
+            readyCondition_.wait_until(lock, delayed_.begin()->first);
+          }
+        }
+        resumable = ready_.front();
+        ready_.pop_front();
+      }
+
+      resumable->resume();
+    }
+  }
+};
+
+inline Task::promise_type::~promise_type() {
+  if (nullptr != scheduler_) {
+    scheduler_->complete();
+  }
+}
+
+}
+
+#endif /* __VARONT_COROUTINESCHEDULER_HPP__ */
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_COROUTINEWAITSTRATEGY_HPP__
+#define __VARONT_COROUTINEWAITSTRATEGY_HPP__
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "BlockingWaitStrategy.hpp"
+#include "CoroutineScheduler.hpp"
+#include "SequenceBarrier.hpp"
+#include "Sequencer.hpp"
+
+namespace varont {
+
+/**
+ * Blocking strategy which, besides blocking threads as the {@link BlockingWaitStrategy}
+ * does, lets {@link Task}s on a {@link CoroutineScheduler} wait for events and for
+ * capacity without holding a thread:
+ *
+ * <pre>
+ *   const long availableSequence = co_await waitStrategy.wait(barrier, nextSequence);
+ *   const long sequence = co_await waitStrategy.claim(ringBuffer);
+ * </pre>
+ *
+ * A task waiting on the cursor is parked until a publisher signals the strategy, and is
+ * then queued on its scheduler.  A task waiting for dependent {@link EventProcessor}s or
+ * for capacity polls the sequences it depends on, since consumers do not signal the
+ * strategy: it is requeued behind the other ready tasks REQUEUE_TRIES times, and then
+ * after a delay doubling from MIN_BACKOFF_NANOS up to MAX_BACKOFF_NANOS, so that an idle
+ * waiter does not keep its scheduler thread busy.
+ */
+class CoroutineWaitStrategy
+  : public BlockingWaitStrategy
+{
+ public:
+  static const int REQUEUE_TRIES = 100;
+  static const long MIN_BACKOFF_NANOS = 1000L;
+  static const long MAX_BACKOFF_NANOS = 1000000L;
+
+  /**
+   * Awaitable result of wait, giving the sequence up to which is available, which is at
+   * least the sequence waited for, or SequenceBarrier::ALERTED.
+   */
+  class WaitAwaiter
+      : public Resumable
+  {
+    CoroutineWaitStrategy& waitStrategy_;
+    SequenceBarrier& barrier_;
+    const long sequence_;
+    long availableSequence_;
+    Task::Handle handle_;
+    int counter_;
+
+   public:
+    WaitAwaiter(CoroutineWaitStrategy& waitStrategy, SequenceBarrier& barrier, const long sequence)
+        : waitStrategy_(waitStrategy)
+        , barrier_(barrier)
+        , sequence_(sequence)
+        , availableSequence_(SequenceBarrier::ALERTED)
+        , counter_(0)
+    {}
+
+    bool await_ready() {
+      return isAvailable();
+    }
+
+    void await_suspend(Task::Handle handle) {
+      handle_ = handle;
+      suspend();
+    }
+
+    long await_resume() {
+      return barrier_.isAlerted() ? (long)SequenceBarrier::ALERTED : availableSequence_;
+    }
+
+    void resume() {
+      if (isAvailable()) {
+        handle_.resume();
+      }
+      else {
+        suspend();
+      }
+    }
+
+    /**
+     * Queue the awaiter on its scheduler to check the barrier again.
+     */
+    void wake() {
+      handle_.promise().getScheduler().schedule(*this);
+    }
+
+   private:
+    bool isAvailable() {
+      return barrier_.isAlerted() || (availableSequence_ = barrier_.getAvailableSequence()) >= sequence_;
+    }
+
+    /* Nothing may touch this after the awaiter has been handed to another thread. */
+    void suspend() {
+      if (barrier_.getCursor() >= sequence_) {
+        /* Published, but dependent processors have not caught up. */
+        backOff(handle_, *this, counter_);
+      }
+      else if (!waitStrategy_.park(*this, barrier_, sequence_)) {
+        wake();
+      }
+    }
+  };
+
+  /**
+   * Awaitable result of claim, giving the last of the claimed sequences.
+   */
+  class ClaimAwaiter
+      : public Resumable
+  {
+    Sequencer& sequencer_;
+    const int n_;
+    Task::Handle handle_;
+    int counter_;
+
+   public:
+    ClaimAwaiter(Sequencer& sequencer, const int n)
+        : sequencer_(sequencer)
+        , n_(n)
+        , counter_(0)
+    {}
+
+    bool await_ready() {
+      return sequencer_.hasAvailableCapacity(n_);
+    }
+
+    void await_suspend(Task::Handle handle) {
+      handle_ = handle;
+      backOff(handle_, *this, counter_);
+    }
+
+    long await_resume() {
+      return 1 == n_ ? sequencer_.next() : sequencer_.next(n_);
+    }
+
+    void resume() {
+      if (sequencer_.hasAvailableCapacity(n_)) {
+        handle_.resume();
+      }
+      else {
+        backOff(handle_, *this, counter_);
+      }
+    }
+  };
+
+ private:
+  std::mutex parkLock_;
+  std::vector<WaitAwaiter*> parked_;
+  std::atomic_int numParked_;
+
+ public:
+  CoroutineWaitStrategy()
+      : numParked_(0)
+  {}
+
+  /**
+   * Wait for a sequence to be available on a barrier created with this strategy.
+   *
+   * @param barrier to wait on.
+   * @param sequence to wait for.
+   * @return an awaitable giving the sequence up to which is available or SequenceBarrier::ALERTED.
+   */
+  WaitAwaiter wait(SequenceBarrier& barrier, const long sequence) {
+    return WaitAwaiter(*this, barrier, sequence);
+  }
+
+  /**
+   * Claim the next n sequences once the gating sequences leave room for them.  The
+   * capacity is only checked before claiming, so with several publishers the claim may
+   * still briefly block the thread.
+   *
+   * @param sequencer to claim from.
+   * @param n number of sequences to claim, no greater than the buffer size.
+   * @return an awaitable giving the last of the claimed sequences.
+   */
+  ClaimAwaiter claim(Sequencer& sequencer, const int n = 1) {
+    return ClaimAwaiter(sequencer, n);
+  }
+
+  void signalAllWhenBlocking() {
+    BlockingWaitStrategy::signalAllWhenBlocking();
+
+    if (0 != numParked_) {
+      std::vector<WaitAwaiter*> parked;
+      {
+        std::lock_guard<std::mutex> lock(parkLock_);
+        parked.swap(parked_);
+        numParked_ = 0;
+      }
+
+      for (WaitAwaiter* awaiter : parked) {
+        awaiter->wake();
+      }
+    }
+  }
+
+  CoroutineWaitStrategy(const CoroutineWaitStrategy&) = delete;
+  CoroutineWaitStrategy& operator=(const CoroutineWaitStrategy&) = delete;
+
+ private:
+  /*
+   * Requeues a polling awaiter, after a delay once it has been requeued REQUEUE_TRIES
+   * times.  The awaiter may run on another thread as soon as it is queued, so its
+   * counter is updated first.
+   */
+  static void backOff(Task::Handle handle, Resumable& resumable, int& counter) {
+    CoroutineScheduler& scheduler = handle.promise().getScheduler();
+    if (counter < REQUEUE_TRIES) {
+      ++counter;
+      scheduler.schedule(resumable);
+      return;
+    }
+
+    long delayNanos = MIN_BACKOFF_NANOS << (counter - REQUEUE_TRIES);
+    if (delayNanos < MAX_BACKOFF_NANOS) {
+      ++counter;
+    }
+    else {
+      delayNanos = MAX_BACKOFF_NANOS;
+    }
+    scheduler.scheduleAfter(resumable, delayNanos);
+  }
+
+  /*
+   * Returns false if the cursor reached the sequence or the barrier was alerted before
+   * the awaiter could be parked.  Announcing before re-checking closes the race with a
+   * concurrent publish.
+   */
+  bool park(WaitAwaiter& awaiter, SequenceBarrier& barrier, const long sequence) {
+    std::lock_guard<std::mutex> lock(parkLock_);
+    parked_.push_back(&awaiter);
+    numParked_ = (int)parked_.size();
+
+    if (barrier.getCursor() >= sequence || barrier.isAlerted()) {
+      parked_.pop_back();
+      numParked_ = (int)parked_.size();
+      return false;
+    }
+
+    return true;
+  }
+};
+
+}
+
+#endif /* __VARONT_COROUTINEWAITSTRATEGY_HPP__ */
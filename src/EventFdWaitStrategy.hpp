@@ -0,0 +1,252 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_EVENTFDWAITSTRATEGY_HPP__
+#define __VARONT_EVENTFDWAITSTRATEGY_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <mutex>
+#include <system_error>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "SequenceBarrier.hpp"
+#include "WaitStrategy.hpp"
+#include "Util.hpp"
+#include "TimeUnit.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
+
+namespace varont {
+
+/**
+ * Blocking strategy that signals waiting {@link EventProcessor}s through an eventfd.
+ *
+ * The eventfd is only written when a consumer has announced that it is about to sleep, so
+ * publishers pay for a system call only when somebody is actually waiting.  A thread that
+ * runs its own epoll loop can add getFd() to its epoll set and wake on either its own I/O
+ * or newly published events:
+ *
+ * <pre>
+ *   waitStrategy.beginSleep();
+ *   if (poller.poll(handler) == PollState::Idle) {
+ *     epoll_wait(...);
+ *   }
+ *   waitStrategy.endSleep();
+ * </pre>
+ *
+ * Announcing before re-checking the cursor closes the race with a concurrent publish.
+ * The eventfd is a semaphore holding at most one wake-up per announced sleeper: a
+ * publisher tops it up to the number of sleepers, each woken sleeper takes one, and a
+ * sleeper withdrawing its announcement takes any beyond the sleepers that remain.  So
+ * however many events are published while consumers sleep, the eventfd holds no more
+ * wake-ups than there are sleepers, and is empty once nobody is sleeping.
+ */
+class EventFdWaitStrategy
+  : public WaitStrategy
+{
+  /* Bounds a sleep should a publisher miss the announcement of a concurrent sleeper. */
+  static const int POLL_TIMEOUT_MILLIS = 10;
+
+  /* Announces a sleeper for the lifetime of the guard. */
+  class SleepGuard {
+    EventFdWaitStrategy& waitStrategy_;
+  public:
+    SleepGuard(EventFdWaitStrategy& waitStrategy)
+      : waitStrategy_(waitStrategy)
+    {
+      waitStrategy_.beginSleep();
+    }
+
+    ~SleepGuard() {
+      waitStrategy_.endSleep();
+    }
+  };
+
+  int fd_;
+  std::atomic_int numSleepers_;
+  /* Wake-ups held by the eventfd, only changed under lock_ with the eventfd itself. */
+  std::atomic_int numWakeUps_;
+  std::mutex lock_;
+  WaitMetrics* metrics_;
+
+public:
+  EventFdWaitStrategy()
+    : fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC | EFD_SEMAPHORE))
+    , numSleepers_(0)
+    , numWakeUps_(0)
+    , metrics_(nullptr)
+  {
+    if (-1 == fd_) {
+      throw std::system_error(errno, std::system_category(), "eventfd");
+    }
+  }
+
+  ~EventFdWaitStrategy() {
+    ::close(fd_);
+  }
+
+  /**
+   * Get the eventfd that becomes readable when events are published to a sleeping consumer.
+   *
+   * @return the eventfd.
+   */
+  int getFd() const {
+    return fd_;
+  }
+
+  /**
+   * Announce that the calling thread is about to sleep on getFd().  The cursor must be
+   * re-checked after this call and before sleeping.
+   */
+  void beginSleep() {
+    ++numSleepers_;
+  }
+
+  /**
+   * Withdraw an announcement made with beginSleep(), taking the wake-ups no longer needed
+   * by the sleepers that remain.
+   */
+  void endSleep() {
+    std::lock_guard<std::mutex> lock(lock_);
+    const int sleepers = --numSleepers_;
+    while (numWakeUps_.load() > sleepers) {
+      take();
+    }
+  }
+
+  long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier) {
+    long availableSequence;
+
+    if ((availableSequence = cursor.get()) < sequence) {
+      SleepGuard sleepGuard(*this);
+
+      while ((availableSequence = cursor.get()) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        await(POLL_TIMEOUT_MILLIS);
+      }
+    }
+
+    if (0 != dependents.size()) {
+      while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+      }
+    }
+
+    return availableSequence;
+  }
+
+  long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier,
+               long timeout, TimeUnit sourceUnit)
+  {
+    long availableSequence;
+
+    if ((availableSequence = cursor.get()) < sequence) {
+      SleepGuard sleepGuard(*this);
+      const long deadline = util::nanoTime() + util::toNanos(timeout, sourceUnit);
+
+      while ((availableSequence = cursor.get()) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+
+        const long remainingNanos = deadline - util::nanoTime();
+        if (remainingNanos <= 0L) {
+          break;
+        }
+        /* Round up so that a sub-millisecond remainder still sleeps rather than spins. */
+        await((int)std::min((remainingNanos + 999999L) / 1000000L, (long)POLL_TIMEOUT_MILLIS));
+      }
+    }
+
+    if (0 != dependents.size()) {
+      while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+      }
+    }
+
+    return availableSequence;
+  }
+
+  void signalAllWhenBlocking() {
+    if (numSleepers_.load() > numWakeUps_.load()) {
+      std::lock_guard<std::mutex> lock(lock_);
+      const int missing = numSleepers_.load() - numWakeUps_.load();
+      if (missing > 0) {
+        const uint64_t increment = (uint64_t)missing;
+        ssize_t rc = ::write(fd_, &increment, sizeof(increment));
+        (void)rc;
+        numWakeUps_ += missing;
+
+        if (nullptr != metrics_) {
+          metrics_->wakeups.increment();
+        }
+      }
+    }
+  }
+
+  void setMetrics(WaitMetrics* metrics) {
+    metrics_ = metrics;
+  }
+
+  EventFdWaitStrategy(const EventFdWaitStrategy&) = delete;
+  EventFdWaitStrategy& operator=(const EventFdWaitStrategy&) = delete;
+
+private:
+  /* Returns false if the timeout elapsed without a signal. */
+  bool await(int timeoutMillis) {
+    if (nullptr != metrics_) {
+      metrics_->parks.increment();
+    }
+
+    struct pollfd pfd = { fd_, POLLIN, 0 };
+    VARONT_TRACE(park, 0, 0);
+    const int rc = ::poll(&pfd, 1, timeoutMillis);
+    VARONT_TRACE(wake, 0, 0);
+    if (rc <= 0) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(lock_);
+    if (0 != numWakeUps_.load()) {
+      take();
+    }
+    return true;
+  }
+
+  /* Takes one wake-up from the eventfd; lock_ must be held. */
+  void take() {
+    uint64_t value;
+    ssize_t rc = ::read(fd_, &value, sizeof(value));
+    (void)rc;
+    --numWakeUps_;
+  }
+};
+
+}
+
+#endif /* __VARONT_EVENTFDWAITSTRATEGY_HPP__ */
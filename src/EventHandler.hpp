@@ -16,6 +16,8 @@
 #ifndef __VARONT_EVENTHANDLER_HPP__
 #define __VARONT_EVENTHANDLER_HPP__
 
+#include <system_error>
+
 namespace varont {
 
 /**
@@ -38,6 +40,20 @@ class EventHandler {
    */
   virtual void onEvent(T& event, long sequence, bool endOfBatch) = 0;
 
+  /**
+   * Non-throwing variant of onEvent called by the {@link BatchEventProcessor}.  Handlers
+   * that must not throw report failure by assigning to error, which is then passed to
+   * {@link ExceptionHandler#handleEventError}.  The default delegates to onEvent.
+   *
+   * @param event published to the {@link RingBuffer}
+   * @param sequence of the event being processed
+   * @param endOfBatch flag to indicate if this is the last event in a batch from the {@link RingBuffer}
+   * @param error set by the EventHandler if the event could not be processed.
+   */
+  virtual void onEvent(T& event, long sequence, bool endOfBatch, std::error_code& error) {
+    onEvent(event, sequence, endOfBatch);
+  }
+
  protected:
   ~EventHandler() {}
 };
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_EVENTPOLLER_HPP__
+#define __VARONT_EVENTPOLLER_HPP__
+
+#include <vector>
+#include <algorithm>
+
+#include "RingBuffer.hpp"
+#include "Sequencer.hpp"
+#include "Sequence.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+/**
+ * Pull based alternative to the {@link BatchEventProcessor} for consuming events from a
+ * {@link RingBuffer} on a thread owned by the application, such as an existing event loop.
+ *
+ * The poller's {@link Sequence} must be added to the gating sequences of the
+ * {@link RingBuffer} in the same way as that of an {@link EventProcessor}.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class EventPoller {
+public:
+  /**
+   * Outcome of a call to poll.
+   */
+  enum class PollState {
+    /** Events were available and passed to the handler. */
+    Processing,
+    /** Events have been published but are held back by the dependent sequences. */
+    Gating,
+    /** No events have been published beyond the poller's sequence. */
+    Idle
+  };
+
+  /**
+   * Callback for events handed out by poll.
+   */
+  class Handler {
+  public:
+    /**
+     * Called for each available event.
+     *
+     * @param event published to the {@link RingBuffer}
+     * @param sequence of the event being processed
+     * @param endOfBatch flag to indicate if this is the last event available to this poll
+     * @return true to continue with the next available event, false to stop this poll.
+     */
+    virtual bool onEvent(T& event, long sequence, bool endOfBatch) = 0;
+
+  protected:
+    ~Handler() {}
+  };
+
+private:
+  RingBuffer<T>& ringBuffer_;
+  std::vector<Sequence*> dependentSequences_;
+  Sequence sequence_;
+
+public:
+  /**
+   * Construct a poller for a {@link RingBuffer}.
+   *
+   * @param ringBuffer to poll.
+   * @param dependentSequences which must advance before events are handed out, may be empty.
+   */
+  EventPoller(RingBuffer<T>& ringBuffer, std::vector<Sequence*>& dependentSequences)
+    : ringBuffer_(ringBuffer)
+    , dependentSequences_(dependentSequences)
+    , sequence_(Sequencer::INITIAL_CURSOR_VALUE)
+  {}
+
+  EventPoller(RingBuffer<T>& ringBuffer, std::vector<Sequence*>&& dependentSequences)
+    : ringBuffer_(ringBuffer)
+    , dependentSequences_(dependentSequences)
+    , sequence_(Sequencer::INITIAL_CURSOR_VALUE)
+  {}
+
+  /**
+   * Get the {@link Sequence} tracking the events consumed by this poller.
+   *
+   * @return the poller's sequence.
+   */
+  Sequence& getSequence() {
+    return sequence_;
+  }
+
+  /**
+   * Hand every currently available event to the handler and return without waiting.
+   *
+   * If the handler throws, the sequence is advanced past the events already handled
+   * before the exception is propagated.
+   *
+   * @param handler to receive the available events.
+   * @return the state of the {@link RingBuffer} as seen by this poller.
+   */
+  PollState poll(Handler& handler) {
+    const long currentSequence = sequence_.get();
+    long nextSequence = currentSequence + 1L;
+    const long cursor = ringBuffer_.getCursor();
+    const long availableSequence = dependentSequences_.empty()
+      ? cursor
+      : std::min(cursor, util::getMinimumSequence(dependentSequences_));
+
+    if (nextSequence <= availableSequence) {
+      long processedSequence = currentSequence;
+
+      try {
+        bool processNextEvent;
+        do {
+          T& event = ringBuffer_.get(nextSequence);
+          processNextEvent = handler.onEvent(event, nextSequence, nextSequence == availableSequence);
+          processedSequence = nextSequence;
+          nextSequence++;
+        } while (nextSequence <= availableSequence && processNextEvent);
+      }
+      catch (...) {
+        sequence_.set(processedSequence);
+        throw;
+      }
+
+      sequence_.set(processedSequence);
+      return PollState::Processing;
+    }
+    else if (cursor >= nextSequence) {
+      return PollState::Gating;
+    }
+
+    return PollState::Idle;
+  }
+
+  EventPoller(const EventPoller&) = delete;
+  EventPoller& operator=(const EventPoller&) = delete;
+};
+
+}
+
+#endif /* __VARONT_EVENTPOLLER_HPP__ */
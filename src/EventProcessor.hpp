@@ -16,6 +16,8 @@
 #ifndef __VARONT_EVENTPROCESSOR_HPP__
 #define __VARONT_EVENTPROCESSOR_HPP__
 
+#include "Sequence.hpp"
+
 namespace varont {
 /**
  * EventProcessors waitFor events to become available for consumption from the {@link RingBuffer}
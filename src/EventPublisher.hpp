@@ -0,0 +1,169 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_EVENTPUBLISHER_HPP__
+#define __VARONT_EVENTPUBLISHER_HPP__
+
+#include <new>
+#include <thread>
+#include <stdexcept>
+
+#include "BackPressurePolicy.hpp"
+#include "BatchDescriptor.hpp"
+#include "EventTranslator.hpp"
+#include "Metrics.hpp"
+#include "OverflowHandler.hpp"
+#include "RingBuffer.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+/**
+ * Publishes events translated by an {@link EventTranslator} to a {@link RingBuffer},
+ * applying a {@link BackPressurePolicy} when the {@link RingBuffer} is full.
+ *
+ * Every policy except Block claims with the non-throwing tryNext, so a full
+ * {@link RingBuffer} costs no more than a failed capacity check.  The events each policy
+ * kept out of the {@link RingBuffer} are counted in the publisher's metrics.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class EventPublisher {
+  RingBuffer<T>& ringBuffer_;
+  const BackPressurePolicy policy_;
+  const long timeoutNanos_;
+  OverflowHandler<T>* overflowHandler_;
+  PublisherMetrics metrics_;
+
+ public:
+  /**
+   * @param ringBuffer to publish to.
+   * @param policy applied when the {@link RingBuffer} is full; Redirect requires an overflowHandler.
+   * @param timeoutNanos longest a BlockWithTimeout publisher waits for a slot.
+   * @param overflowHandler receiving the events a Redirect publisher could not fit.
+   */
+  EventPublisher(RingBuffer<T>& ringBuffer, const BackPressurePolicy policy = BackPressurePolicy::Block,
+                 const long timeoutNanos = 0L, OverflowHandler<T>* overflowHandler = nullptr)
+      : ringBuffer_(ringBuffer)
+      , policy_(policy)
+      , timeoutNanos_(timeoutNanos)
+      , overflowHandler_(overflowHandler)
+  {
+    if (BackPressurePolicy::Redirect == policy && nullptr == overflowHandler) {
+      throw std::out_of_range("the Redirect policy requires an OverflowHandler");
+    }
+  }
+
+  /**
+   * Claim a slot, translate the event into it and publish it, unless the policy keeps it out.
+   *
+   * @param translator to fill in the event.
+   * @return true if the event was published to the {@link RingBuffer}.
+   */
+  bool publishEvent(EventTranslator<T>& translator) {
+    long sequence;
+
+    if (BackPressurePolicy::Block == policy_) {
+      sequence = ringBuffer_.next();
+    }
+    else if (Sequencer::INSUFFICIENT_CAPACITY == (sequence = tryNext(1))) {
+      reject(translator, 1);
+      return false;
+    }
+
+    translator.translateTo(ringBuffer_.get(sequence), sequence);
+    ringBuffer_.publish(sequence);
+    return true;
+  }
+
+  /**
+   * Publish a batch of events in one claim, all of which are kept out if the policy
+   * rejects the batch.
+   *
+   * @param translator to fill in each event.
+   * @param n number of events, no greater than the buffer size.
+   * @return true if the events were published to the {@link RingBuffer}.
+   */
+  bool publishEvents(EventTranslator<T>& translator, const int n) {
+    long sequence;
+
+    if (BackPressurePolicy::Block == policy_) {
+      sequence = ringBuffer_.next(n);
+    }
+    else if (Sequencer::INSUFFICIENT_CAPACITY == (sequence = tryNext(n))) {
+      reject(translator, n);
+      return false;
+    }
+
+    for (long next = sequence - n + 1L; next <= sequence; ++next) {
+      translator.translateTo(ringBuffer_.get(next), next);
+    }
+    ringBuffer_.publish(sequence, n);
+    return true;
+  }
+
+  /**
+   * Get the counts of the events kept out of the {@link RingBuffer}.
+   */
+  PublisherMetrics& getMetrics() {
+    return metrics_;
+  }
+
+  EventPublisher(const EventPublisher&) = delete;
+  EventPublisher& operator=(const EventPublisher&) = delete;
+
+ private:
+  /* Returns the last of n claimed sequences, or INSUFFICIENT_CAPACITY. */
+  long tryNext(const int n) {
+    BatchDescriptor batchDescriptor(n);
+    if (ringBuffer_.tryNext(batchDescriptor, std::nothrow)) {
+      return batchDescriptor.getEnd();
+    }
+
+    if (BackPressurePolicy::BlockWithTimeout == policy_) {
+      const long deadline = util::nanoTime() + timeoutNanos_;
+      do {
+        std::this_thread::yield();
+        if (ringBuffer_.tryNext(batchDescriptor, std::nothrow)) {
+          return batchDescriptor.getEnd();
+        }
+      } while (util::nanoTime() < deadline);
+    }
+
+    return Sequencer::INSUFFICIENT_CAPACITY;
+  }
+
+  void reject(EventTranslator<T>& translator, const int n) {
+    switch (policy_) {
+      case BackPressurePolicy::DropNewest:
+        metrics_.dropped.increment(n);
+        break;
+      case BackPressurePolicy::BlockWithTimeout:
+        metrics_.timedOut.increment(n);
+        break;
+      case BackPressurePolicy::Redirect:
+        metrics_.redirected.increment(n);
+        overflowHandler_->onOverflow(translator, n);
+        break;
+      case BackPressurePolicy::Block:
+        break;
+    }
+  }
+};
+
+}
+
+#endif /* __VARONT_EVENTPUBLISHER_HPP__ */
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_EVENTTRANSLATOR_HPP__
+#define __VARONT_EVENTTRANSLATOR_HPP__
+
+namespace varont {
+
+/**
+ * Fills in a claimed event of a {@link RingBuffer}, so that a publisher such as the
+ * {@link EventPublisher} can claim and publish on the caller's behalf.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class EventTranslator {
+ public:
+  /**
+   * Translate the data of the caller into an event.
+   *
+   * @param event to fill in, holding the data of an earlier use of its slot.
+   * @param sequence assigned to the event.
+   */
+  virtual void translateTo(T& event, long sequence) = 0;
+
+ protected:
+  ~EventTranslator() {}
+};
+
+}
+
+#endif /* __VARONT_EVENTTRANSLATOR_HPP__ */
@@ -17,6 +17,7 @@
 #define __VARONT_EXCEPTIONHANDLER_HPP__
 
 #include <exception>
+#include <system_error>
 
 namespace varont {
 
@@ -37,6 +38,22 @@ public:
    */
   virtual void handleEventException(std::exception& ex, long sequence) = 0;
 
+  /**
+   * Strategy for handling errors reported without throwing through
+   * {@link EventHandler#onEvent(T&, long, bool, std::error_code&)}.
+   *
+   * The default stops the {@link BatchEventProcessor} without reporting the error; the
+   * {@link FatalExceptionHandler} reports it on stderr and stops.  An exception thrown
+   * from here is passed to handleEventException.
+   *
+   * @param error reported by the {@link EventHandler}.
+   * @param sequence of the event which caused the error.
+   * @return true to continue with the next event, false to stop the {@link BatchEventProcessor}.
+   */
+  virtual bool handleEventError(const std::error_code& error, long sequence) {
+    return false;
+  }
+
   /**
    * Callback to notify of an exception during {@link LifecycleAware#onStart()}
    *
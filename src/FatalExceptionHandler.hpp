@@ -16,7 +16,10 @@
 #ifndef __VARONT_FATALEXCEPTIONHANDLER_HPP__
 #define __VARONT_FATALEXCEPTIONHANDLER_HPP__
 
+#include <cstdio>
 #include <exception>
+#include <stdexcept>
+#include <system_error>
 
 #include "ExceptionHandler.hpp"
 
@@ -30,6 +33,15 @@ public:
     throw std::runtime_error("BatchEventProcessor FATAL unhandled exception while processing event.");
   }
 
+  /**
+   * Report the error on stderr and stop the {@link BatchEventProcessor}, without throwing.
+   */
+  bool handleEventError(const std::error_code& error, long sequence) {
+    std::fprintf(stderr, "BatchEventProcessor FATAL unhandled error while processing event %ld: %s\n",
+                 sequence, error.message().c_str());
+    return false;
+  }
+
   void handleOnStartException(std::exception& ex) { }
 
   void handleOnShutdownException(std::exception& ex) { }
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Histogram.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace varont {
+
+Histogram::Snapshot::Snapshot()
+  : counts_(BUCKET_COUNT, 0L)
+  , totalCount_(0L)
+  , min_(0L)
+  , max_(0L)
+  , sum_(0L)
+{}
+
+double Histogram::Snapshot::getMean() const {
+  if (0L == totalCount_) {
+    return 0.0;
+  }
+  return (double)sum_ / (double)totalCount_;
+}
+
+long Histogram::Snapshot::getValueAtPercentile(const double percentile) const {
+  if (0L == totalCount_) {
+    return 0L;
+  }
+
+  const double fraction = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+  const long countAtPercentile = std::max(1L, (long)std::ceil(fraction * totalCount_));
+
+  long cumulativeCount = 0L;
+  for (int index = 0; index < BUCKET_COUNT; ++index) {
+    cumulativeCount += counts_[index];
+    if (cumulativeCount >= countAtPercentile) {
+      return std::min(highestEquivalentValue(index), max_);
+    }
+  }
+
+  return max_;
+}
+
+Histogram::Histogram()
+  : counts_(new std::atomic_long[BUCKET_COUNT])
+  , min_(std::numeric_limits<long>::max())
+  , max_(0L)
+  , sum_(0L)
+{
+  for (int index = 0; index < BUCKET_COUNT; ++index) {
+    counts_[index].store(0L, std::memory_order_relaxed);
+  }
+}
+
+Histogram::~Histogram() {
+  delete [] counts_;
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+  Snapshot snapshot;
+
+  for (int index = 0; index < BUCKET_COUNT; ++index) {
+    const long count = counts_[index].load(std::memory_order_relaxed);
+    snapshot.counts_[index] = count;
+    snapshot.totalCount_ += count;
+  }
+
+  snapshot.min_ = min_.load(std::memory_order_relaxed);
+  snapshot.max_ = max_.load(std::memory_order_relaxed);
+  snapshot.sum_ = sum_.load(std::memory_order_relaxed);
+
+  return snapshot;
+}
+
+void Histogram::reset() {
+  for (int index = 0; index < BUCKET_COUNT; ++index) {
+    counts_[index].store(0L, std::memory_order_relaxed);
+  }
+  min_.store(std::numeric_limits<long>::max(), std::memory_order_relaxed);
+  max_.store(0L, std::memory_order_relaxed);
+  sum_.store(0L, std::memory_order_relaxed);
+}
+
+long Histogram::lowestEquivalentValue(const int index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return index;
+  }
+
+  const int shift = index / SUB_BUCKET_HALF - 1;
+  return (long)(index - shift * SUB_BUCKET_HALF) << shift;
+}
+
+long Histogram::highestEquivalentValue(const int index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return index;
+  }
+
+  const int shift = index / SUB_BUCKET_HALF - 1;
+  return lowestEquivalentValue(index) + (1L << shift) - 1L;
+}
+
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_HISTOGRAM_HPP__
+#define __VARONT_HISTOGRAM_HPP__
+
+#include <atomic>
+#include <vector>
+
+namespace varont {
+
+/**
+ * Lock-free log-linear histogram of non-negative values, such as latencies in nanoseconds.
+ *
+ * Values are counted in buckets whose width doubles with every power of two, each power of
+ * two being split into SUB_BUCKET_HALF linear sub-buckets, so any recorded value is reported
+ * to within 1/SUB_BUCKET_HALF (about 1.6%) of its true value.  Recording is wait-free and may be done from any thread;
+ * snapshots may be taken at any time without stopping the recording threads.
+ */
+class Histogram {
+public:
+  static const int SUB_BUCKET_BITS = 7;
+  static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  static const int SUB_BUCKET_HALF = SUB_BUCKET_COUNT >> 1;
+  static const int BUCKET_COUNT = (63 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF + SUB_BUCKET_COUNT;
+
+  /**
+   * Point in time copy of a {@link Histogram}.
+   */
+  class Snapshot {
+    std::vector<long> counts_;
+    long totalCount_;
+    long min_;
+    long max_;
+    long sum_;
+
+    friend class Histogram;
+  public:
+    Snapshot();
+
+    long getTotalCount() const { return totalCount_; }
+
+    /**
+     * @return the smallest value recorded, or 0 if none were.
+     */
+    long getMin() const { return 0 == totalCount_ ? 0L : min_; }
+
+    /**
+     * @return the largest value recorded, or 0 if none were.
+     */
+    long getMax() const { return max_; }
+
+    long getSum() const { return sum_; }
+
+    double getMean() const;
+
+    /**
+     * Get the value at or below which the given percentage of recorded values fall.
+     *
+     * @param percentile in the range [0, 100].
+     * @return the highest value equivalent to the bucket holding that percentile.
+     */
+    long getValueAtPercentile(const double percentile) const;
+  };
+
+private:
+  std::atomic_long* counts_;
+  std::atomic_long min_;
+  std::atomic_long max_;
+  std::atomic_long sum_;
+
+public:
+  Histogram();
+
+  ~Histogram();
+
+  /**
+   * Record a value.  Negative values are recorded as 0.
+   *
+   * @param value to record.
+   */
+  void record(long value) {
+    if (value < 0L) {
+      value = 0L;
+    }
+
+    counts_[indexOf(value)].fetch_add(1L, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    long max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) { }
+
+    long min = min_.load(std::memory_order_relaxed);
+    while (value < min && !min_.compare_exchange_weak(min, value, std::memory_order_relaxed)) { }
+  }
+
+  /**
+   * Copy the current counts.  Values recorded concurrently may or may not be included.
+   *
+   * @return the snapshot.
+   */
+  Snapshot snapshot() const;
+
+  /**
+   * Discard all recorded values.  Values recorded concurrently may be lost.
+   */
+  void reset();
+
+  static int indexOf(const long value) {
+    if (value < SUB_BUCKET_COUNT) {
+      return (int)value;
+    }
+
+    const int shift = (63 - __builtin_clzl((unsigned long)value)) - (SUB_BUCKET_BITS - 1);
+    return shift * SUB_BUCKET_HALF + (int)(value >> shift);
+  }
+
+  static long lowestEquivalentValue(const int index);
+
+  static long highestEquivalentValue(const int index);
+
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+};
+
+}
+
+#endif /* __VARONT_HISTOGRAM_HPP__ */
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Journal.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+namespace {
+
+const char SEGMENT_SUFFIX[] = ".journal";
+const std::size_t SEQUENCE_DIGITS = 20;
+
+std::string getSegmentPath(const std::string& directory, const long sequence) {
+  char name[64];
+  std::snprintf(name, sizeof(name), "%020ld%s", sequence, SEGMENT_SUFFIX);
+  return directory + "/" + name;
+}
+
+bool isSegmentName(const std::string& name) {
+  const std::size_t suffixLength = sizeof(SEGMENT_SUFFIX) - 1;
+  if (name.size() != SEQUENCE_DIGITS + suffixLength
+      || 0 != name.compare(SEQUENCE_DIGITS, suffixLength, SEGMENT_SUFFIX)) {
+    return false;
+  }
+  return std::all_of(name.begin(), name.begin() + SEQUENCE_DIGITS, [](char c) { return c >= '0' && c <= '9'; });
+}
+
+void syncDirectory(const std::string& directory) {
+  const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (-1 == fd) {
+    throw std::system_error(errno, std::system_category(), "open " + directory);
+  }
+  const int rc = ::fsync(fd);
+  const int error = errno;
+  ::close(fd);
+  if (-1 == rc) {
+    throw std::system_error(error, std::system_category(), "fsync " + directory);
+  }
+}
+
+std::size_t pageAlign(const std::size_t offset) {
+  static const std::size_t pageSize = (std::size_t)::sysconf(_SC_PAGESIZE);
+  return offset & ~(pageSize - 1);
+}
+
+}
+
+Journal::Journal(const std::string& directory, const std::size_t segmentSize)
+  : directory_(directory)
+  , segmentSize_(segmentSize)
+  , fd_(-1)
+  , segment_(nullptr)
+  , mappedSize_(0)
+  , position_(0)
+  , syncedPosition_(0)
+  , lastSequence_(-1L)
+  , syncedSequence_(-1L)
+{
+  if (segmentSize_ != pageAlign(segmentSize_) || segmentSize_ < (std::size_t)::sysconf(_SC_PAGESIZE)) {
+    throw std::out_of_range("segmentSize must be a multiple of the page size");
+  }
+
+  recover();
+}
+
+Journal::~Journal() {
+  try {
+    sync();
+  }
+  catch (std::system_error&) {
+    /* Nothing can be reported from a destructor; the records will be missing on recovery. */
+  }
+  closeSegment();
+}
+
+void Journal::append(const long sequence, const void* data, const int length) {
+  if (length < 0 || length > getMaxRecordLength()) {
+    throw std::out_of_range("length must not be negative or greater than the maximum record length");
+  }
+
+  const std::size_t recordLength = getRecordLength(length);
+  if (nullptr == segment_ || position_ + recordLength > mappedSize_) {
+    roll(sequence);
+  }
+
+  char* record = segment_ + position_;
+  RecordHeader* header = reinterpret_cast<RecordHeader*>(record);
+  std::memcpy(record + HEADER_LENGTH, data, length);
+  header->sequence = sequence;
+  header->checksum = checksum(sequence, data, length);
+  header->length = length;
+
+  position_ += recordLength;
+  lastSequence_ = sequence;
+}
+
+void Journal::sync() {
+  if (nullptr != segment_ && position_ > syncedPosition_) {
+    const std::size_t start = pageAlign(syncedPosition_);
+    if (-1 == ::msync(segment_ + start, position_ - start, MS_SYNC)) {
+      throw std::system_error(errno, std::system_category(), "msync");
+    }
+    syncedPosition_ = position_;
+  }
+  syncedSequence_ = lastSequence_;
+}
+
+uint32_t Journal::checksum(const long sequence, const void* data, const int length) {
+  const int64_t value = sequence;
+  return util::crc32c(data, length, util::crc32c(&value, sizeof(value)));
+}
+
+const Journal::RecordHeader* Journal::getRecord(const char* segment, const std::size_t size, const std::size_t offset) {
+  if (offset + HEADER_LENGTH > size) {
+    return nullptr;
+  }
+
+  const RecordHeader* header = reinterpret_cast<const RecordHeader*>(segment + offset);
+  if (header->length < 0 || offset + getRecordLength(header->length) > size) {
+    return nullptr;
+  }
+
+  if (checksum(header->sequence, segment + offset + HEADER_LENGTH, header->length) != header->checksum) {
+    return nullptr;
+  }
+
+  return header;
+}
+
+std::vector<std::string> Journal::listSegments(const std::string& directory) {
+  DIR* dir = ::opendir(directory.c_str());
+  if (nullptr == dir) {
+    throw std::system_error(errno, std::system_category(), "opendir " + directory);
+  }
+
+  std::vector<std::string> names;
+  while (struct dirent* entry = ::readdir(dir)) {
+    if (isSegmentName(entry->d_name)) {
+      names.push_back(entry->d_name);
+    }
+  }
+  ::closedir(dir);
+
+  std::sort(names.begin(), names.end());
+
+  std::vector<std::string> paths;
+  for (const std::string& name : names) {
+    paths.push_back(directory + "/" + name);
+  }
+  return paths;
+}
+
+long Journal::getFirstSequence(const std::string& path) {
+  const std::size_t slash = path.rfind('/');
+  const std::string name = path.substr(std::string::npos == slash ? 0 : slash + 1);
+  return std::strtol(name.substr(0, SEQUENCE_DIGITS).c_str(), nullptr, 10);
+}
+
+void Journal::openSegment(const std::string& path, const bool create) {
+  const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0644);
+  if (-1 == fd) {
+    throw std::system_error(errno, std::system_category(), "open " + path);
+  }
+
+  std::size_t size = segmentSize_;
+  if (create) {
+    /* Allocating up front leaves only data, not metadata, for msync to flush. */
+    int rc = ::posix_fallocate(fd, 0, (off_t)size);
+    if (EOPNOTSUPP == rc || EINVAL == rc) {
+      rc = (-1 == ::ftruncate(fd, (off_t)size)) ? errno : 0;
+    }
+    if (0 != rc) {
+      ::close(fd);
+      ::unlink(path.c_str());
+      throw std::system_error(rc, std::system_category(), "allocate " + path);
+    }
+  }
+  else {
+    struct stat status;
+    if (-1 == ::fstat(fd, &status)) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::system_category(), "fstat " + path);
+    }
+    size = (std::size_t)status.st_size;
+  }
+
+  void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (MAP_FAILED == address) {
+    const int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::system_category(), "mmap " + path);
+  }
+
+  if (create) {
+    syncDirectory(directory_);
+  }
+
+  fd_ = fd;
+  segment_ = static_cast<char*>(address);
+  mappedSize_ = size;
+  position_ = 0;
+  syncedPosition_ = 0;
+}
+
+void Journal::closeSegment() {
+  if (nullptr != segment_) {
+    ::munmap(segment_, mappedSize_);
+    ::close(fd_);
+    segment_ = nullptr;
+    fd_ = -1;
+    mappedSize_ = 0;
+  }
+}
+
+void Journal::roll(const long sequence) {
+  if (nullptr != segment_) {
+    sync();
+    closeSegment();
+  }
+  openSegment(getSegmentPath(directory_, sequence), true);
+}
+
+void Journal::recover() {
+  std::vector<std::string> segments = listSegments(directory_);
+
+  while (!segments.empty()) {
+    const std::string path = segments.back();
+    openSegment(path, false);
+
+    const RecordHeader* header;
+    while (nullptr != (header = getRecord(segment_, mappedSize_, position_))) {
+      lastSequence_ = header->sequence;
+      position_ += getRecordLength(header->length);
+    }
+
+    if (0 != position_ || 1 == segments.size()) {
+      break;
+    }
+
+    /* Nothing of the last segment survived, so continue the one before it. */
+    closeSegment();
+    ::unlink(path.c_str());
+    segments.pop_back();
+  }
+
+  if (nullptr == segment_) {
+    return;
+  }
+
+  /* Zero whatever a crash left after the last valid record, so it can never be read as a record. */
+  std::size_t end = mappedSize_;
+  while (end > position_ && 0 == segment_[end - 1]) {
+    --end;
+  }
+  if (end > position_) {
+    std::memset(segment_ + position_, 0, end - position_);
+    if (-1 == ::msync(segment_ + pageAlign(position_), end - pageAlign(position_), MS_SYNC)) {
+      throw std::system_error(errno, std::system_category(), "msync");
+    }
+  }
+
+  syncedPosition_ = position_;
+  syncedSequence_ = lastSequence_;
+}
+
+}
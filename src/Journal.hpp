@@ -0,0 +1,169 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_JOURNAL_HPP__
+#define __VARONT_JOURNAL_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace varont {
+
+/**
+ * Append only log of event records in pre-allocated, memory mapped segment files.
+ *
+ * Each record is a header of the payload length, a CRC-32C checksum of the sequence and
+ * payload, and the sequence, followed by the payload padded to ALIGNMENT bytes.  Records
+ * are written into the mapping and made durable by sync(), which flushes everything
+ * appended since the previous sync with a single msync, so that a batch of events is
+ * committed as one group.  Segments are named by the first sequence they hold and a new
+ * one is allocated when a record does not fit in the remainder of the current segment.
+ *
+ * Opening a directory that already holds segments continues after the last record whose
+ * checksum is valid, discarding anything torn by a crash.
+ *
+ * A Journal is not thread safe; it is meant to be written by a single
+ * {@link JournalEventHandler}.
+ */
+class Journal {
+public:
+  static const int ALIGNMENT = 8;
+  static const int HEADER_LENGTH = 16;
+  static const std::size_t DEFAULT_SEGMENT_SIZE = 64UL * 1024UL * 1024UL;
+
+  struct RecordHeader {
+    int32_t length;
+    uint32_t checksum;
+    int64_t sequence;
+  };
+
+private:
+  std::string directory_;
+  std::size_t segmentSize_;
+  int fd_;
+  char* segment_;
+  std::size_t mappedSize_;
+  std::size_t position_;
+  std::size_t syncedPosition_;
+  long lastSequence_;
+  long syncedSequence_;
+
+public:
+  /**
+   * Open a journal, creating the directory's first segment on the first append.
+   *
+   * @param directory holding the segments, which must exist.
+   * @param segmentSize of each segment file in bytes, a multiple of the page size.
+   * @throws std::system_error if an existing segment cannot be opened.
+   */
+  Journal(const std::string& directory, const std::size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+
+  /**
+   * Sync and close the current segment.
+   */
+  ~Journal();
+
+  /**
+   * Append a record to the current segment, rolling to a new segment if it does not fit.
+   * The record is not durable until the next sync().
+   *
+   * @param sequence of the event.
+   * @param data payload of the record.
+   * @param length of the payload, no greater than getMaxRecordLength().
+   * @throws std::system_error if a new segment cannot be allocated.
+   */
+  void append(const long sequence, const void* data, const int length);
+
+  /**
+   * Flush every record appended since the previous sync to disk.
+   *
+   * @throws std::system_error if the flush fails.
+   */
+  void sync();
+
+  /**
+   * Get the sequence of the last record appended, or -1 if there is none.
+   */
+  long getLastSequence() const {
+    return lastSequence_;
+  }
+
+  /**
+   * Get the sequence of the last record made durable, or -1 if there is none.
+   */
+  long getSyncedSequence() const {
+    return syncedSequence_;
+  }
+
+  /**
+   * Get the largest payload that fits in a segment.
+   */
+  int getMaxRecordLength() const {
+    return (int)(segmentSize_ - HEADER_LENGTH);
+  }
+
+  const std::string& getDirectory() const {
+    return directory_;
+  }
+
+  /**
+   * Get the number of bytes taken by a record of length bytes of payload.
+   */
+  static std::size_t getRecordLength(const int length) {
+    return (HEADER_LENGTH + length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+  /**
+   * Compute the checksum of a record.
+   */
+  static uint32_t checksum(const long sequence, const void* data, const int length);
+
+  /**
+   * Get the record at an offset of a segment, if it is complete and its checksum is valid.
+   *
+   * @param segment mapping of a segment.
+   * @param size of the segment.
+   * @param offset of the record.
+   * @return the record's header, or nullptr at the end of the valid records.
+   */
+  static const RecordHeader* getRecord(const char* segment, const std::size_t size, const std::size_t offset);
+
+  /**
+   * List the paths of the segments in a directory, in order of their first sequence.
+   *
+   * @throws std::system_error if the directory cannot be read.
+   */
+  static std::vector<std::string> listSegments(const std::string& directory);
+
+  /**
+   * Get the first sequence held by a segment from its path.
+   */
+  static long getFirstSequence(const std::string& path);
+
+  Journal(const Journal&) = delete;
+  Journal& operator=(const Journal&) = delete;
+
+private:
+  void openSegment(const std::string& path, const bool create);
+  void closeSegment();
+  void roll(const long sequence);
+  void recover();
+};
+
+}
+
+#endif /* __VARONT_JOURNAL_HPP__ */
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_JOURNALEVENTHANDLER_HPP__
+#define __VARONT_JOURNALEVENTHANDLER_HPP__
+
+#include <stdexcept>
+#include <vector>
+
+#include "Journal.hpp"
+#include "JournalSerializer.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "Sequencer.hpp"
+#include "Sequence.hpp"
+
+namespace varont {
+
+/**
+ * Appends every event to a {@link Journal}, committing each batch with a single sync at
+ * the end of the batch.
+ *
+ * The durable sequence is advanced only once a batch has been synced, so stages gated on
+ * it, rather than on the {@link BatchEventProcessor}'s sequence, only see persisted
+ * events:
+ *
+ * <pre>
+ *   JournalEventHandler<Order> journaller(journal, serializer);
+ *   BatchEventProcessor<Order> journalProcessor(ringBuffer, *ringBuffer.newBarrier({ }), journaller);
+ *   std::unique_ptr<SequenceBarrier> businessBarrier = ringBuffer.newBarrier({ &journaller.getDurableSequence() });
+ * </pre>
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class JournalEventHandler
+    : public LifecycleAwareEventHandler<T>
+{
+  Journal& journal_;
+  JournalSerializer<T>& serializer_;
+  std::vector<char> buffer_;
+  Sequence durableSequence_;
+
+ public:
+  /**
+   * @param journal to append to.
+   * @param serializer writing each event's payload.
+   * @param maxRecordLength largest payload the serializer will write.
+   */
+  JournalEventHandler(Journal& journal, JournalSerializer<T>& serializer, const int maxRecordLength = 4096)
+      : journal_(journal)
+      , serializer_(serializer)
+      , buffer_(maxRecordLength)
+      , durableSequence_(journal.getSyncedSequence())
+  {
+    if (maxRecordLength > journal.getMaxRecordLength()) {
+      throw std::out_of_range("maxRecordLength must fit in a journal segment");
+    }
+  }
+
+  /**
+   * Get the {@link Sequence} of the last event made durable.
+   */
+  Sequence& getDurableSequence() {
+    return durableSequence_;
+  }
+
+  void onEvent(T& event, long sequence, bool endOfBatch) {
+    const int length = serializer_.serialize(event, buffer_.data(), (int)buffer_.size());
+    if (length < 0) {
+      throw std::length_error("event does not fit in the journal record buffer");
+    }
+
+    journal_.append(sequence, buffer_.data(), length);
+
+    if (endOfBatch) {
+      journal_.sync();
+      durableSequence_.set(sequence);
+    }
+  }
+
+  void onStart() { }
+
+  void onShutdown() {
+    journal_.sync();
+    durableSequence_.set(journal_.getSyncedSequence());
+  }
+
+  JournalEventHandler(const JournalEventHandler&) = delete;
+  JournalEventHandler& operator=(const JournalEventHandler&) = delete;
+};
+
+}
+
+#endif /* __VARONT_JOURNALEVENTHANDLER_HPP__ */
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "JournalReader.hpp"
+
+namespace varont {
+
+JournalReader::JournalReader(const std::string& directory, const long fromSequence)
+  : segments_(Journal::listSegments(directory))
+  , segmentIndex_(0)
+  , fromSequence_(fromSequence)
+  , fd_(-1)
+  , segment_(nullptr)
+  , size_(0)
+  , position_(0)
+{
+  /* Start from the last segment beginning at or before fromSequence. */
+  while (segmentIndex_ + 1 < segments_.size()
+         && Journal::getFirstSequence(segments_[segmentIndex_ + 1]) <= fromSequence) {
+    ++segmentIndex_;
+  }
+}
+
+JournalReader::~JournalReader() {
+  closeSegment();
+}
+
+int JournalReader::read(std::vector<JournalRecord>& records, const int max) {
+  records.clear();
+
+  while (records.empty()) {
+    if (nullptr == segment_ && !openNextSegment()) {
+      return 0;
+    }
+
+    const Journal::RecordHeader* header;
+    while ((int)records.size() < max && nullptr != (header = Journal::getRecord(segment_, size_, position_))) {
+      position_ += Journal::getRecordLength(header->length);
+      if (header->sequence >= fromSequence_) {
+        records.push_back(JournalRecord{ header->sequence,
+              reinterpret_cast<const char*>(header) + Journal::HEADER_LENGTH, header->length });
+      }
+    }
+
+    if (records.empty()) {
+      /* The end of the valid records of this segment; the views returned before are no longer used. */
+      closeSegment();
+      ++segmentIndex_;
+    }
+  }
+
+  return (int)records.size();
+}
+
+bool JournalReader::openNextSegment() {
+  if (segmentIndex_ >= segments_.size()) {
+    return false;
+  }
+
+  const std::string& path = segments_[segmentIndex_];
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (-1 == fd) {
+    throw std::system_error(errno, std::system_category(), "open " + path);
+  }
+
+  struct stat status;
+  if (-1 == ::fstat(fd, &status)) {
+    const int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::system_category(), "fstat " + path);
+  }
+
+  void* address = ::mmap(nullptr, (std::size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (MAP_FAILED == address) {
+    const int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::system_category(), "mmap " + path);
+  }
+  ::madvise(address, (std::size_t)status.st_size, MADV_SEQUENTIAL);
+
+  fd_ = fd;
+  segment_ = static_cast<const char*>(address);
+  size_ = (std::size_t)status.st_size;
+  position_ = 0;
+  return true;
+}
+
+void JournalReader::closeSegment() {
+  if (nullptr != segment_) {
+    ::munmap(const_cast<char*>(segment_), size_);
+    ::close(fd_);
+    segment_ = nullptr;
+    fd_ = -1;
+  }
+}
+
+}
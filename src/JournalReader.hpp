@@ -0,0 +1,80 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_JOURNALREADER_HPP__
+#define __VARONT_JOURNALREADER_HPP__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Journal.hpp"
+
+namespace varont {
+
+/**
+ * View of a record read from a {@link Journal}, valid until the next call to read.
+ */
+struct JournalRecord {
+  long sequence;
+  const char* data;
+  int length;
+};
+
+/**
+ * Reads the records of a {@link Journal} directory in order, mapping one segment at a
+ * time read only.
+ */
+class JournalReader {
+  std::vector<std::string> segments_;
+  std::size_t segmentIndex_;
+  long fromSequence_;
+  int fd_;
+  const char* segment_;
+  std::size_t size_;
+  std::size_t position_;
+
+public:
+  /**
+   * @param directory of the journal.
+   * @param fromSequence first sequence to read; earlier records are skipped.
+   * @throws std::system_error if the directory cannot be read.
+   */
+  JournalReader(const std::string& directory, const long fromSequence = 0L);
+
+  ~JournalReader();
+
+  /**
+   * Read up to max records, replacing the contents of records.  The views point into the
+   * mapping of the current segment, so are only valid until the next call.
+   *
+   * @param records to fill.
+   * @param max number of records to read.
+   * @return the number of records read, 0 at the end of the journal.
+   * @throws std::system_error if a segment cannot be mapped.
+   */
+  int read(std::vector<JournalRecord>& records, const int max);
+
+  JournalReader(const JournalReader&) = delete;
+  JournalReader& operator=(const JournalReader&) = delete;
+
+private:
+  bool openNextSegment();
+  void closeSegment();
+};
+
+}
+
+#endif /* __VARONT_JOURNALREADER_HPP__ */
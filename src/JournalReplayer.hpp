@@ -0,0 +1,153 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_JOURNALREPLAYER_HPP__
+#define __VARONT_JOURNALREPLAYER_HPP__
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BatchDescriptor.hpp"
+#include "JournalReader.hpp"
+#include "JournalSerializer.hpp"
+#include "RingBuffer.hpp"
+#include "Sequencer.hpp"
+#include "Sequence.hpp"
+
+#include "IllegalStateException.hpp"
+
+namespace varont {
+
+/**
+ * Publishes the records of a {@link Journal} back into a {@link RingBuffer}, claiming
+ * each batch of records read with a single {@link BatchDescriptor}, to restore the state
+ * of the processors after a restart.
+ *
+ * Events are replayed at the sequences they were journaled with, so once replay returns
+ * live publishing continues from the next sequence.  A fresh {@link RingBuffer} starts at
+ * sequence 0; to replay from a later sequence, such as the one following a snapshot,
+ * first call positionAt with the sequences of the processors.
+ *
+ * Handlers that must not see replayed events, such as the {@link JournalEventHandler}
+ * itself or those sending output, are wrapped in a {@link ReplaySkippingEventHandler}
+ * given getReplayedSequence().
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class JournalReplayer {
+  JournalReader reader_;
+  RingBuffer<T>& ringBuffer_;
+  JournalSerializer<T>& serializer_;
+  const int batchSize_;
+  Sequence replayedSequence_;
+
+public:
+  /**
+   * @param directory of the journal.
+   * @param ringBuffer to publish into.
+   * @param serializer reading each event from its payload.
+   * @param batchSize largest number of records published in one batch.
+   * @param fromSequence first sequence to replay.
+   */
+  JournalReplayer(const std::string& directory, RingBuffer<T>& ringBuffer, JournalSerializer<T>& serializer,
+                  const int batchSize = 1024, const long fromSequence = 0L)
+    : reader_(directory, fromSequence)
+    , ringBuffer_(ringBuffer)
+    , serializer_(serializer)
+    , batchSize_(std::min(batchSize, ringBuffer.getBufferSize()))
+    , replayedSequence_(Sequencer::INITIAL_CURSOR_VALUE)
+  {
+    if (batchSize < 1) {
+      throw std::out_of_range("batchSize must be greater than 0");
+    }
+  }
+
+  /**
+   * Get the {@link Sequence} of the last event published by the replay.  It is advanced
+   * before each batch is published, so a handler seeing an event at or before it is
+   * seeing a replayed event.
+   */
+  Sequence& getReplayedSequence() {
+    return replayedSequence_;
+  }
+
+  /**
+   * Move the cursor of a {@link RingBuffer} that has not been published to, and the
+   * sequences of its processors, to just before the first sequence to be replayed.
+   * Must be called before the processors are started.
+   *
+   * @param sequence first sequence to be replayed.
+   * @param processorSequences gating the {@link RingBuffer}.
+   */
+  void positionAt(const long sequence, const std::vector<Sequence*>& processorSequences) {
+    const long previous = sequence - 1L;
+    for (Sequence* processorSequence : processorSequences) {
+      processorSequence->set(previous);
+    }
+    replayedSequence_.set(previous);
+
+    if (Sequencer::INITIAL_CURSOR_VALUE != previous) {
+      ringBuffer_.claim(previous);
+      ringBuffer_.forcePublish(previous);
+    }
+  }
+
+  /**
+   * Publish every record of the journal from the starting sequence.
+   *
+   * @return the sequence of the last event replayed.
+   * @throws IllegalStateException if a record's sequence is not the next sequence of the {@link RingBuffer},
+   * in which case nothing of that batch is claimed.
+   */
+  long replay() {
+    std::vector<JournalRecord> records;
+    records.reserve(batchSize_);
+
+    int count;
+    while (0 != (count = reader_.read(records, batchSize_))) {
+      /* Replay is the only publisher, so the batch will be claimed from just after the cursor. */
+      const long start = ringBuffer_.getCursor() + 1L;
+      for (int i = 0; i < count; ++i) {
+        if (records[i].sequence != start + i) {
+          std::stringstream message;
+          message << "journal record " << records[i].sequence << " would be replayed at sequence " << (start + i);
+          throw IllegalStateException(message.str());
+        }
+      }
+
+      BatchDescriptor batchDescriptor(count);
+      ringBuffer_.next(batchDescriptor);
+      for (const JournalRecord& record : records) {
+        serializer_.deserialize(record.data, record.length, ringBuffer_.get(record.sequence));
+      }
+
+      replayedSequence_.set(batchDescriptor.getEnd());
+      ringBuffer_.publish(batchDescriptor);
+    }
+
+    return replayedSequence_.get();
+  }
+
+  JournalReplayer(const JournalReplayer&) = delete;
+  JournalReplayer& operator=(const JournalReplayer&) = delete;
+};
+
+}
+
+#endif /* __VARONT_JOURNALREPLAYER_HPP__ */
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_JOURNALSERIALIZER_HPP__
+#define __VARONT_JOURNALSERIALIZER_HPP__
+
+namespace varont {
+
+/**
+ * Converts events to and from the payload of {@link Journal} records.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class JournalSerializer {
+ public:
+  /**
+   * Write an event into a buffer.
+   *
+   * @param event to serialize.
+   * @param buffer to write to.
+   * @param capacity of the buffer in bytes.
+   * @return the number of bytes written, or -1 if the event does not fit in capacity.
+   */
+  virtual int serialize(const T& event, char* buffer, int capacity) = 0;
+
+  /**
+   * Read an event from the payload of a record.
+   *
+   * @param data payload of the record.
+   * @param length of the payload in bytes.
+   * @param event to overwrite.
+   */
+  virtual void deserialize(const char* data, int length, T& event) = 0;
+
+ protected:
+  ~JournalSerializer() {}
+};
+
+}
+
+#endif /* __VARONT_JOURNALSERIALIZER_HPP__ */
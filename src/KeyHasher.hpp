@@ -0,0 +1,47 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_KEYHASHER_HPP__
+#define __VARONT_KEYHASHER_HPP__
+
+#include <cstddef>
+
+namespace varont {
+
+/**
+ * Hashes the key of an event, which decides the {@link PartitionedEventProcessor} that
+ * handles it.  Events with equal keys must have equal hashes.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class KeyHasher {
+ public:
+  /**
+   * Called by every processor of the group for every event, so it should read no more
+   * of the event than its key.
+   *
+   * @param event to hash the key of.
+   * @return the hash of the key.
+   */
+  virtual std::size_t hash(const T& event) = 0;
+
+ protected:
+  ~KeyHasher() {}
+};
+
+}
+
+#endif /* __VARONT_KEYHASHER_HPP__ */
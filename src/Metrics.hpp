@@ -0,0 +1,106 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_METRICS_HPP__
+#define __VARONT_METRICS_HPP__
+
+#include <atomic>
+
+#include "Histogram.hpp"
+
+namespace varont {
+
+/**
+ * Monotonic count padded to its own cache line, so that counters updated by different
+ * threads do not contend.  Increments are relaxed; a reader sees a recent, not
+ * necessarily the latest, value.
+ */
+class Counter {
+  std::atomic_long value_;
+  long p1, p2, p3, p4, p5, p6, p7;
+
+public:
+  Counter()
+    : value_(0L)
+    , p1(7), p2(7), p3(7), p4(7), p5(7), p6(7), p7(7)
+  {}
+
+  void increment(const long delta = 1L) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  long get() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+  long sumPaddingToPreventOptimisation() {
+    return p1 + p2 + p3 + p4 + p5 + p6 + p7;
+  }
+
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+};
+
+/**
+ * Updated by a {@link ClaimStrategy} each time a publisher has to wait for consumers
+ * to free a slot.
+ */
+struct ProducerMetrics {
+  /** Claims that found the buffer full. */
+  Counter stalls;
+  /** Total time spent waiting in those claims, in nanoseconds. */
+  Counter stallNanos;
+};
+
+/**
+ * Updated by an {@link EventPublisher} or {@link SpillingPublisher} for each event kept
+ * out of a full {@link RingBuffer}.
+ */
+struct PublisherMetrics {
+  /** Events discarded by the DropNewest policy. */
+  Counter dropped;
+  /** Events discarded by the BlockWithTimeout policy after the timeout. */
+  Counter timedOut;
+  /** Events handed to the {@link OverflowHandler} by the Redirect policy. */
+  Counter redirected;
+  /** Events written to the overflow file of a {@link SpillingPublisher}. */
+  Counter spilled;
+};
+
+/**
+ * Updated by a {@link WaitStrategy} as processors wait for events.
+ */
+struct WaitMetrics {
+  /** Times a waiting processor blocked or slept. */
+  Counter parks;
+  /** Signals sent by publishers to blocked processors. */
+  Counter wakeups;
+};
+
+/**
+ * Updated by an {@link EventProcessor} as it handles events.
+ */
+struct ProcessorMetrics {
+  /** Number of events available each time the processor returned from waiting. */
+  Histogram batchSizes;
+  /** Exceptions thrown by the event handler. */
+  Counter exceptions;
+  /** Errors reported by the event handler through its error_code. */
+  Counter errors;
+};
+
+}
+
+#endif /* __VARONT_METRICS_HPP__ */
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "MetricsRegistry.hpp"
+
+namespace varont {
+
+namespace {
+
+const double SUMMARY_QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+
+std::string escapeLabel(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    switch (c) {
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    default:
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+void writeHeader(std::ostream& out, const char* name, const char* type, const char* help) {
+  out << "# HELP " << name << ' ' << help << '\n';
+  out << "# TYPE " << name << ' ' << type << '\n';
+}
+
+void writeAll(int fd, const std::string& data) {
+  const char* next = data.data();
+  std::size_t remaining = data.size();
+
+  while (remaining > 0) {
+    const ssize_t written = ::write(fd, next, remaining);
+    if (written < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      throw std::system_error(errno, std::system_category(), "write");
+    }
+    next += written;
+    remaining -= written;
+  }
+}
+
+}
+
+void MetricsRegistry::addRingBuffer(const std::string& name, Sequencer& sequencer,
+                                    ProducerMetrics* producerMetrics, WaitMetrics* waitMetrics)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  ringBuffers_.push_back({ name, &sequencer, producerMetrics, waitMetrics });
+}
+
+void MetricsRegistry::addProcessor(const std::string& ringBufferName, const std::string& name,
+                                   Sequencer& sequencer, Sequence& sequence, ProcessorMetrics* metrics)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  processors_.push_back({ ringBufferName, name, &sequencer, &sequence, metrics });
+}
+
+void MetricsRegistry::write(std::ostream& out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  writeHeader(out, "varont_ring_buffer_cursor", "gauge", "Highest published sequence.");
+  for (RingBufferEntry& entry : ringBuffers_) {
+    out << "varont_ring_buffer_cursor{ring_buffer=\"" << escapeLabel(entry.name) << "\"} "
+        << entry.sequencer->getCursor() << '\n';
+  }
+
+  writeHeader(out, "varont_ring_buffer_remaining_capacity", "gauge", "Slots free for publishers.");
+  for (RingBufferEntry& entry : ringBuffers_) {
+    out << "varont_ring_buffer_remaining_capacity{ring_buffer=\"" << escapeLabel(entry.name) << "\"} "
+        << entry.sequencer->remainingCapacity() << '\n';
+  }
+
+  writeHeader(out, "varont_producer_stalls_total", "counter", "Claims that waited for a free slot.");
+  for (RingBufferEntry& entry : ringBuffers_) {
+    if (nullptr != entry.producerMetrics) {
+      out << "varont_producer_stalls_total{ring_buffer=\"" << escapeLabel(entry.name) << "\"} "
+          << entry.producerMetrics->stalls.get() << '\n';
+    }
+  }
+
+  writeHeader(out, "varont_producer_stall_seconds_total", "counter", "Time claims spent waiting for a free slot.");
+  for (RingBufferEntry& entry : ringBuffers_) {
+    if (nullptr != entry.producerMetrics) {
+      out << "varont_producer_stall_seconds_total{ring_buffer=\"" << escapeLabel(entry.name) << "\"} "
+          << (double)entry.producerMetrics->stallNanos.get() / 1e9 << '\n';
+    }
+  }
+
+  writeHeader(out, "varont_wait_parks_total", "counter", "Times a waiting processor blocked or slept.");
+  for (RingBufferEntry& entry : ringBuffers_) {
+    if (nullptr != entry.waitMetrics) {
+      out << "varont_wait_parks_total{ring_buffer=\"" << escapeLabel(entry.name) << "\"} "
+          << entry.waitMetrics->parks.get() << '\n';
+    }
+  }
+
+  writeHeader(out, "varont_wait_wakeups_total", "counter", "Signals sent by publishers to blocked processors.");
+  for (RingBufferEntry& entry : ringBuffers_) {
+    if (nullptr != entry.waitMetrics) {
+      out << "varont_wait_wakeups_total{ring_buffer=\"" << escapeLabel(entry.name) << "\"} "
+          << entry.waitMetrics->wakeups.get() << '\n';
+    }
+  }
+
+  writeHeader(out, "varont_processor_lag", "gauge", "Published events not yet processed.");
+  for (ProcessorEntry& entry : processors_) {
+    out << "varont_processor_lag{ring_buffer=\"" << escapeLabel(entry.ringBufferName)
+        << "\",processor=\"" << escapeLabel(entry.name) << "\"} "
+        << entry.sequencer->getCursor() - entry.sequence->get() << '\n';
+  }
+
+  writeHeader(out, "varont_processor_exceptions_total", "counter", "Exceptions thrown by the event handler.");
+  for (ProcessorEntry& entry : processors_) {
+    if (nullptr != entry.metrics) {
+      out << "varont_processor_exceptions_total{ring_buffer=\"" << escapeLabel(entry.ringBufferName)
+          << "\",processor=\"" << escapeLabel(entry.name) << "\"} "
+          << entry.metrics->exceptions.get() << '\n';
+    }
+  }
+
+  writeHeader(out, "varont_processor_errors_total", "counter", "Errors reported by the event handler.");
+  for (ProcessorEntry& entry : processors_) {
+    if (nullptr != entry.metrics) {
+      out << "varont_processor_errors_total{ring_buffer=\"" << escapeLabel(entry.ringBufferName)
+          << "\",processor=\"" << escapeLabel(entry.name) << "\"} "
+          << entry.metrics->errors.get() << '\n';
+    }
+  }
+
+  writeHeader(out, "varont_processor_batch_size", "summary", "Events available each time the processor woke.");
+  for (ProcessorEntry& entry : processors_) {
+    if (nullptr == entry.metrics) {
+      continue;
+    }
+
+    const std::string labels = "ring_buffer=\"" + escapeLabel(entry.ringBufferName)
+      + "\",processor=\"" + escapeLabel(entry.name) + "\"";
+    const Histogram::Snapshot snapshot = entry.metrics->batchSizes.snapshot();
+
+    for (double quantile : SUMMARY_QUANTILES) {
+      out << "varont_processor_batch_size{" << labels << ",quantile=\"" << quantile << "\"} "
+          << snapshot.getValueAtPercentile(quantile * 100.0) << '\n';
+    }
+    out << "varont_processor_batch_size_sum{" << labels << "} " << snapshot.getSum() << '\n';
+    out << "varont_processor_batch_size_count{" << labels << "} " << snapshot.getTotalCount() << '\n';
+  }
+}
+
+std::string MetricsRegistry::toPrometheusText() {
+  std::ostringstream out;
+  write(out);
+  return out.str();
+}
+
+void MetricsRegistry::writeFile(const std::string& path) {
+  const std::string text = toPrometheusText();
+  const std::string tmpPath = path + ".tmp";
+
+  const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (-1 == fd) {
+    throw std::system_error(errno, std::system_category(), "open " + tmpPath);
+  }
+
+  try {
+    writeAll(fd, text);
+  }
+  catch (...) {
+    ::close(fd);
+    ::unlink(tmpPath.c_str());
+    throw;
+  }
+  ::close(fd);
+
+  if (-1 == std::rename(tmpPath.c_str(), path.c_str())) {
+    const int error = errno;
+    ::unlink(tmpPath.c_str());
+    throw std::system_error(error, std::system_category(), "rename " + tmpPath);
+  }
+}
+
+void MetricsRegistry::sendToUnixSocket(const std::string& path) {
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::system_error(ENAMETOOLONG, std::system_category(), path);
+  }
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (-1 == fd) {
+    throw std::system_error(errno, std::system_category(), "socket");
+  }
+
+  try {
+    if (-1 == ::connect(fd, (struct sockaddr*)&address, sizeof(address))) {
+      throw std::system_error(errno, std::system_category(), "connect " + path);
+    }
+    writeAll(fd, toPrometheusText());
+  }
+  catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_METRICSREGISTRY_HPP__
+#define __VARONT_METRICSREGISTRY_HPP__
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Metrics.hpp"
+#include "Sequencer.hpp"
+#include "Sequence.hpp"
+
+namespace varont {
+
+/**
+ * Collects the metrics of a set of {@link RingBuffer}s and their processors for export in
+ * the Prometheus text format.
+ *
+ * Nothing is computed on the hot path: remaining capacity and processor lag (the cursor
+ * less the processor's sequence) are read when a snapshot is taken, and the counters and
+ * histograms are only read.  Registration and export may be called from any thread, but
+ * everything registered must outlive the registry.
+ */
+class MetricsRegistry {
+  struct RingBufferEntry {
+    std::string name;
+    Sequencer* sequencer;
+    ProducerMetrics* producerMetrics;
+    WaitMetrics* waitMetrics;
+  };
+
+  struct ProcessorEntry {
+    std::string ringBufferName;
+    std::string name;
+    Sequencer* sequencer;
+    Sequence* sequence;
+    ProcessorMetrics* metrics;
+  };
+
+  std::mutex mutex_;
+  std::vector<RingBufferEntry> ringBuffers_;
+  std::vector<ProcessorEntry> processors_;
+
+public:
+  MetricsRegistry() {}
+
+  /**
+   * Register a {@link RingBuffer}, or other {@link Sequencer}, for export.
+   *
+   * @param name of the ring buffer, used as the ring_buffer label.
+   * @param sequencer of the ring buffer.
+   * @param producerMetrics set on its {@link ClaimStrategy}, or nullptr.
+   * @param waitMetrics set on its {@link WaitStrategy}, or nullptr.
+   */
+  void addRingBuffer(const std::string& name, Sequencer& sequencer,
+                     ProducerMetrics* producerMetrics = nullptr, WaitMetrics* waitMetrics = nullptr);
+
+  /**
+   * Register a processor consuming from a {@link RingBuffer} for export.
+   *
+   * @param ringBufferName the ring buffer was registered with.
+   * @param name of the processor, used as the processor label.
+   * @param sequencer the processor consumes from.
+   * @param sequence of the processor.
+   * @param metrics set on the processor, or nullptr.
+   */
+  void addProcessor(const std::string& ringBufferName, const std::string& name,
+                    Sequencer& sequencer, Sequence& sequence, ProcessorMetrics* metrics = nullptr);
+
+  /**
+   * Write a snapshot of every registered metric in the Prometheus text format.
+   */
+  void write(std::ostream& out);
+
+  /**
+   * @return a snapshot of every registered metric in the Prometheus text format.
+   */
+  std::string toPrometheusText();
+
+  /**
+   * Atomically replace the file at path with a snapshot, for collection by the node
+   * exporter's textfile collector.  The snapshot is written to path.tmp and renamed.
+   *
+   * @throws std::system_error if the file cannot be written.
+   */
+  void writeFile(const std::string& path);
+
+  /**
+   * Send a snapshot over a new connection to the Unix stream socket at path.
+   *
+   * @throws std::system_error if the socket cannot be connected or written.
+   */
+  void sendToUnixSocket(const std::string& path);
+
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+};
+
+}
+
+#endif /* __VARONT_METRICSREGISTRY_HPP__ */
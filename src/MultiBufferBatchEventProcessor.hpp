@@ -0,0 +1,259 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_MULTIBUFFERBATCHEVENTPROCESSOR_HPP__
+#define __VARONT_MULTIBUFFERBATCHEVENTPROCESSOR_HPP__
+
+#include <atomic>
+#include <vector>
+#include <new>
+#include <thread>
+#include <stdexcept>
+#include <system_error>
+
+#include "EventProcessor.hpp"
+#include "RingBuffer.hpp"
+#include "SequenceBarrier.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "Sequencer.hpp"
+#include "Sequence.hpp"
+#include "ProcessingOrder.hpp"
+#include "TimeUnit.hpp"
+
+#include "IllegalStateException.hpp"
+#include "FatalExceptionHandler.hpp"
+
+namespace varont {
+
+/**
+ * Drains several {@link RingBuffer}s from one thread, delegating the available events to a
+ * single {@link EventHandler}.  Each {@link RingBuffer} is tracked by its own {@link Sequence},
+ * which must be added to the gating sequences of that {@link RingBuffer}.
+ *
+ * When no {@link RingBuffer} has events available the processor spins, then yields, then
+ * parks through the {@link WaitStrategy} of each {@link RingBuffer} in turn.  Each park is
+ * bounded by PARK_TIMEOUT_MILLIS so that the other {@link RingBuffer}s are re-checked; an
+ * event published to a {@link RingBuffer} other than the one being parked on therefore
+ * waits at most that long.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class MultiBufferBatchEventProcessor
+    : public EventProcessor
+{
+  static const int RETRIES = 200;
+  static const long PARK_TIMEOUT_MILLIS = 1L;
+
+  std::atomic_bool running_;
+
+  FatalExceptionHandler defaultExceptionHandler_;
+  ExceptionHandler* exceptionHandler_;
+
+  std::vector<RingBuffer<T>*> ringBuffers_;
+  std::vector<SequenceBarrier*> sequenceBarriers_;
+  LifecycleAwareEventHandler<T>& eventHandler_;
+  std::vector<Sequence> sequences_;
+  ProcessingOrder order_;
+  std::size_t parkIndex_;
+
+ public:
+  /**
+   * @param ringBuffers to consume, paired by index with sequenceBarriers.
+   * @param sequenceBarriers on which each {@link RingBuffer} is waited on.
+   * @param eventHandler to which events from every {@link RingBuffer} are delegated.
+   * @param order in which the {@link RingBuffer}s are serviced, earlier entries having priority.
+   */
+  MultiBufferBatchEventProcessor(std::vector<RingBuffer<T>*>& ringBuffers,
+                                 std::vector<SequenceBarrier*>& sequenceBarriers,
+                                 LifecycleAwareEventHandler<T>& eventHandler,
+                                 ProcessingOrder order = ProcessingOrder::RoundRobin)
+      : running_(false)
+      , exceptionHandler_(&defaultExceptionHandler_)
+      , ringBuffers_(ringBuffers)
+      , sequenceBarriers_(sequenceBarriers)
+      , eventHandler_(eventHandler)
+      , sequences_(ringBuffers.size(), Sequence(Sequencer::INITIAL_CURSOR_VALUE))
+      , order_(order)
+      , parkIndex_(0)
+  {
+    if (ringBuffers_.size() != sequenceBarriers_.size()) {
+      throw std::out_of_range("there must be one SequenceBarrier per RingBuffer");
+    }
+  }
+
+  /**
+   * Get the {@link Sequence} tracking the {@link RingBuffer} at index.
+   *
+   * @param index of the {@link RingBuffer} as passed to the constructor.
+   * @return the sequence for that {@link RingBuffer}.
+   */
+  Sequence& getSequence(const int index) {
+    return sequences_[index];
+  }
+
+  /**
+   * The processor has no single {@link Sequence}, as each {@link RingBuffer} has its own.
+   *
+   * @throws IllegalStateException always; use getSequence(int) instead.
+   */
+  Sequence& getSequence() {
+    throw IllegalStateException("use getSequence(index) for the sequence of each RingBuffer");
+  }
+
+  void halt() {
+    running_.store(false);
+    for (SequenceBarrier* sequenceBarrier : sequenceBarriers_) {
+      sequenceBarrier->alert();
+    }
+  }
+
+  /**
+   * Set a new ExceptionHandler for handling exceptions propagated out of the processor.
+   */
+  void setExceptionHandler(ExceptionHandler& exceptionHandler) {
+    exceptionHandler_ = &exceptionHandler;
+  }
+
+  /**
+   * It is ok to have another thread rerun this method after a halt().
+   */
+  void operator()() {
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+      throw IllegalStateException("Thread is already running");
+    }
+
+    for (SequenceBarrier* sequenceBarrier : sequenceBarriers_) {
+      sequenceBarrier->clearAlert();
+    }
+
+    notifyStart();
+
+    const std::size_t size = ringBuffers_.size();
+    std::size_t first = 0;
+    int counter = RETRIES;
+
+    while (running_.load()) {
+      bool processed = false;
+
+      for (std::size_t i = 0; i < size; ++i) {
+        const std::size_t index = (first + i) % size;
+        if (processBatch(index)) {
+          processed = true;
+          if (ProcessingOrder::Priority == order_) {
+            break;
+          }
+        }
+      }
+
+      if (ProcessingOrder::RoundRobin == order_) {
+        first = (first + 1) % size;
+      }
+
+      counter = processed ? RETRIES : applyWaitMethod(counter);
+    }
+
+    notifyShutdown();
+
+    running_.store(false);
+  }
+
+ private:
+  /* Returns true if any events were available on the RingBuffer at index. */
+  bool processBatch(const std::size_t index) {
+    Sequence& sequence = sequences_[index];
+    long nextSequence = sequence.get() + 1L;
+    const long availableSequence = sequenceBarriers_[index]->getAvailableSequence();
+
+    if (nextSequence > availableSequence) {
+      return false;
+    }
+
+    RingBuffer<T>& ringBuffer = *ringBuffers_[index];
+    std::error_code error;
+
+    try {
+      while (nextSequence <= availableSequence) {
+        eventHandler_.onEvent(ringBuffer.get(nextSequence), nextSequence, nextSequence == availableSequence, error);
+        if (error) {
+          if (!exceptionHandler_->handleEventError(error, nextSequence)) {
+            running_.store(false);
+            break;
+          }
+          error.clear();
+        }
+        nextSequence++;
+      }
+
+      sequence.set(nextSequence - 1L);
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleEventException(ex, nextSequence);
+      sequence.set(nextSequence);
+    }
+
+    return true;
+  }
+
+  int applyWaitMethod(int counter) {
+    if (counter > 100) {
+      --counter;
+    }
+    else if (counter > 0) {
+      --counter;
+      std::this_thread::yield();
+    }
+    else {
+      park();
+    }
+
+    return counter;
+  }
+
+  /* Waits on the next RingBuffer in turn, returning on its events, an alert or the timeout. */
+  void park() {
+    const std::size_t index = parkIndex_;
+    parkIndex_ = (parkIndex_ + 1) % ringBuffers_.size();
+
+    sequenceBarriers_[index]->waitFor(sequences_[index].get() + 1L, PARK_TIMEOUT_MILLIS,
+                                      TimeUnit::Milliseconds, std::nothrow);
+  }
+
+  void notifyStart() {
+    try {
+      eventHandler_.onStart();
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleOnStartException(ex);
+    }
+  }
+
+  void notifyShutdown() {
+    try {
+      eventHandler_.onShutdown();
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleOnShutdownException(ex);
+    }
+  }
+
+  MultiBufferBatchEventProcessor(const MultiBufferBatchEventProcessor&) = delete;
+  MultiBufferBatchEventProcessor& operator=(const MultiBufferBatchEventProcessor&) = delete;
+};
+
+}
+
+#endif /* __VARONT_MULTIBUFFERBATCHEVENTPROCESSOR_HPP__ */
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_OVERFLOWHANDLER_HPP__
+#define __VARONT_OVERFLOWHANDLER_HPP__
+
+#include "EventTranslator.hpp"
+
+namespace varont {
+
+/**
+ * Receives the events an {@link EventPublisher} with the Redirect policy could not fit
+ * into its {@link RingBuffer}.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class OverflowHandler {
+ public:
+  /**
+   * Called on the publishing thread with the events that did not fit.
+   *
+   * @param translator which would have filled in the events; it may be used to fill in
+   *                   events held elsewhere, passing them n consecutive sequences.
+   * @param n number of events, more than one for a batch.
+   */
+  virtual void onOverflow(EventTranslator<T>& translator, int n) = 0;
+
+ protected:
+  ~OverflowHandler() {}
+};
+
+}
+
+#endif /* __VARONT_OVERFLOWHANDLER_HPP__ */
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PARTITIONEDEVENTPROCESSOR_HPP__
+#define __VARONT_PARTITIONEDEVENTPROCESSOR_HPP__
+
+#include <atomic>
+#include <stdexcept>
+#include <system_error>
+
+#include "RingBuffer.hpp"
+#include "SequenceBarrier.hpp"
+#include "EventProcessor.hpp"
+#include "KeyHasher.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "Sequencer.hpp"
+#include "Sequence.hpp"
+#include "Trace.hpp"
+
+#include "IllegalStateException.hpp"
+#include "FatalExceptionHandler.hpp"
+
+namespace varont {
+
+/**
+ * One of a group of processors sharing the events of a {@link RingBuffer} by key.  The
+ * processor for partition i of n hands its {@link EventHandler} only the events whose key
+ * hashes to i modulo n, so that each key is handled by one thread, in sequence order,
+ * while different keys are handled in parallel.
+ *
+ * Every processor of the group reads every available sequence, advancing over the events
+ * of the other partitions after reading their key, so its {@link Sequence} always reaches
+ * the end of the batch.  The sequences of the group are usually combined in a
+ * {@link SequenceGroup} to gate the {@link RingBuffer}.  The end of batch flag is set on
+ * the last event of the partition within the available batch.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class PartitionedEventProcessor
+    : public EventProcessor
+{
+  std::atomic_bool running_;
+
+  FatalExceptionHandler defaultExceptionHandler_;
+  ExceptionHandler* exceptionHandler_;
+
+  RingBuffer<T>& ringBuffer_;
+  SequenceBarrier& sequenceBarrier_;
+  LifecycleAwareEventHandler<T>& eventHandler_;
+  KeyHasher<T>& keyHasher_;
+  const std::size_t partition_;
+  const std::size_t numPartitions_;
+  Sequence sequence_;
+
+ public:
+  /**
+   * @param ringBuffer to consume.
+   * @param sequenceBarrier on which it is waiting.
+   * @param eventHandler to which the events of this partition are delegated.
+   * @param keyHasher giving the key hash of each event.
+   * @param partition handled by this processor, from 0 to numPartitions - 1.
+   * @param numPartitions in the group.
+   */
+  PartitionedEventProcessor(RingBuffer<T>& ringBuffer, SequenceBarrier& sequenceBarrier,
+                            LifecycleAwareEventHandler<T>& eventHandler, KeyHasher<T>& keyHasher,
+                            const int partition, const int numPartitions)
+      : running_(false)
+      , exceptionHandler_(&defaultExceptionHandler_)
+      , ringBuffer_(ringBuffer)
+      , sequenceBarrier_(sequenceBarrier)
+      , eventHandler_(eventHandler)
+      , keyHasher_(keyHasher)
+      , partition_(partition)
+      , numPartitions_(numPartitions)
+      , sequence_(Sequencer::INITIAL_CURSOR_VALUE)
+  {
+    if (numPartitions < 1 || partition < 0 || partition >= numPartitions) {
+      throw std::out_of_range("partition must be between 0 and numPartitions - 1");
+    }
+  }
+
+  Sequence& getSequence() {
+    return sequence_;
+  }
+
+  void halt() {
+    running_.store(false);
+    sequenceBarrier_.alert();
+  }
+
+  /**
+   * Set a new ExceptionHandler for handling exceptions propagated out of the processor.
+   */
+  void setExceptionHandler(ExceptionHandler& exceptionHandler) {
+    exceptionHandler_ = &exceptionHandler;
+  }
+
+  /**
+   * It is ok to have another thread rerun this method after a halt().
+   */
+  void operator()() {
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+      throw IllegalStateException("Thread is already running");
+    }
+
+    sequenceBarrier_.clearAlert();
+
+    notifyStart();
+
+    std::error_code error;
+    long nextSequence = sequence_.get() + 1L;
+
+    while (true) {
+      const long availableSequence = sequenceBarrier_.waitFor(nextSequence, std::nothrow);
+      if (SequenceBarrier::ALERTED == availableSequence) {
+        if (!running_.load()) {
+          break;
+        }
+        continue;
+      }
+
+      VARONT_TRACE(batch_start, nextSequence, availableSequence);
+      const long lastOwnedSequence = findLastOwned(nextSequence, availableSequence);
+
+      try {
+        while (nextSequence <= lastOwnedSequence) {
+          T& event = ringBuffer_.get(nextSequence);
+          if (isOwned(event)) {
+            eventHandler_.onEvent(event, nextSequence, nextSequence == lastOwnedSequence, error);
+            if (error) {
+              if (!exceptionHandler_->handleEventError(error, nextSequence)) {
+                running_.store(false);
+                break;
+              }
+              error.clear();
+            }
+          }
+          nextSequence++;
+        }
+
+        if (error) {
+          sequence_.set(nextSequence - 1L);
+          break;
+        }
+
+        nextSequence = availableSequence + 1L;
+        sequence_.set(availableSequence);
+        VARONT_TRACE(batch_end, availableSequence, 0);
+      }
+      catch (std::exception& ex) {
+        exceptionHandler_->handleEventException(ex, nextSequence);
+        sequence_.set(nextSequence);
+        nextSequence++;
+      }
+    }
+
+    notifyShutdown();
+
+    running_.store(false);
+  }
+
+  PartitionedEventProcessor(const PartitionedEventProcessor&) = delete;
+  PartitionedEventProcessor& operator=(const PartitionedEventProcessor&) = delete;
+
+ private:
+  bool isOwned(const T& event) {
+    return keyHasher_.hash(event) % numPartitions_ == partition_;
+  }
+
+  /* Returns firstSequence - 1 if none of the events belong to this partition. */
+  long findLastOwned(const long firstSequence, const long lastSequence) {
+    long sequence = lastSequence;
+    while (sequence >= firstSequence && !isOwned(ringBuffer_.get(sequence))) {
+      --sequence;
+    }
+    return sequence;
+  }
+
+  void notifyStart() {
+    try {
+      eventHandler_.onStart();
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleOnStartException(ex);
+    }
+  }
+
+  void notifyShutdown() {
+    try {
+      eventHandler_.onShutdown();
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleOnShutdownException(ex);
+    }
+  }
+};
+
+}
+
+#endif /* __VARONT_PARTITIONEDEVENTPROCESSOR_HPP__ */
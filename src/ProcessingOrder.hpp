@@ -0,0 +1,31 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PROCESSINGORDER_HPP__
+#define __VARONT_PROCESSINGORDER_HPP__
+
+namespace varont {
+  /**
+   * Order in which a single thread services several sources of events.
+   */
+  enum class ProcessingOrder {
+    /** Each source in turn, so that no source is starved. */
+    RoundRobin,
+    /** Always the first source with events available, in the order given. */
+    Priority
+  };
+}
+
+#endif /* __VARONT_PROCESSINGORDER_HPP__ */
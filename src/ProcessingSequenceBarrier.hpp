@@ -21,6 +21,8 @@
 #include "TimeUnit.hpp"
 #include "AlertException.hpp"
 #include "SequenceBarrier.hpp"
+#include "Trace.hpp"
+#include "Util.hpp"
 
 namespace varont {
 
@@ -45,20 +47,54 @@ public:
     , alerted_(false)
   {}
 
-  long waitFor(long sequence) throw(AlertException) {
-    checkAlert();
-    return waitStrategy_.waitFor(sequence, cursorSequence_, dependentSequences_, *this);
+  long waitFor(long sequence) {
+    const long availableSequence = waitFor(sequence, std::nothrow);
+    if (ALERTED == availableSequence) {
+      throw AlertException("");
+    }
+    return availableSequence;
+  }
+
+  long waitFor(long sequence, long timeout, TimeUnit units) {
+    const long availableSequence = waitFor(sequence, timeout, units, std::nothrow);
+    if (ALERTED == availableSequence) {
+      throw AlertException("");
+    }
+    return availableSequence;
   }
 
-  long waitFor(long sequence, long timeout, TimeUnit units) throw(AlertException) {
-    checkAlert();
-    return waitStrategy_.waitFor(sequence, cursorSequence_, dependentSequences_, *this, timeout, units);
+  long waitFor(long sequence, const std::nothrow_t&) {
+    if (alerted_) {
+      return ALERTED;
+    }
+    VARONT_TRACE(wait_for_entry, sequence, 0);
+    const long availableSequence = waitStrategy_.waitFor(sequence, cursorSequence_, dependentSequences_, *this);
+    VARONT_TRACE(wait_for_exit, sequence, availableSequence);
+    return availableSequence;
+  }
+
+  long waitFor(long sequence, long timeout, TimeUnit units, const std::nothrow_t&) {
+    if (alerted_) {
+      return ALERTED;
+    }
+    VARONT_TRACE(wait_for_entry, sequence, 0);
+    const long availableSequence = waitStrategy_.waitFor(sequence, cursorSequence_, dependentSequences_, *this,
+                                                         timeout, units);
+    VARONT_TRACE(wait_for_exit, sequence, availableSequence);
+    return availableSequence;
   }
 
   long getCursor() {
     return cursorSequence_.get();
   }
 
+  long getAvailableSequence() {
+    if (dependentSequences_.empty()) {
+      return cursorSequence_.get();
+    }
+    return util::getMinimumSequence(dependentSequences_);
+  }
+
   bool isAlerted() {
     return alerted_;
   }
@@ -72,7 +108,7 @@ public:
     alerted_ = false;
   }
 
-  void checkAlert() throw(AlertException) {
+  void checkAlert() {
     if (alerted_) {
       throw AlertException("");
     }
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+#include <poll.h>
+
+#include "ProcessorScheduler.hpp"
+#include "IllegalStateException.hpp"
+
+namespace varont {
+
+ProcessorScheduler::ProcessorScheduler(const int quantum, const ProcessingOrder order)
+  : running_(false)
+  , quantum_(quantum)
+  , order_(order)
+  , parkable_(true)
+{
+  if (quantum < 1) {
+    throw std::out_of_range("quantum must be greater than 0");
+  }
+}
+
+void ProcessorScheduler::add(ScheduledProcessor& processor) {
+  processors_.push_back(&processor);
+  parkable_ = false;
+}
+
+void ProcessorScheduler::add(ScheduledProcessor& processor, EventFdWaitStrategy& waitStrategy) {
+  processors_.push_back(&processor);
+  if (waitStrategies_.end() == std::find(waitStrategies_.begin(), waitStrategies_.end(), &waitStrategy)) {
+    waitStrategies_.push_back(&waitStrategy);
+  }
+}
+
+void ProcessorScheduler::halt() {
+  running_.store(false);
+  for (ScheduledProcessor* processor : processors_) {
+    processor->getSequenceBarrier().alert();
+  }
+}
+
+void ProcessorScheduler::operator()() {
+  if (processors_.empty()) {
+    throw IllegalStateException("No processors have been added");
+  }
+
+  bool expected = false;
+  if (!running_.compare_exchange_strong(expected, true)) {
+    throw IllegalStateException("Thread is already running");
+  }
+
+  for (ScheduledProcessor* processor : processors_) {
+    processor->getSequenceBarrier().clearAlert();
+    processor->notifyStart();
+  }
+
+  int counter = RETRIES;
+
+  while (running_.load()) {
+    if (0 != processPass()) {
+      counter = RETRIES;
+    }
+    else if (parkable_ && !isWaitingForDependents()) {
+      park();
+    }
+    else {
+      counter = backOff(counter);
+    }
+  }
+
+  for (ScheduledProcessor* processor : processors_) {
+    processor->notifyShutdown();
+  }
+
+  running_.store(false);
+}
+
+int ProcessorScheduler::processPass() {
+  int processed = 0;
+
+  for (ScheduledProcessor* processor : processors_) {
+    processed += processor->process(quantum_);
+    if (0 != processed && ProcessingOrder::Priority == order_) {
+      break;
+    }
+  }
+
+  return processed;
+}
+
+int ProcessorScheduler::backOff(int counter) {
+  if (counter > 100) {
+    --counter;
+  }
+  else if (counter > 0) {
+    --counter;
+    std::this_thread::yield();
+  }
+  else {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(1L));
+  }
+
+  return counter;
+}
+
+bool ProcessorScheduler::isWaitingForDependents() {
+  for (ScheduledProcessor* processor : processors_) {
+    SequenceBarrier& barrier = processor->getSequenceBarrier();
+    if (barrier.getAvailableSequence() < barrier.getCursor()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ProcessorScheduler::park() {
+  for (EventFdWaitStrategy* waitStrategy : waitStrategies_) {
+    waitStrategy->beginSleep();
+  }
+
+  /* Events published before the announcement would not have signalled the eventfds. */
+  if (0 == processPass() && running_.load() && !isWaitingForDependents()) {
+    std::vector<struct pollfd> pfds;
+    for (EventFdWaitStrategy* waitStrategy : waitStrategies_) {
+      pfds.push_back({ waitStrategy->getFd(), POLLIN, 0 });
+    }
+    ::poll(pfds.data(), pfds.size(), POLL_TIMEOUT_MILLIS);
+  }
+
+  for (EventFdWaitStrategy* waitStrategy : waitStrategies_) {
+    waitStrategy->endSleep();
+  }
+}
+
+}
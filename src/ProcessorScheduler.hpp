@@ -0,0 +1,102 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PROCESSORSCHEDULER_HPP__
+#define __VARONT_PROCESSORSCHEDULER_HPP__
+
+#include <atomic>
+#include <vector>
+
+#include "EventFdWaitStrategy.hpp"
+#include "ProcessingOrder.hpp"
+#include "ScheduledProcessor.hpp"
+
+namespace varont {
+
+/**
+ * Runs several {@link ScheduledProcessor}s on one thread, so that mostly idle stages of a
+ * pipeline need not each own a thread.
+ *
+ * Every pass over the units lets each handle up to a quantum of its available events,
+ * either in turn or, in priority order, starting again from the first unit after any unit
+ * has handled events.  When a whole pass finds no events the thread backs off by spinning,
+ * then yielding, then sleeping.  If every unit was added with the
+ * {@link EventFdWaitStrategy} of its {@link RingBuffer} the thread instead sleeps in one
+ * poll on all of their eventfds, and is woken by the first publish to any of them.
+ * Processors advancing do not signal the eventfds, so while a unit has published events
+ * it is waiting for dependent processors to handle, the thread backs off instead.
+ *
+ * Units must be added before the scheduler is started.
+ */
+class ProcessorScheduler {
+  static const int RETRIES = 200;
+  static const int POLL_TIMEOUT_MILLIS = 10;
+
+  std::atomic_bool running_;
+  const int quantum_;
+  const ProcessingOrder order_;
+  std::vector<ScheduledProcessor*> processors_;
+  std::vector<EventFdWaitStrategy*> waitStrategies_;
+  bool parkable_;
+
+ public:
+  /**
+   * @param quantum largest number of events a unit handles before the next unit is serviced.
+   * @param order in which the units are serviced, earlier units having priority.
+   */
+  ProcessorScheduler(const int quantum = 64, const ProcessingOrder order = ProcessingOrder::RoundRobin);
+
+  /**
+   * Add a unit which is waited for by backing off.
+   *
+   * @param processor to run.
+   */
+  void add(ScheduledProcessor& processor);
+
+  /**
+   * Add a unit whose {@link RingBuffer} signals the given strategy when publishing.  While
+   * the unit waits for dependent processors rather than for a publish, the scheduler backs
+   * off, spinning then yielding then sleeping, instead of sleeping in poll.
+   *
+   * @param processor to run.
+   * @param waitStrategy of the {@link RingBuffer} the processor consumes from.
+   */
+  void add(ScheduledProcessor& processor, EventFdWaitStrategy& waitStrategy);
+
+  /**
+   * Stop the scheduler thread once the current pass is complete.
+   */
+  void halt();
+
+  /**
+   * It is ok to have another thread rerun this method after a halt().
+   */
+  void operator()();
+
+  ProcessorScheduler(const ProcessorScheduler&) = delete;
+  ProcessorScheduler& operator=(const ProcessorScheduler&) = delete;
+
+ private:
+  /* Returns the number of events handled by a pass over the units. */
+  int processPass();
+  int backOff(int counter);
+  /* Returns true if a unit has published events that its dependent processors have not yet handled. */
+  bool isWaitingForDependents();
+  void park();
+};
+
+}
+
+#endif /* __VARONT_PROCESSORSCHEDULER_HPP__ */
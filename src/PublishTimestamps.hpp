@@ -0,0 +1,87 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_PUBLISHTIMESTAMPS_HPP__
+#define __VARONT_PUBLISHTIMESTAMPS_HPP__
+
+#include <atomic>
+#include <stdexcept>
+
+#include "Util.hpp"
+
+namespace varont {
+
+/**
+ * Side array, parallel to the entries of a {@link RingBuffer}, holding the time at which each
+ * sequence was published.  Attach to a {@link Sequencer} with setPublishTimestamps().
+ */
+class PublishTimestamps {
+  const int indexMask_;
+  std::atomic_long* timestamps_;
+
+public:
+  /**
+   * @param bufferSize of the {@link RingBuffer} being stamped, which must be a power of 2.
+   */
+  PublishTimestamps(const int bufferSize)
+    : indexMask_(bufferSize - 1)
+    , timestamps_(nullptr)
+  {
+    if (util::bitCount(bufferSize) != 1) {
+      throw std::out_of_range("bufferSize must be a power of 2");
+    }
+
+    timestamps_ = new std::atomic_long[bufferSize];
+    for (int i = 0; i < bufferSize; ++i) {
+      timestamps_[i].store(0L, std::memory_order_relaxed);
+    }
+  }
+
+  ~PublishTimestamps() {
+    delete [] timestamps_;
+  }
+
+  /**
+   * Stamp a batch of sequences ending at sequence.  Called by the {@link Sequencer} before
+   * the batch is made visible, so the stamp is ordered before the cursor update.
+   *
+   * @param sequence last in the batch.
+   * @param batchSize of the batch.
+   * @param timestamp in nanoseconds, as returned by util::nanoTime().
+   */
+  void stamp(const long sequence, const int batchSize, const long timestamp) {
+    for (long s = sequence - batchSize + 1L; s <= sequence; ++s) {
+      timestamps_[(int)s & indexMask_].store(timestamp, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Get the time at which a sequence was published.  Only valid while the sequence has not
+   * been overwritten, that is while it is held by a gating sequence.
+   *
+   * @param sequence to look up.
+   * @return the publish time in nanoseconds.
+   */
+  long get(const long sequence) const {
+    return timestamps_[(int)sequence & indexMask_].load(std::memory_order_relaxed);
+  }
+
+  PublishTimestamps(const PublishTimestamps&) = delete;
+  PublishTimestamps& operator=(const PublishTimestamps&) = delete;
+};
+
+}
+
+#endif /* __VARONT_PUBLISHTIMESTAMPS_HPP__ */
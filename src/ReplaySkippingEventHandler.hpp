@@ -0,0 +1,73 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_REPLAYSKIPPINGEVENTHANDLER_HPP__
+#define __VARONT_REPLAYSKIPPINGEVENTHANDLER_HPP__
+
+#include <system_error>
+
+#include "LifecycleAwareEventHandler.hpp"
+#include "Sequence.hpp"
+
+namespace varont {
+
+/**
+ * Passes on only the events published after a replay, so that handlers with effects
+ * outside the process, such as journalling or sending output, are not repeated when a
+ * {@link JournalReplayer} restores state.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class ReplaySkippingEventHandler
+    : public LifecycleAwareEventHandler<T>
+{
+  LifecycleAwareEventHandler<T>& eventHandler_;
+  Sequence& replayedSequence_;
+
+ public:
+  /**
+   * @param eventHandler to receive the live events.
+   * @param replayedSequence from {@link JournalReplayer#getReplayedSequence()}.
+   */
+  ReplaySkippingEventHandler(LifecycleAwareEventHandler<T>& eventHandler, Sequence& replayedSequence)
+      : eventHandler_(eventHandler)
+      , replayedSequence_(replayedSequence)
+  {}
+
+  void onEvent(T& event, long sequence, bool endOfBatch) {
+    if (sequence > replayedSequence_.get()) {
+      eventHandler_.onEvent(event, sequence, endOfBatch);
+    }
+  }
+
+  void onEvent(T& event, long sequence, bool endOfBatch, std::error_code& error) {
+    if (sequence > replayedSequence_.get()) {
+      eventHandler_.onEvent(event, sequence, endOfBatch, error);
+    }
+  }
+
+  void onStart() {
+    eventHandler_.onStart();
+  }
+
+  void onShutdown() {
+    eventHandler_.onShutdown();
+  }
+};
+
+}
+
+#endif /* __VARONT_REPLAYSKIPPINGEVENTHANDLER_HPP__ */
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SCHEDULEDEVENTPROCESSOR_HPP__
+#define __VARONT_SCHEDULEDEVENTPROCESSOR_HPP__
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#include "RingBuffer.hpp"
+#include "SequenceBarrier.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "ScheduledProcessor.hpp"
+#include "Sequencer.hpp"
+#include "Sequence.hpp"
+#include "Trace.hpp"
+
+#include "FatalExceptionHandler.hpp"
+
+namespace varont {
+
+/**
+ * Counterpart of the {@link BatchEventProcessor} for running on a {@link ProcessorScheduler}.
+ * Each call to process hands the {@link EventHandler} at most a quantum of the available
+ * events, the last of which is flagged as the end of the batch.
+ *
+ * If the {@link ExceptionHandler} declines to continue after an error the processor stops
+ * handling events, leaving the other units of its scheduler running.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class ScheduledEventProcessor
+    : public ScheduledProcessor
+{
+  FatalExceptionHandler defaultExceptionHandler_;
+  ExceptionHandler* exceptionHandler_;
+
+  RingBuffer<T>& ringBuffer_;
+  SequenceBarrier& sequenceBarrier_;
+  LifecycleAwareEventHandler<T>& eventHandler_;
+  Sequence sequence_;
+  bool stopped_;
+
+ public:
+  ScheduledEventProcessor(RingBuffer<T>& ringBuffer, SequenceBarrier& sequenceBarrier,
+                          LifecycleAwareEventHandler<T>& eventHandler)
+      : exceptionHandler_(&defaultExceptionHandler_)
+      , ringBuffer_(ringBuffer)
+      , sequenceBarrier_(sequenceBarrier)
+      , eventHandler_(eventHandler)
+      , sequence_(Sequencer::INITIAL_CURSOR_VALUE)
+      , stopped_(false)
+  {}
+
+  Sequence& getSequence() {
+    return sequence_;
+  }
+
+  /**
+   * Set a new ExceptionHandler for handling exceptions propagated out of the processor.
+   */
+  void setExceptionHandler(ExceptionHandler& exceptionHandler) {
+    exceptionHandler_ = &exceptionHandler;
+  }
+
+  SequenceBarrier& getSequenceBarrier() {
+    return sequenceBarrier_;
+  }
+
+  int process(const int quantum) {
+    long nextSequence = sequence_.get() + 1L;
+    const long availableSequence = sequenceBarrier_.getAvailableSequence();
+
+    if (stopped_ || nextSequence > availableSequence) {
+      return 0;
+    }
+
+    const long lastSequence = std::min(availableSequence, nextSequence + quantum - 1L);
+    const long firstSequence = nextSequence;
+    std::error_code error;
+
+    VARONT_TRACE(batch_start, nextSequence, lastSequence);
+    try {
+      while (nextSequence <= lastSequence) {
+        eventHandler_.onEvent(ringBuffer_.get(nextSequence), nextSequence, nextSequence == lastSequence, error);
+        if (error) {
+          if (!exceptionHandler_->handleEventError(error, nextSequence)) {
+            stopped_ = true;
+            break;
+          }
+          error.clear();
+        }
+        nextSequence++;
+      }
+
+      sequence_.set(nextSequence - 1L);
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleEventException(ex, nextSequence);
+      sequence_.set(nextSequence);
+      nextSequence++;
+    }
+    VARONT_TRACE(batch_end, nextSequence - 1L, 0);
+
+    return (int)(nextSequence - firstSequence);
+  }
+
+  void notifyStart() {
+    try {
+      eventHandler_.onStart();
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleOnStartException(ex);
+    }
+  }
+
+  void notifyShutdown() {
+    try {
+      eventHandler_.onShutdown();
+    }
+    catch (std::exception& ex) {
+      exceptionHandler_->handleOnShutdownException(ex);
+    }
+  }
+
+  ScheduledEventProcessor(const ScheduledEventProcessor&) = delete;
+  ScheduledEventProcessor& operator=(const ScheduledEventProcessor&) = delete;
+};
+
+}
+
+#endif /* __VARONT_SCHEDULEDEVENTPROCESSOR_HPP__ */
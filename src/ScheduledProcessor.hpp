@@ -0,0 +1,58 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SCHEDULEDPROCESSOR_HPP__
+#define __VARONT_SCHEDULEDPROCESSOR_HPP__
+
+#include "SequenceBarrier.hpp"
+
+namespace varont {
+
+/**
+ * Unit of event processing run by a {@link ProcessorScheduler} on a thread it shares with
+ * other units, in place of an {@link EventProcessor} owning a thread.
+ */
+class ScheduledProcessor {
+ public:
+  /**
+   * Handle the events available without waiting, up to a quantum.
+   *
+   * @param quantum largest number of events to handle.
+   * @return the number of events handled, 0 if none were available.
+   */
+  virtual int process(const int quantum) = 0;
+
+  /**
+   * Get the barrier the unit consumes through, alerted when the scheduler is halted.
+   */
+  virtual SequenceBarrier& getSequenceBarrier() = 0;
+
+  /**
+   * Called on the scheduler thread before the first call to process.
+   */
+  virtual void notifyStart() = 0;
+
+  /**
+   * Called on the scheduler thread after the last call to process.
+   */
+  virtual void notifyShutdown() = 0;
+
+ protected:
+  ~ScheduledProcessor() {}
+};
+
+}
+
+#endif /* __VARONT_SCHEDULEDPROCESSOR_HPP__ */
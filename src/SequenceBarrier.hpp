@@ -16,6 +16,9 @@
 #ifndef __VARONT_SEQUENCEBARRIER_HPP__
 #define __VARONT_SEQUENCEBARRIER_HPP__
 
+#include <climits>
+#include <new>
+
 #include "TimeUnit.hpp"
 #include "AlertException.hpp"
 
@@ -27,6 +30,12 @@ namespace varont {
  */
 class SequenceBarrier {
 public:
+  /**
+   * Returned by the non-throwing variants of waitFor in place of an
+   * available sequence when the barrier has been alerted.
+   */
+  static const long ALERTED = LONG_MIN;
+
   /**
    * Wait for the given sequence to be available for consumption.
    *
@@ -35,7 +44,7 @@ public:
    * @throws AlertException if a status change has occurred for the Disruptor
    * @throws InterruptedException if the thread needs awaking on a condition variable.
    */
-  virtual long waitFor(long sequence) throw(AlertException) = 0;
+  virtual long waitFor(long sequence) = 0;
 
   /**
    * Wait for the given sequence to be available for consumption with a time out.
@@ -47,7 +56,27 @@ public:
    * @throws AlertException if a status change has occurred for the Disruptor
    * @throws InterruptedException if the thread needs awaking on a condition variable.
    */
-  virtual long waitFor(long sequence, long timeout, TimeUnit units) throw(AlertException) = 0;
+  virtual long waitFor(long sequence, long timeout, TimeUnit units) = 0;
+
+  /**
+   * Wait for the given sequence to be available for consumption without
+   * raising an {@link AlertException}.
+   *
+   * @param sequence to wait for
+   * @return the sequence up to which is available or ALERTED if a status change has occurred.
+   */
+  virtual long waitFor(long sequence, const std::nothrow_t&) = 0;
+
+  /**
+   * Wait for the given sequence to be available for consumption with a
+   * time out, without raising an {@link AlertException}.
+   *
+   * @param sequence to wait for
+   * @param timeout value
+   * @param units for the timeout value
+   * @return the sequence up to which is available or ALERTED if a status change has occurred.
+   */
+  virtual long waitFor(long sequence, long timeout, TimeUnit units, const std::nothrow_t&) = 0;
 
   /**
    * Delegate a call to the {@link Sequencer#getCursor()}
@@ -56,6 +85,13 @@ public:
    */
   virtual long getCursor() = 0;
 
+  /**
+   * Get the highest sequence available for consumption without waiting.
+   *
+   * @return the sequence up to which is available, which may be lower than the next sequence required.
+   */
+  virtual long getAvailableSequence() = 0;
+
   /**
    * The current alert status for the barrier.
    *
@@ -78,7 +114,7 @@ public:
    *
    * @throws AlertException if alert has been raised.
    */
-  virtual void checkAlert() throw(AlertException) = 0;
+  virtual void checkAlert() = 0;
 };
 
 }
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SEQUENCEGROUP_HPP__
+#define __VARONT_SEQUENCEGROUP_HPP__
+
+#include <vector>
+
+#include "Sequence.hpp"
+#include "Sequencer.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+/**
+ * {@link Sequence} standing for a group of others, such as those of the processors of a
+ * partitioned consumer group, so that the group can gate a {@link RingBuffer} or a
+ * dependent {@link SequenceBarrier} as a single sequence.
+ *
+ * Its value is the minimum of the members.  The members must all be added before the
+ * group is used.
+ */
+class SequenceGroup
+  : public Sequence
+{
+  std::vector<Sequence*> sequences_;
+
+public:
+  SequenceGroup()
+    : Sequence(Sequencer::INITIAL_CURSOR_VALUE)
+  {}
+
+  SequenceGroup(std::vector<Sequence*>& sequences)
+    : Sequence(Sequencer::INITIAL_CURSOR_VALUE)
+    , sequences_(sequences)
+  {}
+
+  SequenceGroup(std::vector<Sequence*>&& sequences)
+    : Sequence(Sequencer::INITIAL_CURSOR_VALUE)
+    , sequences_(sequences)
+  {}
+
+  /**
+   * Add a member to the group.
+   *
+   * @param sequence to add.
+   */
+  void add(Sequence& sequence) {
+    sequences_.push_back(&sequence);
+  }
+
+  /**
+   * Get the number of members of the group.
+   */
+  int size() const {
+    return (int)sequences_.size();
+  }
+
+  /**
+   * Get the minimum of the members, or Sequencer::INITIAL_CURSOR_VALUE for an empty group.
+   */
+  long get() {
+    return sequences_.empty() ? (long)Sequencer::INITIAL_CURSOR_VALUE : util::getMinimumSequence(sequences_);
+  }
+
+  /**
+   * Set every member to value.
+   */
+  void set(const long value) {
+    for (Sequence* sequence : sequences_) {
+      sequence->set(value);
+    }
+  }
+};
+
+}
+
+#endif /* __VARONT_SEQUENCEGROUP_HPP__ */
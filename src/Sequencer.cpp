@@ -19,6 +19,8 @@
 #include "BatchDescriptor.hpp"
 #include "SequenceBarrier.hpp"
 #include "ProcessingSequenceBarrier.hpp"
+#include "PublishTimestamps.hpp"
+#include "Trace.hpp"
 #include "Util.hpp"
 
 namespace varont {
@@ -60,10 +62,26 @@ long Sequencer::next() {
     throw std::out_of_range("gatingSequences must be set before claiming sequences");
   }
 
-  return claimStrategy_.incrementAndGet(gatingSequences_);
+  const long sequence = claimStrategy_.incrementAndGet(gatingSequences_);
+  VARONT_TRACE(next, sequence, 1);
+  return sequence;
 }
 
-long Sequencer::tryNext(const int availableCapacity) throw(InsufficientCapacityException, std::out_of_range) {
+long Sequencer::next(const int n) {
+  if (gatingSequences_.empty()) {
+    throw std::out_of_range("gatingSequences must be set before claiming sequences");
+  }
+
+  if (n < 1 || n > claimStrategy_.getBufferSize()) {
+    throw std::out_of_range("n must be greater than 0 and no greater than the buffer size");
+  }
+
+  const long sequence = claimStrategy_.incrementAndGet(n, gatingSequences_);
+  VARONT_TRACE(next, sequence, n);
+  return sequence;
+}
+
+long Sequencer::tryNext(const int availableCapacity) {
   if (gatingSequences_.empty()) {
     throw std::out_of_range("gatingSequences must be set before claiming sequences");
   }
@@ -75,12 +93,45 @@ long Sequencer::tryNext(const int availableCapacity) throw(InsufficientCapacityE
   return claimStrategy_.checkAndIncrement(availableCapacity, 1, gatingSequences_);
 }
 
+long Sequencer::tryNext(const int availableCapacity, const std::nothrow_t&) {
+  if (gatingSequences_.empty()) {
+    throw std::out_of_range("gatingSequences must be set before claiming sequences");
+  }
+
+  if (availableCapacity < 1) {
+    throw std::out_of_range("Available capacity must be greater than 0");
+  }
+
+  const long sequence = claimStrategy_.checkAndIncrement(availableCapacity, 1, gatingSequences_, std::nothrow);
+  if (INSUFFICIENT_CAPACITY != sequence) {
+    VARONT_TRACE(next, sequence, 1);
+  }
+  return sequence;
+}
+
+bool Sequencer::tryNext(BatchDescriptor& batchDescriptor, const std::nothrow_t&) {
+  if (gatingSequences_.empty()) {
+    throw std::out_of_range("gatingSequences must be set before claiming sequences");
+  }
+
+  const int size = batchDescriptor.getSize();
+  const long sequence = claimStrategy_.checkAndIncrement(size, size, gatingSequences_, std::nothrow);
+  if (INSUFFICIENT_CAPACITY == sequence) {
+    return false;
+  }
+
+  VARONT_TRACE(next, sequence, size);
+  batchDescriptor.setEnd(sequence);
+  return true;
+}
+
 BatchDescriptor& Sequencer::next(BatchDescriptor& batchDescriptor) {
   if (gatingSequences_.empty()) {
     throw std::out_of_range("gatingSequences must be set before claiming sequences");
   }
 
   const long sequence = claimStrategy_.incrementAndGet(batchDescriptor.getSize(), gatingSequences_);
+  VARONT_TRACE(next, sequence, batchDescriptor.getSize());
   batchDescriptor.setEnd(sequence);
   return batchDescriptor;
 }
@@ -109,12 +160,20 @@ void Sequencer::publish(std::unique_ptr<BatchDescriptor>& batchDescriptor) {
 }
 
 void Sequencer::forcePublish(const long sequence) {
+  if (nullptr != publishTimestamps_) {
+    publishTimestamps_->stamp(sequence, 1, util::nanoTime());
+  }
   cursor_.set(sequence);
+  VARONT_TRACE(publish, sequence, 1);
   waitStrategy_.signalAllWhenBlocking();
 }
 
 void Sequencer::publish(const long sequence, const int batchSize) {
+  if (nullptr != publishTimestamps_) {
+    publishTimestamps_->stamp(sequence, batchSize, util::nanoTime());
+  }
   claimStrategy_.serialisePublishing(sequence, cursor_, batchSize);
+  VARONT_TRACE(publish, sequence, batchSize);
   waitStrategy_.signalAllWhenBlocking();
 }
 
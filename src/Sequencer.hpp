@@ -26,6 +26,7 @@
 namespace varont {
 class BatchDescriptor;
 class ProcessingSequenceBarrier;
+class PublishTimestamps;
 
 /**
  * Coordinator for claiming sequences for access to a data strcuture
@@ -37,9 +38,16 @@ class Sequencer {
 
   ClaimStrategy& claimStrategy_;
   WaitStrategy& waitStrategy_;
+  PublishTimestamps* publishTimestamps_;
 public:
   static const long INITIAL_CURSOR_VALUE = -1L;
 
+  /**
+   * Returned by the non-throwing variants of tryNext in place of a sequence when the
+   * buffer does not have the capacity requested.
+   */
+  static const long INSUFFICIENT_CAPACITY = ClaimStrategy::INSUFFICIENT_CAPACITY;
+
   /**
    * Construct a Sequencer with the selected strategies.
    *
@@ -50,6 +58,7 @@ public:
     : cursor_(INITIAL_CURSOR_VALUE)
     , claimStrategy_(claimStrategy)
     , waitStrategy_(waitStrategy)
+    , publishTimestamps_(nullptr)
   {}
 
   /**
@@ -64,6 +73,24 @@ public:
 
   void setGatingSequences(std::vector<Sequence*>&& sequences);
 
+  /**
+   * Record the time at which every sequence is published, for measuring latency downstream.
+   *
+   * XXX: This method must be called before publishing begins.
+   *
+   * @param publishTimestamps sized to the buffer size, or nullptr to stop stamping.
+   */
+  void setPublishTimestamps(PublishTimestamps* publishTimestamps) {
+    publishTimestamps_ = publishTimestamps;
+  }
+
+  /**
+   * @return the publish timestamps set with setPublishTimestamps, or nullptr.
+   */
+  PublishTimestamps* getPublishTimestamps() {
+    return publishTimestamps_;
+  }
+
   /**
    * Create a {@link SequenceBarrier} that gates on the the cursor and a list of {@link Sequence}s
    *
@@ -126,7 +153,34 @@ public:
    * @return the claimed sequence value
    * @throws InsufficientCapacityException
    */
-  long tryNext(const int availableCapacity) throw(InsufficientCapacityException, std::out_of_range);
+  long tryNext(const int availableCapacity);
+
+  /**
+   * Attempt to claim the next event in sequence for publishing without raising an
+   * {@link InsufficientCapacityException}, which is costly when the buffer is full.
+   *
+   * @param availableCapacity slots that must be available.
+   * @return the claimed sequence value or INSUFFICIENT_CAPACITY.
+   */
+  long tryNext(const int availableCapacity, const std::nothrow_t&);
+
+  /**
+   * Attempt to claim a batch of sequences for publishing, if the buffer has room for all
+   * of them, without raising an {@link InsufficientCapacityException}.
+   *
+   * @param batchDescriptor to be updated for the batch range.
+   * @return true if the batch was claimed, false if the buffer did not have the capacity.
+   */
+  bool tryNext(BatchDescriptor& batchDescriptor, const std::nothrow_t&);
+
+  /**
+   * Claim the next n sequences for publishing, to be published together with
+   * publish(sequence, n).
+   *
+   * @param n number of sequences to claim, no greater than the buffer size.
+   * @return the last of the claimed sequences.
+   */
+  long next(const int n);
 
   /**
    * Claim the next batch of sequence numbers for publishing.
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SharedMemory.hpp"
+
+namespace varont {
+
+namespace {
+
+void* map(const int fd, const std::size_t size, const std::string& name) {
+  void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (MAP_FAILED == address) {
+    throw std::system_error(errno, std::system_category(), "mmap " + name);
+  }
+  return address;
+}
+
+}
+
+SharedMemory* SharedMemory::create(const std::string& name, const std::size_t size) {
+  const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (-1 == fd) {
+    throw std::system_error(errno, std::system_category(), "shm_open " + name);
+  }
+
+  void* address = nullptr;
+  try {
+    if (-1 == ::ftruncate(fd, (off_t)size)) {
+      throw std::system_error(errno, std::system_category(), "ftruncate " + name);
+    }
+    address = map(fd, size, name);
+  }
+  catch (...) {
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    throw;
+  }
+
+  ::close(fd);
+  return new SharedMemory(name, size, address, true);
+}
+
+SharedMemory* SharedMemory::attach(const std::string& name) {
+  SharedMemory* memory = tryAttach(name, 0);
+  if (nullptr == memory) {
+    throw std::system_error(ENOENT, std::system_category(), "shm_open " + name);
+  }
+  return memory;
+}
+
+SharedMemory* SharedMemory::tryAttach(const std::string& name, const std::size_t minimumSize) {
+  const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (-1 == fd) {
+    if (ENOENT == errno) {
+      return nullptr;
+    }
+    throw std::system_error(errno, std::system_category(), "shm_open " + name);
+  }
+
+  void* address = nullptr;
+  struct stat status;
+  try {
+    if (-1 == ::fstat(fd, &status)) {
+      throw std::system_error(errno, std::system_category(), "fstat " + name);
+    }
+
+    /* The creator has not yet sized the object. */
+    if ((std::size_t)status.st_size < minimumSize) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    address = map(fd, (std::size_t)status.st_size, name);
+  }
+  catch (...) {
+    ::close(fd);
+    throw;
+  }
+
+  ::close(fd);
+  return new SharedMemory(name, (std::size_t)status.st_size, address, false);
+}
+
+SharedMemory::~SharedMemory() {
+  ::munmap(address_, size_);
+  if (owner_) {
+    ::shm_unlink(name_.c_str());
+  }
+}
+
+}
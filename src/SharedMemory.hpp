@@ -0,0 +1,94 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SHAREDMEMORY_HPP__
+#define __VARONT_SHAREDMEMORY_HPP__
+
+#include <cstddef>
+#include <string>
+
+namespace varont {
+
+/**
+ * POSIX shared memory object mapped into the process.  The creator of an object unlinks
+ * its name when destroyed; processes already attached keep their mapping.
+ */
+class SharedMemory {
+  std::string name_;
+  std::size_t size_;
+  void* address_;
+  bool owner_;
+
+public:
+  /**
+   * Create and map a new zero filled shared memory object.
+   *
+   * @param name of the object, starting with '/'.
+   * @param size in bytes.
+   * @throws std::system_error if the object exists or cannot be created.
+   */
+  static SharedMemory* create(const std::string& name, const std::size_t size);
+
+  /**
+   * Map an existing shared memory object at its full size.
+   *
+   * @param name of the object, starting with '/'.
+   * @throws std::system_error if the object does not exist or cannot be mapped.
+   */
+  static SharedMemory* attach(const std::string& name);
+
+  /**
+   * Map an existing shared memory object at its full size once its creator has sized it.
+   *
+   * @param name of the object, starting with '/'.
+   * @param minimumSize below which the object is taken to be still being created.
+   * @return the mapped object, or nullptr if it does not exist or is smaller than minimumSize.
+   * @throws std::system_error if the object cannot be opened or mapped.
+   */
+  static SharedMemory* tryAttach(const std::string& name, const std::size_t minimumSize);
+
+  ~SharedMemory();
+
+  const std::string& getName() const {
+    return name_;
+  }
+
+  std::size_t getSize() const {
+    return size_;
+  }
+
+  void* getAddress() const {
+    return address_;
+  }
+
+  bool isOwner() const {
+    return owner_;
+  }
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+private:
+  SharedMemory(const std::string& name, const std::size_t size, void* address, const bool owner)
+    : name_(name)
+    , size_(size)
+    , address_(address)
+    , owner_(owner)
+  {}
+};
+
+}
+
+#endif /* __VARONT_SHAREDMEMORY_HPP__ */
@@ -0,0 +1,477 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SHAREDMEMORYRINGBUFFER_HPP__
+#define __VARONT_SHAREDMEMORYRINGBUFFER_HPP__
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include "SharedMemory.hpp"
+#include "TimeUnit.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+/**
+ * Ring buffer of fixed layout events shared between processes through a POSIX shared
+ * memory object.
+ *
+ * The segment holds a header, the cursor and claim sequences, a table of consumer
+ * sequences and the entries, so that any number of processes may publish and consume.
+ * One process creates the segment and the others attach to it by name, waiting for the
+ * creator to create and lay it out; the creator unlinks the name when its instance is
+ * destroyed.
+ *
+ * Publishers claim with next(), fill the entry and publish(), which waits for earlier
+ * claims to be published, as with the {@link MultiThreadedLowContentionClaimStrategy}.
+ * Each consumer registers for a slot in the consumer table, advances its sequence as it
+ * consumes, and gates publishers from wrapping the buffer.  With no consumers registered
+ * publishers overwrite unconsumed entries.  A publisher held up by a consumer checks
+ * whether the process that registered it is still running, and frees the slot of a
+ * process that has exited; processes must therefore share a pid namespace.
+ *
+ * Waiting spins, yields and then sleeps, as no process can signal another's condition
+ * variable.  A publisher that dies between claiming and publishing stalls every other
+ * publisher.
+ *
+ * @param <T> trivially copyable event, whose layout must be identical in every process.
+ */
+template <typename T>
+class SharedMemoryRingBuffer {
+  static_assert(std::is_trivially_copyable<T>::value, "events in shared memory must be trivially copyable");
+  static_assert(ATOMIC_LONG_LOCK_FREE == 2, "sequences in shared memory must be lock free");
+
+public:
+  static const uint64_t MAGIC = 0x564152304e5452ULL; /* "VAR0NTR" */
+  static const uint32_t VERSION = 2;
+
+  /** Value returned by registerConsumer when every consumer slot is taken. */
+  static const int NO_CONSUMER_SLOT = -1;
+
+  /** Time attach waits for the creator to lay out the segment. */
+  static const long ATTACH_TIMEOUT_MILLIS = 1000L;
+
+private:
+  static const int SPIN_TRIES = 100;
+  static const int YIELD_TRIES = 100;
+
+  enum SlotState : int {
+    Free = 0,
+    Registering = 1,
+    Active = 2,
+    Reclaiming = 3
+  };
+
+  struct PaddedSequence {
+    std::atomic_long value;
+    long p1, p2, p3, p4, p5, p6, p7;
+  };
+
+  struct ConsumerSlot {
+    std::atomic_int state;
+    std::atomic_int pid;
+    std::atomic_long sequence;
+    long p1, p2, p3, p4, p5, p6;
+  };
+
+  struct Header {
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    int32_t bufferSize;
+    int32_t entrySize;
+    int32_t maxConsumers;
+    long p1, p2, p3, p4, p5;
+    PaddedSequence cursor;
+    PaddedSequence claim;
+  };
+
+  std::unique_ptr<SharedMemory> memory_;
+  Header* header_;
+  ConsumerSlot* consumers_;
+  T* entries_;
+  int indexMask_;
+  std::atomic_long gatingSequenceCache_;
+
+public:
+  /**
+   * Create the shared memory segment and lay out an empty ring buffer in it.
+   *
+   * @param name of the segment, starting with '/'.
+   * @param bufferSize number of entries, which must be a power of 2.
+   * @param maxConsumers number of consumer slots.
+   * @throws std::system_error if the segment exists or cannot be created.
+   */
+  static std::unique_ptr<SharedMemoryRingBuffer<T>> create(const std::string& name, const int bufferSize,
+                                                            const int maxConsumers)
+  {
+    if (util::bitCount(bufferSize) != 1) {
+      throw std::out_of_range("bufferSize must be a power of 2");
+    }
+
+    if (maxConsumers < 1) {
+      throw std::out_of_range("maxConsumers must be greater than 0");
+    }
+
+    std::unique_ptr<SharedMemory> memory(SharedMemory::create(name, getSegmentSize(bufferSize, maxConsumers)));
+
+    Header* header = new (memory->getAddress()) Header();
+    header->version = VERSION;
+    header->bufferSize = bufferSize;
+    header->entrySize = (int32_t)sizeof(T);
+    header->maxConsumers = maxConsumers;
+    header->cursor.value.store(-1L);
+    header->claim.value.store(-1L);
+
+    ConsumerSlot* consumers = getConsumers(header);
+    for (int i = 0; i < maxConsumers; ++i) {
+      new (&consumers[i]) ConsumerSlot();
+      consumers[i].state.store(Free);
+    }
+
+    /* Attachers check the magic last written. */
+    header->magic.store(MAGIC, std::memory_order_release);
+
+    return std::unique_ptr<SharedMemoryRingBuffer<T>>(new SharedMemoryRingBuffer<T>(memory.release()));
+  }
+
+  /**
+   * Attach to a ring buffer created by another process, waiting up to
+   * ATTACH_TIMEOUT_MILLIS for the creator to create and lay it out.
+   *
+   * @param name of the segment, starting with '/'.
+   * @throws std::system_error if the segment does not exist.
+   * @throws std::runtime_error if the segment does not hold a compatible ring buffer of T.
+   */
+  static std::unique_ptr<SharedMemoryRingBuffer<T>> attach(const std::string& name) {
+    return attach(name, ATTACH_TIMEOUT_MILLIS, TimeUnit::Milliseconds);
+  }
+
+  /**
+   * Attach to a ring buffer created by another process.
+   *
+   * @param name of the segment, starting with '/'.
+   * @param timeout to wait for the creator to create and size the segment and store the magic.
+   * @param units of the timeout.
+   * @throws std::system_error if the segment does not exist when the timeout elapses.
+   * @throws std::runtime_error if the segment does not hold a compatible ring buffer of T,
+   * or is not laid out before the timeout elapses.
+   */
+  static std::unique_ptr<SharedMemoryRingBuffer<T>> attach(const std::string& name, const long timeout,
+                                                            const TimeUnit units)
+  {
+    const long deadline = util::nanoTime() + util::toNanos(timeout, units);
+    std::unique_ptr<SharedMemory> memory;
+    int counter = 0;
+
+    /*
+     * The creator opens the segment, sizes it and then stores the magic, which is zero
+     * until then.  The segment is only mapped once it is large enough for the header.
+     */
+    while (true) {
+      memory.reset(SharedMemory::tryAttach(name, sizeof(Header)));
+      if (nullptr != memory
+          && 0ULL != static_cast<Header*>(memory->getAddress())->magic.load(std::memory_order_acquire)) {
+        break;
+      }
+      if (util::nanoTime() > deadline) {
+        break;
+      }
+      counter = backOff(counter);
+    }
+
+    if (nullptr == memory) {
+      /* Still missing or unsized when the timeout elapsed; attach reports which. */
+      memory.reset(SharedMemory::attach(name));
+    }
+
+    if (memory->getSize() < sizeof(Header)) {
+      throw std::runtime_error(name + " is too small for a ring buffer");
+    }
+
+    Header* header = static_cast<Header*>(memory->getAddress());
+    if (MAGIC != header->magic.load(std::memory_order_acquire)) {
+      throw std::runtime_error(name + " is not a ring buffer");
+    }
+
+    if (VERSION != header->version) {
+      throw std::runtime_error(name + " has an unsupported layout version");
+    }
+
+    if ((int32_t)sizeof(T) != header->entrySize) {
+      throw std::runtime_error(name + " holds events of a different size");
+    }
+
+    if (memory->getSize() < getSegmentSize(header->bufferSize, header->maxConsumers)) {
+      throw std::runtime_error(name + " is smaller than its layout");
+    }
+
+    return std::unique_ptr<SharedMemoryRingBuffer<T>>(new SharedMemoryRingBuffer<T>(memory.release()));
+  }
+
+  int getBufferSize() const {
+    return header_->bufferSize;
+  }
+
+  int getMaxConsumers() const {
+    return header_->maxConsumers;
+  }
+
+  /**
+   * Get the value of the cursor indicating the published sequence.
+   */
+  long getCursor() const {
+    return header_->cursor.value.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Get the entry for a given sequence.
+   */
+  T& get(const long sequence) {
+    return entries_[(int)sequence & indexMask_];
+  }
+
+  /**
+   * Claim the next sequence for publishing, waiting for every registered consumer to
+   * free the entry.
+   *
+   * @return the claimed sequence.
+   */
+  long next() {
+    const long sequence = header_->claim.value.fetch_add(1L) + 1L;
+    const long wrapPoint = sequence - header_->bufferSize;
+
+    if (wrapPoint > gatingSequenceCache_.load(std::memory_order_relaxed)) {
+      long minSequence;
+      int counter = 0;
+      while (wrapPoint > (minSequence = getMinimumConsumerSequence())) {
+        if (counter >= SPIN_TRIES + YIELD_TRIES) {
+          reclaimExitedConsumers();
+        }
+        counter = backOff(counter);
+      }
+
+      /* A consumer registering later must still gate, so only cache a registered sequence. */
+      if (LONG_MAX != minSequence) {
+        gatingSequenceCache_.store(minSequence, std::memory_order_relaxed);
+      }
+    }
+
+    return sequence;
+  }
+
+  /**
+   * Publish a claimed sequence once every earlier claim has been published.
+   *
+   * @param sequence returned by next.
+   */
+  void publish(const long sequence) {
+    const long expectedSequence = sequence - 1L;
+    int counter = 0;
+    while (expectedSequence != header_->cursor.value.load(std::memory_order_acquire)) {
+      counter = backOff(counter);
+    }
+
+    header_->cursor.value.store(sequence, std::memory_order_release);
+  }
+
+  /**
+   * Take a consumer slot, starting from the current cursor.
+   *
+   * @return the slot, or NO_CONSUMER_SLOT if every slot is taken.
+   */
+  int registerConsumer() {
+    for (int slot = 0; slot < header_->maxConsumers; ++slot) {
+      ConsumerSlot& consumer = consumers_[slot];
+      int expected = Free;
+      if (consumer.state.compare_exchange_strong(expected, Registering)) {
+        consumer.pid.store((int)::getpid());
+        consumer.sequence.store(getCursor());
+        consumer.state.store(Active);
+        return slot;
+      }
+    }
+
+    return NO_CONSUMER_SLOT;
+  }
+
+  /**
+   * Release a consumer slot so that it no longer gates publishers.
+   */
+  void unregisterConsumer(const int slot) {
+    checkSlot(slot);
+    int counter = 0;
+    int expected = Active;
+    /* A publisher checking whether the process is running restores the slot to Active. */
+    while (!consumers_[slot].state.compare_exchange_weak(expected, Free) && Free != expected) {
+      expected = Active;
+      counter = backOff(counter);
+    }
+  }
+
+  /**
+   * Free the slots of consumers whose process has exited without unregistering.  Publishers
+   * call this while held up by a consumer.
+   *
+   * @return the number of slots freed.
+   */
+  int reclaimExitedConsumers() {
+    int reclaimed = 0;
+    for (int slot = 0; slot < header_->maxConsumers; ++slot) {
+      ConsumerSlot& consumer = consumers_[slot];
+      int expected = Active;
+      if (Active != consumer.state.load() || !isExited(consumer.pid.load())) {
+        continue;
+      }
+
+      /* Reclaiming still gates publishers, and the pid is checked again in case the slot was re-registered. */
+      if (consumer.state.compare_exchange_strong(expected, Reclaiming)) {
+        if (isExited(consumer.pid.load())) {
+          consumer.state.store(Free);
+          ++reclaimed;
+        }
+        else {
+          consumer.state.store(Active);
+        }
+      }
+    }
+    return reclaimed;
+  }
+
+  /**
+   * Get the sequence last consumed through a slot.
+   */
+  long getConsumerSequence(const int slot) const {
+    checkSlot(slot);
+    return consumers_[slot].sequence.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Mark the entries up to sequence as consumed through a slot, freeing them for publishers.
+   */
+  void setConsumerSequence(const int slot, const long sequence) {
+    checkSlot(slot);
+    consumers_[slot].sequence.store(sequence, std::memory_order_release);
+  }
+
+  /**
+   * Wait for a sequence to be published.
+   *
+   * @param sequence to wait for.
+   * @param timeout after which to give up.
+   * @param units of the timeout.
+   * @return the published sequence, which is less than sequence if the timeout elapsed.
+   */
+  long waitFor(const long sequence, const long timeout, const TimeUnit units) {
+    const long deadline = util::nanoTime() + util::toNanos(timeout, units);
+    long availableSequence;
+    int counter = 0;
+
+    while ((availableSequence = getCursor()) < sequence) {
+      if (util::nanoTime() > deadline) {
+        break;
+      }
+      counter = backOff(counter);
+    }
+
+    return availableSequence;
+  }
+
+  SharedMemoryRingBuffer(const SharedMemoryRingBuffer&) = delete;
+  SharedMemoryRingBuffer& operator=(const SharedMemoryRingBuffer&) = delete;
+
+private:
+  SharedMemoryRingBuffer(SharedMemory* memory)
+    : memory_(memory)
+    , header_(static_cast<Header*>(memory->getAddress()))
+    , consumers_(getConsumers(header_))
+    , entries_(getEntries(header_))
+    , indexMask_(header_->bufferSize - 1)
+    , gatingSequenceCache_(-1L)
+  {}
+
+  static std::size_t getEntriesOffset(const int maxConsumers) {
+    const std::size_t offset = sizeof(Header) + maxConsumers * sizeof(ConsumerSlot);
+    const std::size_t alignment = alignof(T) > 64 ? alignof(T) : 64;
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+  static std::size_t getSegmentSize(const int bufferSize, const int maxConsumers) {
+    return getEntriesOffset(maxConsumers) + bufferSize * sizeof(T);
+  }
+
+  static ConsumerSlot* getConsumers(Header* header) {
+    return reinterpret_cast<ConsumerSlot*>(reinterpret_cast<char*>(header) + sizeof(Header));
+  }
+
+  static T* getEntries(Header* header) {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(header) + getEntriesOffset(header->maxConsumers));
+  }
+
+  long getMinimumConsumerSequence() const {
+    long minimum = LONG_MAX;
+    for (int slot = 0; slot < header_->maxConsumers; ++slot) {
+      const ConsumerSlot& consumer = consumers_[slot];
+      const int state = consumer.state.load();
+      if (Active == state || Reclaiming == state) {
+        const long sequence = consumer.sequence.load(std::memory_order_acquire);
+        if (sequence < minimum) {
+          minimum = sequence;
+        }
+      }
+    }
+    return minimum;
+  }
+
+  static bool isExited(const int pid) {
+    return -1 == ::kill((pid_t)pid, 0) && ESRCH == errno;
+  }
+
+  void checkSlot(const int slot) const {
+    if (slot < 0 || slot >= header_->maxConsumers) {
+      throw std::out_of_range("no such consumer slot");
+    }
+  }
+
+  static int backOff(int counter) {
+    if (counter < SPIN_TRIES) {
+      // busy spin
+    }
+    else if (counter < SPIN_TRIES + YIELD_TRIES) {
+      std::this_thread::yield();
+    }
+    else {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(1L));
+      return counter;
+    }
+    return counter + 1;
+  }
+};
+
+}
+
+#endif /* __VARONT_SHAREDMEMORYRINGBUFFER_HPP__ */
@@ -22,6 +22,7 @@
 #include "ClaimStrategy.hpp"
 #include "Sequencer.hpp"
 #include "PaddedLong.hpp"
+#include "Metrics.hpp"
 #include "Util.hpp"
 
 namespace varont {
@@ -37,6 +38,7 @@ class SingleThreadedClaimStrategy
   int bufferSize_;
   util::PaddedLong minGatingSequence_;
   util::PaddedLong claimSequence_;
+  ProducerMetrics* metrics_;
 
 public:
     /**
@@ -48,6 +50,7 @@ public:
     : bufferSize_(bufferSize)
     , minGatingSequence_(Sequencer::INITIAL_CURSOR_VALUE)
     , claimSequence_(Sequencer::INITIAL_CURSOR_VALUE)
+    , metrics_(nullptr)
   { }
 
   const int getBufferSize() const {
@@ -100,7 +103,6 @@ public:
   }
     
   long checkAndIncrement(const int availableCapacity, const int delta, std::vector<Sequence*>& dependentSequences)
-    throw(InsufficientCapacityException)
   {
     if (!hasAvailableCapacity(availableCapacity, dependentSequences)) {
       throw InsufficientCapacityException("");
@@ -109,13 +111,36 @@ public:
     return incrementAndGet(delta, dependentSequences);
   }
 
+  long checkAndIncrement(const int availableCapacity, const int delta, std::vector<Sequence*>& dependentSequences,
+                         const std::nothrow_t&)
+  {
+    if (!hasAvailableCapacity(availableCapacity, dependentSequences)) {
+      return INSUFFICIENT_CAPACITY;
+    }
+
+    return incrementAndGet(delta, dependentSequences);
+  }
+
+  void setMetrics(ProducerMetrics* metrics) {
+    metrics_ = metrics;
+  }
+
   void waitForFreeSlotAt(const long sequence, std::vector<Sequence*>& dependentSequences) {
     long wrapPoint = sequence - bufferSize_;
 
     if (wrapPoint > minGatingSequence_.get()) {
       long minSequence;
-      while (wrapPoint > (minSequence = util::getMinimumSequence(dependentSequences))) {
-        std::this_thread::sleep_for(std::chrono::nanoseconds(1L));
+      if (wrapPoint > (minSequence = util::getMinimumSequence(dependentSequences))) {
+        const long stallStart = (nullptr != metrics_) ? util::nanoTime() : 0L;
+
+        do {
+          std::this_thread::sleep_for(std::chrono::nanoseconds(1L));
+        } while (wrapPoint > (minSequence = util::getMinimumSequence(dependentSequences)));
+
+        if (nullptr != metrics_) {
+          metrics_->stalls.increment();
+          metrics_->stallNanos.increment(util::nanoTime() - stallStart);
+        }
       }
 
       minGatingSequence_.set(minSequence);
@@ -18,11 +18,14 @@
 
 #include <vector>
 #include <chrono>
+#include <thread>
 
 #include "SequenceBarrier.hpp"
 #include "WaitStrategy.hpp"
 #include "Util.hpp"
 #include "TimeUnit.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
 
 namespace varont {
 /**
@@ -36,23 +39,33 @@ class SleepingWaitStrategy
 {
   static const int RETRIES = 200;
 
+  WaitMetrics* metrics_;
+
 public:
+  SleepingWaitStrategy()
+    : metrics_(nullptr)
+  {}
+
   long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier)
-    throw(AlertException/*, InterruptedException*/)
   {
     long availableSequence;
     int counter = RETRIES;
 
     if (dependents.empty()) {
       while ((availableSequence = cursor.get()) < sequence) {
-        counter = applyWaitMethod(barrier, counter);
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        counter = applyWaitMethod(counter);
       }
     }
     else {
-      while ((availableSequence = util::getMinimumSequence(dependents)) < sequence)
-        {
-          counter = applyWaitMethod(barrier, counter);
+      while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
         }
+        counter = applyWaitMethod(counter);
+      }
     }
 
     return availableSequence;
@@ -60,7 +73,6 @@ public:
 
   long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier,
                long timeout, TimeUnit sourceUnit)
-    throw(AlertException/*, InterruptedException*/)
   {
     long timeoutMs = timeout; /*sourceUnit.toMillis(timeout);*/
     auto startTime = std::chrono::system_clock::now();
@@ -69,7 +81,10 @@ public:
 
     if (dependents.empty()) {
       while ((availableSequence = cursor.get()) < sequence) {
-        counter = applyWaitMethod(barrier, counter);
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        counter = applyWaitMethod(counter);
 
         auto elapsedTime = std::chrono::system_clock::now() - startTime;
         if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count() > timeoutMs) {
@@ -79,7 +94,10 @@ public:
     }
     else {
       while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
-        counter = applyWaitMethod(barrier, counter);
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        counter = applyWaitMethod(counter);
 
         auto elapsedTime = std::chrono::system_clock::now() - startTime;
         if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count() > timeoutMs) {
@@ -94,11 +112,11 @@ public:
   void signalAllWhenBlocking() {
   }
 
-  int applyWaitMethod(SequenceBarrier& barrier, int counter)
-    throw(AlertException)
-  {
-    barrier.checkAlert();
+  void setMetrics(WaitMetrics* metrics) {
+    metrics_ = metrics;
+  }
 
+  int applyWaitMethod(int counter) {
     if (counter > 100) {
       --counter;
     }
@@ -107,7 +125,12 @@ public:
       std::this_thread::yield();
     }
     else {
+      if (nullptr != metrics_) {
+        metrics_->parks.increment();
+      }
+      VARONT_TRACE(park, 0, 0);
       std::this_thread::sleep_for(std::chrono::nanoseconds(1L));
+      VARONT_TRACE(wake, 0, 0);
     }
 
     return counter;
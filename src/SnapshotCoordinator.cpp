@@ -0,0 +1,449 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "SnapshotCoordinator.hpp"
+#include "IllegalStateException.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+namespace {
+
+const char SNAPSHOT_SUFFIX[] = ".snapshot";
+const char MANIFEST[] = "MANIFEST";
+const std::size_t SEQUENCE_DIGITS = 20;
+
+std::string getSnapshotPath(const std::string& directory, const long sequence) {
+  char name[64];
+  std::snprintf(name, sizeof(name), "%020ld%s", sequence, SNAPSHOT_SUFFIX);
+  return directory + "/" + name;
+}
+
+const std::size_t STREAM_BUFFER_SIZE = 65536;
+
+/*
+ * The helpers below return 0 or the errno of the failure and are used in forked children,
+ * so they never throw, allocate or take a lock.
+ */
+
+int writeFully(const int fd, const char* data, const std::size_t size) {
+  std::size_t written = 0;
+  while (written < size) {
+    const ssize_t rc = ::write(fd, data + written, size - written);
+    if (-1 == rc) {
+      if (EINTR == errno) {
+        continue;
+      }
+      return errno;
+    }
+    written += (std::size_t)rc;
+  }
+  return 0;
+}
+
+/* Syncs and closes a temporary file, then renames it into place. */
+int commitFile(const int fd, const char* temporaryPath, const char* path) {
+  if (-1 == ::fsync(fd)) {
+    const int error = errno;
+    ::close(fd);
+    return error;
+  }
+  ::close(fd);
+
+  return (-1 == ::rename(temporaryPath, path)) ? errno : 0;
+}
+
+int writeFileDurably(const std::string& path, const std::string& data) {
+  const std::string temporaryPath = path + ".tmp";
+  const int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (-1 == fd) {
+    return errno;
+  }
+
+  const int rc = writeFully(fd, data.data(), data.size());
+  if (0 != rc) {
+    ::close(fd);
+    return rc;
+  }
+
+  return commitFile(fd, temporaryPath.c_str(), path.c_str());
+}
+
+/*
+ * Writes a stream to a file descriptor through a buffer allocated up front, so that a
+ * forked child can write a snapshot without allocating.  Remembers the first error.
+ */
+class FileStreamBuffer : public std::streambuf {
+  const int fd_;
+  std::vector<char> buffer_;
+  int error_;
+
+public:
+  FileStreamBuffer(const int fd)
+    : fd_(fd)
+    , buffer_(STREAM_BUFFER_SIZE)
+    , error_(0)
+  {
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+  }
+
+  int getError() const {
+    return error_;
+  }
+
+protected:
+  int_type overflow(int_type c) {
+    if (0 != sync()) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() {
+    if (0 == error_) {
+      error_ = writeFully(fd_, pbase(), (std::size_t)(pptr() - pbase()));
+    }
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return (0 == error_) ? 0 : -1;
+  }
+};
+
+/* Removes a snapshot directory and the files in it, leaving whatever cannot be removed. */
+void removeSnapshotDirectory(const std::string& path) {
+  DIR* dir = ::opendir(path.c_str());
+  if (nullptr == dir) {
+    return;
+  }
+
+  while (struct dirent* entry = ::readdir(dir)) {
+    const std::string name = entry->d_name;
+    if ("." != name && ".." != name) {
+      ::unlink((path + "/" + name).c_str());
+    }
+  }
+  ::closedir(dir);
+
+  ::rmdir(path.c_str());
+}
+
+int syncDirectory(const std::string& directory) {
+  const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (-1 == fd) {
+    return errno;
+  }
+  const int rc = ::fsync(fd);
+  const int error = errno;
+  ::close(fd);
+  return (-1 == rc) ? error : 0;
+}
+
+}
+
+SnapshotCoordinator::SnapshotCoordinator(const std::string& directory)
+  : directory_(directory)
+  , targetSequence_(NO_SNAPSHOT)
+  , pending_(false)
+  , generation_(0L)
+  , state_(State::Idle)
+  , latestSnapshot_(-1L)
+{}
+
+void SnapshotCoordinator::addParticipant(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  participants_.push_back(Participant{ name, -1L, -1, false, false });
+}
+
+void SnapshotCoordinator::requestSnapshot(const long sequence) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.load()) {
+    throw IllegalStateException("a snapshot is already in progress");
+  }
+
+  if (participants_.empty()) {
+    throw IllegalStateException("a snapshot needs at least one participant");
+  }
+
+  const std::string path = getSnapshotPath(directory_, sequence);
+  if (-1 == ::mkdir(path.c_str(), 0755) && EEXIST != errno) {
+    throw std::system_error(errno, std::system_category(), "mkdir " + path);
+  }
+
+  ++generation_;
+  for (Participant& participant : participants_) {
+    participant.sequence = -1L;
+    participant.pid = -1;
+    participant.done = false;
+    participant.succeeded = false;
+  }
+
+  state_ = State::InProgress;
+  pending_.store(true);
+  targetSequence_.store(sequence, std::memory_order_release);
+}
+
+long SnapshotCoordinator::requestSnapshot(Sequencer& sequencer) {
+  const long sequence = sequencer.getCursor() + sequencer.getBufferSize();
+  requestSnapshot(sequence);
+  return sequence;
+}
+
+void SnapshotCoordinator::snapshot(const std::string& name, const long sequence, Snapshotable& state) {
+  long generation;
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Participant& participant = getParticipant(name);
+    const long targetSequence = targetSequence_.load();
+    participant.sequence = sequence;
+
+    if (sequence != targetSequence) {
+      /* Passed the target before seeing the request; the state would be inconsistent. */
+      participant.done = true;
+      return;
+    }
+
+    generation = generation_;
+    path = getSnapshotPath(directory_, targetSequence) + "/" + name;
+  }
+
+  /*
+   * Fork without the lock, so that poll() and cancel() never wait on it.  The child is a
+   * copy of this thread alone, so everything it needs is opened and allocated here first.
+   */
+  const std::string temporaryPath = path + ".tmp";
+  const int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  pid_t pid = -1;
+  if (-1 != fd) {
+    FileStreamBuffer buffer(fd);
+    std::ostream out(&buffer);
+
+    pid = ::fork();
+    if (0 == pid) {
+      int rc;
+      try {
+        state.writeSnapshot(out);
+        out.flush();
+        rc = buffer.getError();
+      }
+      catch (...) {
+        rc = -1;
+      }
+      if (0 == rc) {
+        rc = commitFile(fd, temporaryPath.c_str(), path.c_str());
+      }
+      ::_exit(0 == rc ? 0 : 1);
+    }
+
+    ::close(fd);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Participant& participant = getParticipant(name);
+  if (generation != generation_ || participant.done) {
+    /* Cancelled while forking; nobody else will collect the child. */
+    if (-1 != pid) {
+      ::kill(pid, SIGKILL);
+      reap(pid);
+    }
+    return;
+  }
+
+  if (-1 == pid) {
+    participant.done = true;
+    return;
+  }
+
+  participant.pid = pid;
+}
+
+SnapshotCoordinator::State SnapshotCoordinator::poll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!pending_.load()) {
+    return state_;
+  }
+
+  bool done = true;
+  bool succeeded = true;
+  for (Participant& participant : participants_) {
+    if (!participant.done && -1 != participant.pid) {
+      int status;
+      if (participant.pid == ::waitpid(participant.pid, &status, WNOHANG)) {
+        participant.done = true;
+        participant.succeeded = WIFEXITED(status) && 0 == WEXITSTATUS(status);
+      }
+    }
+
+    done = done && participant.done;
+    succeeded = succeeded && participant.succeeded;
+  }
+
+  if (done) {
+    finish(succeeded);
+  }
+
+  return state_;
+}
+
+SnapshotCoordinator::State SnapshotCoordinator::await(const long timeoutMillis) {
+  const long deadline = util::nanoTime() + timeoutMillis * 1000000L;
+  State state;
+  while (State::InProgress == (state = poll()) && util::nanoTime() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return state;
+}
+
+SnapshotCoordinator::State SnapshotCoordinator::cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!pending_.load()) {
+    return state_;
+  }
+
+  for (Participant& participant : participants_) {
+    if (!participant.done && -1 != participant.pid) {
+      ::kill(participant.pid, SIGKILL);
+      reap(participant.pid);
+    }
+    participant.done = true;
+  }
+
+  finish(false);
+  return state_;
+}
+
+long SnapshotCoordinator::getLatestSnapshot() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return latestSnapshot_;
+}
+
+SnapshotCoordinator::Participant& SnapshotCoordinator::getParticipant(const std::string& name) {
+  std::vector<Participant>::iterator participant =
+    std::find_if(participants_.begin(), participants_.end(), [&name](const Participant& p) { return name == p.name; });
+  if (participants_.end() == participant) {
+    throw std::out_of_range("no such snapshot participant: " + name);
+  }
+  return *participant;
+}
+
+void SnapshotCoordinator::reap(const pid_t pid) {
+  int status;
+  while (-1 == ::waitpid(pid, &status, 0) && EINTR == errno) {
+  }
+}
+
+void SnapshotCoordinator::finish(const bool succeeded) {
+  const long sequence = targetSequence_.load();
+  state_ = State::Failed;
+
+  if (succeeded) {
+    try {
+      writeManifest(sequence);
+      latestSnapshot_ = sequence;
+      state_ = State::Complete;
+    }
+    catch (std::system_error&) {
+      /* Without a manifest the snapshot is never used. */
+    }
+  }
+
+  if (State::Failed == state_) {
+    removeSnapshotDirectory(getSnapshotPath(directory_, sequence));
+  }
+
+  targetSequence_.store(NO_SNAPSHOT, std::memory_order_release);
+  pending_.store(false);
+}
+
+void SnapshotCoordinator::writeManifest(const long sequence) {
+  std::ostringstream manifest;
+  manifest << "sequence " << sequence << '\n';
+  for (const Participant& participant : participants_) {
+    manifest << "participant " << participant.name << '\n';
+  }
+
+  const std::string path = getSnapshotPath(directory_, sequence);
+  int rc = writeFileDurably(path + "/" + MANIFEST, manifest.str());
+  if (0 == rc) {
+    rc = syncDirectory(path);
+  }
+  if (0 == rc) {
+    rc = syncDirectory(directory_);
+  }
+  if (0 != rc) {
+    throw std::system_error(rc, std::system_category(), "write manifest of " + path);
+  }
+}
+
+long SnapshotCoordinator::findLatestSnapshot(const std::string& directory) {
+  DIR* dir = ::opendir(directory.c_str());
+  if (nullptr == dir) {
+    throw std::system_error(errno, std::system_category(), "opendir " + directory);
+  }
+
+  const std::size_t suffixLength = sizeof(SNAPSHOT_SUFFIX) - 1;
+  long latest = -1L;
+  while (struct dirent* entry = ::readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name.size() != SEQUENCE_DIGITS + suffixLength
+        || 0 != name.compare(SEQUENCE_DIGITS, suffixLength, SNAPSHOT_SUFFIX)) {
+      continue;
+    }
+
+    const std::string manifest = directory + "/" + name + "/" + MANIFEST;
+    if (0 == ::access(manifest.c_str(), F_OK)) {
+      latest = std::max(latest, std::strtol(name.substr(0, SEQUENCE_DIGITS).c_str(), nullptr, 10));
+    }
+  }
+  ::closedir(dir);
+
+  return latest;
+}
+
+void SnapshotCoordinator::restore(const std::string& directory, const long sequence, const std::string& name,
+                                  Snapshotable& state)
+{
+  const std::string path = getSnapshotPath(directory, sequence) + "/" + name;
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::system_error(ENOENT, std::system_category(), "open " + path);
+  }
+  state.readSnapshot(in);
+}
+
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SNAPSHOTCOORDINATOR_HPP__
+#define __VARONT_SNAPSHOTCOORDINATOR_HPP__
+
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "Sequencer.hpp"
+#include "Snapshotable.hpp"
+
+namespace varont {
+
+/**
+ * Coordinates consistent snapshots of the state of several event handlers at one sequence,
+ * so that recovery restores the snapshot and replays only the tail of the {@link Journal}
+ * after it.
+ *
+ * A snapshot is requested for a target sequence.  Each participating
+ * {@link SnapshotEventHandler} forks when it has processed the event at the target, and
+ * the child writes the handler's state while the parent carries on processing, its pages
+ * shared copy-on-write.  The child has only the forking thread, so it writes through a
+ * buffer allocated before the fork, straight to the file with write(2); see
+ * {@link Snapshotable#writeSnapshot(std::ostream&)} for what the state may do there.  Once every participant's child has written its state the
+ * coordinator writes a manifest, which marks the snapshot as complete:
+ *
+ * <pre>
+ *   directory/00000000000000001024.snapshot/MANIFEST
+ *   directory/00000000000000001024.snapshot/&lt;participant&gt;
+ * </pre>
+ *
+ * A participant that only sees the request after passing the target fails the snapshot,
+ * which is then discarded, so a target far enough ahead of the cursor should be chosen,
+ * as requestSnapshot(Sequencer&) does.  Only one snapshot is in progress at a time.
+ *
+ * A snapshot that never finishes, because no event reaches the target, a participant
+ * has halted or a child hangs, holds up every later request until it is cancelled.
+ * The directory of a failed or cancelled snapshot is removed.
+ */
+class SnapshotCoordinator {
+public:
+  /** Target sequence while no snapshot is requested. */
+  static const long NO_SNAPSHOT = LONG_MAX;
+
+  enum class State {
+    Idle,
+    InProgress,
+    Complete,
+    Failed
+  };
+
+private:
+  struct Participant {
+    std::string name;
+    long sequence;
+    pid_t pid;
+    bool done;
+    bool succeeded;
+  };
+
+  std::string directory_;
+  std::atomic_long targetSequence_;
+  std::atomic_bool pending_;
+  std::mutex mutex_;
+  std::vector<Participant> participants_;
+  long generation_;
+  State state_;
+  long latestSnapshot_;
+
+public:
+  /**
+   * @param directory in which to write snapshots, which must exist.
+   */
+  SnapshotCoordinator(const std::string& directory);
+
+  /**
+   * Add a participant, whose state is part of every snapshot.  Must be called before
+   * any snapshot is requested.
+   */
+  void addParticipant(const std::string& name);
+
+  /**
+   * Request a snapshot after the event at sequence has been processed.
+   *
+   * @param sequence which must not yet have been processed by any participant.
+   * @throws IllegalStateException if a snapshot is in progress.
+   */
+  void requestSnapshot(const long sequence);
+
+  /**
+   * Request a snapshot a buffer's length beyond the cursor of a {@link Sequencer}, a
+   * sequence that cannot yet have been published.
+   *
+   * @return the target sequence.
+   */
+  long requestSnapshot(Sequencer& sequencer);
+
+  /**
+   * Get the target sequence of the snapshot in progress, or NO_SNAPSHOT.
+   */
+  long getTargetSequence() const {
+    return targetSequence_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Is a snapshot waiting for participants or their children.
+   */
+  bool isPending() const {
+    return pending_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Fork a child to write a participant's state.  Called by the participant once it has
+   * processed the event at or after the target sequence.  The snapshot file and the
+   * stream buffer are set up before forking and the lock is not held while forking.
+   *
+   * @param name of the participant.
+   * @param sequence of the last event processed into the state.
+   * @param state to write.
+   */
+  void snapshot(const std::string& name, const long sequence, Snapshotable& state);
+
+  /**
+   * Collect the children that have finished and complete the snapshot if every
+   * participant's state has been written.
+   *
+   * @return the state of the latest snapshot.
+   */
+  State poll();
+
+  /**
+   * Poll until the snapshot in progress completes or fails.
+   *
+   * @param timeoutMillis after which to give up.
+   * @return the state of the latest snapshot, InProgress if the timeout elapsed.
+   */
+  State await(const long timeoutMillis);
+
+  /**
+   * Fail the snapshot in progress, killing and collecting the children still writing
+   * participants' state.  Does nothing if no snapshot is pending.
+   *
+   * @return the state of the latest snapshot.
+   */
+  State cancel();
+
+  /**
+   * Get the sequence of the latest snapshot completed by this coordinator, or -1.
+   */
+  long getLatestSnapshot();
+
+  /**
+   * Find the latest complete snapshot in a directory.
+   *
+   * @return its sequence, or -1 if there is none.
+   */
+  static long findLatestSnapshot(const std::string& directory);
+
+  /**
+   * Restore a participant's state from a complete snapshot.
+   *
+   * @throws std::system_error if the participant is not in the snapshot.
+   */
+  static void restore(const std::string& directory, const long sequence, const std::string& name, Snapshotable& state);
+
+  SnapshotCoordinator(const SnapshotCoordinator&) = delete;
+  SnapshotCoordinator& operator=(const SnapshotCoordinator&) = delete;
+
+private:
+  Participant& getParticipant(const std::string& name);
+  void reap(const pid_t pid);
+  void finish(const bool succeeded);
+  void writeManifest(const long sequence);
+};
+
+}
+
+#endif /* __VARONT_SNAPSHOTCOORDINATOR_HPP__ */
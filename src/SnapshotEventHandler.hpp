@@ -0,0 +1,99 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SNAPSHOTEVENTHANDLER_HPP__
+#define __VARONT_SNAPSHOTEVENTHANDLER_HPP__
+
+#include <string>
+#include <system_error>
+
+#include "LifecycleAwareEventHandler.hpp"
+#include "SnapshotCoordinator.hpp"
+#include "Snapshotable.hpp"
+
+namespace varont {
+
+/**
+ * Adds the state of an event handler to the snapshots of a {@link SnapshotCoordinator},
+ * forking to write it once the event at the target sequence has been processed.
+ *
+ * Checking for a requested snapshot costs one load per event; children are collected at
+ * the end of each batch while a snapshot is pending.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class SnapshotEventHandler
+    : public LifecycleAwareEventHandler<T>
+{
+  LifecycleAwareEventHandler<T>& eventHandler_;
+  Snapshotable& state_;
+  SnapshotCoordinator& coordinator_;
+  const std::string name_;
+  long lastTargetSequence_;
+
+ public:
+  /**
+   * @param eventHandler whose events update the state.
+   * @param state of the handler.
+   * @param coordinator of the snapshots.
+   * @param name of the state within a snapshot.
+   */
+  SnapshotEventHandler(LifecycleAwareEventHandler<T>& eventHandler, Snapshotable& state,
+                       SnapshotCoordinator& coordinator, const std::string& name)
+      : eventHandler_(eventHandler)
+      , state_(state)
+      , coordinator_(coordinator)
+      , name_(name)
+      , lastTargetSequence_(SnapshotCoordinator::NO_SNAPSHOT)
+  {
+    coordinator_.addParticipant(name_);
+  }
+
+  void onEvent(T& event, long sequence, bool endOfBatch) {
+    eventHandler_.onEvent(event, sequence, endOfBatch);
+    afterEvent(sequence, endOfBatch);
+  }
+
+  void onEvent(T& event, long sequence, bool endOfBatch, std::error_code& error) {
+    eventHandler_.onEvent(event, sequence, endOfBatch, error);
+    afterEvent(sequence, endOfBatch);
+  }
+
+  void onStart() {
+    eventHandler_.onStart();
+  }
+
+  void onShutdown() {
+    eventHandler_.onShutdown();
+  }
+
+ private:
+  void afterEvent(const long sequence, const bool endOfBatch) {
+    const long targetSequence = coordinator_.getTargetSequence();
+    if (sequence >= targetSequence && targetSequence != lastTargetSequence_) {
+      lastTargetSequence_ = targetSequence;
+      coordinator_.snapshot(name_, sequence, state_);
+    }
+
+    if (endOfBatch && coordinator_.isPending()) {
+      coordinator_.poll();
+    }
+  }
+};
+
+}
+
+#endif /* __VARONT_SNAPSHOTEVENTHANDLER_HPP__ */
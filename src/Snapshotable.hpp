@@ -0,0 +1,53 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SNAPSHOTABLE_HPP__
+#define __VARONT_SNAPSHOTABLE_HPP__
+
+#include <istream>
+#include <ostream>
+
+namespace varont {
+
+/**
+ * State of an event handler that can be saved in, and restored from, a snapshot.
+ */
+class Snapshotable {
+ public:
+  /**
+   * Write the state.  Called in a forked child process that has only the calling thread,
+   * while other threads of the parent may have held locks, including the allocator's, at
+   * the fork.  So it must only read the state and write it to the stream: no allocation,
+   * no locks, no waiting on other threads and no exceptions.  The stream is buffered
+   * without allocating and writes straight to the snapshot file.
+   *
+   * @param out to write to.
+   */
+  virtual void writeSnapshot(std::ostream& out) = 0;
+
+  /**
+   * Replace the state with one written by writeSnapshot.
+   *
+   * @param in to read from.
+   */
+  virtual void readSnapshot(std::istream& in) = 0;
+
+ protected:
+  ~Snapshotable() {}
+};
+
+}
+
+#endif /* __VARONT_SNAPSHOTABLE_HPP__ */
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <poll.h>
+
+#include "SocketBatchWriter.hpp"
+
+namespace varont {
+
+SocketBatchWriter::SocketBatchWriter(const int fd, const Mode mode, const int maxIovecs, const std::size_t bufferSize)
+  : fd_(fd)
+  , mode_(mode)
+  , buffer_(bufferSize)
+  , bufferPosition_(0)
+  , iovecs_(maxIovecs)
+  , iovecCount_(0)
+  , messageStart_(0)
+  , messages_(maxIovecs)
+  , messageCount_(0)
+  , sentIovecs_(0)
+  , sentMessages_(0)
+{
+  if (maxIovecs < 1 || maxIovecs > IOV_MAX) {
+    throw std::out_of_range("maxIovecs must be greater than 0 and no greater than IOV_MAX");
+  }
+}
+
+void SocketBatchWriter::commit(const std::size_t length) {
+  if (!hasCapacity(length)) {
+    throw std::out_of_range("commit beyond the reserved space");
+  }
+
+  char* data = &buffer_[bufferPosition_];
+  bufferPosition_ += length;
+
+  /* Coalesce with the previous iovec when it ends where this one starts. */
+  if (Mode::Stream == mode_ && iovecCount_ > sentIovecs_) {
+    struct iovec& previous = iovecs_[iovecCount_ - 1];
+    if (static_cast<char*>(previous.iov_base) + previous.iov_len == data) {
+      previous.iov_len += length;
+      return;
+    }
+  }
+
+  iovecs_[iovecCount_].iov_base = data;
+  iovecs_[iovecCount_].iov_len = length;
+  ++iovecCount_;
+}
+
+bool SocketBatchWriter::add(const void* data, const std::size_t length) {
+  if (iovecCount_ == (int)iovecs_.size()) {
+    return false;
+  }
+
+  iovecs_[iovecCount_].iov_base = const_cast<void*>(data);
+  iovecs_[iovecCount_].iov_len = length;
+  ++iovecCount_;
+  return true;
+}
+
+void SocketBatchWriter::endMessage() {
+  if (Mode::Datagram != mode_ || messageStart_ == iovecCount_ || messageCount_ == (int)messages_.size()) {
+    return;
+  }
+
+  struct mmsghdr& message = messages_[messageCount_++];
+  std::memset(&message, 0, sizeof(message));
+  message.msg_hdr.msg_iov = &iovecs_[messageStart_];
+  message.msg_hdr.msg_iovlen = iovecCount_ - messageStart_;
+  messageStart_ = iovecCount_;
+}
+
+std::size_t SocketBatchWriter::flush(const bool block) {
+  return (Mode::Stream == mode_) ? flushStream(block) : flushDatagrams(block);
+}
+
+std::size_t SocketBatchWriter::flushStream(const bool block) {
+  std::size_t written = 0;
+
+  while (sentIovecs_ < iovecCount_) {
+    ssize_t rc = ::writev(fd_, &iovecs_[sentIovecs_], iovecCount_ - sentIovecs_);
+    if (-1 == rc) {
+      if (EINTR == errno) {
+        continue;
+      }
+      if (EAGAIN == errno || EWOULDBLOCK == errno) {
+        if (!block) {
+          return written;
+        }
+        awaitWritable();
+        continue;
+      }
+      throw std::system_error(errno, std::system_category(), "writev");
+    }
+
+    written += (std::size_t)rc;
+
+    /* Skip the iovecs written in full and trim the one written in part. */
+    while (rc > 0) {
+      struct iovec& iovec = iovecs_[sentIovecs_];
+      if ((std::size_t)rc >= iovec.iov_len) {
+        rc -= iovec.iov_len;
+        ++sentIovecs_;
+      }
+      else {
+        iovec.iov_base = static_cast<char*>(iovec.iov_base) + rc;
+        iovec.iov_len -= rc;
+        rc = 0;
+      }
+    }
+  }
+
+  reset();
+  return written;
+}
+
+std::size_t SocketBatchWriter::flushDatagrams(const bool block) {
+  endMessage();
+
+  std::size_t sent = 0;
+  while (sentMessages_ < messageCount_) {
+    const int rc = ::sendmmsg(fd_, &messages_[sentMessages_], messageCount_ - sentMessages_, 0);
+    if (-1 == rc) {
+      if (EINTR == errno) {
+        continue;
+      }
+      if (EAGAIN == errno || EWOULDBLOCK == errno) {
+        if (!block) {
+          return sent;
+        }
+        awaitWritable();
+        continue;
+      }
+      throw std::system_error(errno, std::system_category(), "sendmmsg");
+    }
+
+    sent += rc;
+    sentMessages_ += rc;
+  }
+
+  reset();
+  return sent;
+}
+
+void SocketBatchWriter::awaitWritable() {
+  struct pollfd pfd = { fd_, POLLOUT, 0 };
+  while (-1 == ::poll(&pfd, 1, -1)) {
+    if (EINTR != errno) {
+      throw std::system_error(errno, std::system_category(), "poll");
+    }
+  }
+}
+
+void SocketBatchWriter::reset() {
+  bufferPosition_ = 0;
+  iovecCount_ = 0;
+  messageStart_ = 0;
+  messageCount_ = 0;
+  sentIovecs_ = 0;
+  sentMessages_ = 0;
+}
+
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SOCKETBATCHWRITER_HPP__
+#define __VARONT_SOCKETBATCHWRITER_HPP__
+
+#include <cstddef>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace varont {
+
+/**
+ * Gathers the encoded events of a batch and sends them to a socket with as few system
+ * calls as possible: a single writev for a stream socket, or a single sendmmsg for a
+ * datagram socket.
+ *
+ * Data is added either by reference, for payloads that stay valid until the next flush,
+ * or by reserving space in the writer's own buffer and committing what was encoded into
+ * it.  Nothing is copied when sending; a partial write advances the pending iovecs in
+ * place and the rest is sent by the next flush.
+ *
+ * A datagram socket must be connected.  A SocketBatchWriter is not thread safe.
+ */
+class SocketBatchWriter {
+public:
+  enum class Mode {
+    /** One writev of every pending iovec. */
+    Stream,
+    /** One sendmmsg with a datagram for each message ended by endMessage. */
+    Datagram
+  };
+
+private:
+  int fd_;
+  Mode mode_;
+  std::vector<char> buffer_;
+  std::size_t bufferPosition_;
+  std::vector<struct iovec> iovecs_;
+  int iovecCount_;
+  int messageStart_;
+  std::vector<struct mmsghdr> messages_;
+  int messageCount_;
+  int sentIovecs_;
+  int sentMessages_;
+
+public:
+  /**
+   * @param fd of the socket, which may be non-blocking.
+   * @param mode matching the type of the socket.
+   * @param maxIovecs pending before the writer is full, also the most messages in Datagram mode.
+   * @param bufferSize of the buffer for reserved space.
+   */
+  SocketBatchWriter(const int fd, const Mode mode, const int maxIovecs = 64, const std::size_t bufferSize = 65536);
+
+  int getFd() const {
+    return fd_;
+  }
+
+  Mode getMode() const {
+    return mode_;
+  }
+
+  /**
+   * Can data of length bytes be reserved and committed without flushing first.
+   */
+  bool hasCapacity(const std::size_t length) const {
+    return iovecCount_ < (int)iovecs_.size() && bufferPosition_ + length <= buffer_.size();
+  }
+
+  /**
+   * Is there no room for another iovec, or another message in Datagram mode.
+   */
+  bool isFull() const {
+    return iovecCount_ == (int)iovecs_.size() || messageCount_ == (int)messages_.size();
+  }
+
+  /**
+   * Is there nothing waiting to be sent.
+   */
+  bool isEmpty() const {
+    return 0 == iovecCount_;
+  }
+
+  /**
+   * Get space in the writer's buffer to encode into.
+   *
+   * @param length largest number of bytes that will be encoded.
+   * @return the space, or nullptr if the writer must be flushed first.
+   */
+  char* reserve(const std::size_t length) {
+    return hasCapacity(length) ? &buffer_[bufferPosition_] : nullptr;
+  }
+
+  /**
+   * Add the bytes encoded into the space returned by reserve.
+   *
+   * @param length encoded, no more than was reserved.
+   */
+  void commit(const std::size_t length);
+
+  /**
+   * Add data by reference, to be sent without copying.
+   *
+   * @param data which must stay valid and unchanged until the next flush sends it.
+   * @param length of data.
+   * @return false if the writer is full and must be flushed first.
+   */
+  bool add(const void* data, const std::size_t length);
+
+  /**
+   * End the current datagram; everything added since the previous call is sent as one
+   * datagram.  Does nothing in Stream mode.
+   */
+  void endMessage();
+
+  /**
+   * Send everything pending.
+   *
+   * @param block when the socket would block, waiting for it to become writable rather
+   * than returning with data still pending.
+   * @return bytes written in Stream mode, datagrams sent in Datagram mode.
+   * @throws std::system_error if sending fails.
+   */
+  std::size_t flush(const bool block = true);
+
+  SocketBatchWriter(const SocketBatchWriter&) = delete;
+  SocketBatchWriter& operator=(const SocketBatchWriter&) = delete;
+
+private:
+  std::size_t flushStream(const bool block);
+  std::size_t flushDatagrams(const bool block);
+  void awaitWritable();
+  void reset();
+};
+
+}
+
+#endif /* __VARONT_SOCKETBATCHWRITER_HPP__ */
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SOCKETENCODER_HPP__
+#define __VARONT_SOCKETENCODER_HPP__
+
+#include "SocketBatchWriter.hpp"
+
+namespace varont {
+
+/**
+ * Encodes events for a {@link SocketSinkEventHandler}.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class SocketEncoder {
+ public:
+  /**
+   * Get the largest number of bytes encode will reserve for an event.
+   */
+  virtual int getMaxEncodedLength() = 0;
+
+  /**
+   * Add the wire format of an event to the writer, either into space reserved in the
+   * writer or by reference to data that stays valid until the writer is flushed.  The
+   * writer has room for getMaxEncodedLength() bytes and at least one iovec.
+   *
+   * @param event to encode.
+   * @param writer to add the encoded event to.
+   */
+  virtual void encode(const T& event, SocketBatchWriter& writer) = 0;
+
+ protected:
+  ~SocketEncoder() {}
+};
+
+}
+
+#endif /* __VARONT_SOCKETENCODER_HPP__ */
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SOCKETINGRESS_HPP__
+#define __VARONT_SOCKETINGRESS_HPP__
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#include "RingBuffer.hpp"
+#include "BatchDescriptor.hpp"
+#include "SocketIngressAdapter.hpp"
+#include "IllegalStateException.hpp"
+
+namespace varont {
+
+/**
+ * Source stage receiving from sockets straight into a {@link RingBuffer}.
+ *
+ * Whenever a socket becomes readable a single recvmmsg is pointed at the payload areas of
+ * the next free slots, and only the slots that received data are claimed and published,
+ * as one batch.  Data is therefore never staged and copied, and the consumers see at most
+ * one cursor update per system call.  Each datagram fills one slot; on a stream socket
+ * each slot holds the next chunk of at most getPayloadCapacity() bytes and framing is left
+ * to the consumers.
+ *
+ * Slots are filled before they are claimed, so the ingress must be the only publisher to
+ * its {@link RingBuffer}.  When the {@link RingBuffer} is full the ingress waits for
+ * capacity and the data queues in the socket's receive buffer.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class SocketIngress {
+  static const int MAX_EVENTS = 16;
+  static const uint64_t STREAM = 1UL << 32;
+
+  std::atomic_bool running_;
+  RingBuffer<T>& ringBuffer_;
+  SocketIngressAdapter<T>& adapter_;
+  const int maxBatchSize_;
+  int epollFd_;
+  int haltFd_;
+  std::vector<struct mmsghdr> messages_;
+  std::vector<struct iovec> iovecs_;
+
+ public:
+  /**
+   * @param ringBuffer to publish the received data to, which must have no other publisher.
+   * @param adapter giving access to the payload area of the events.
+   * @param maxBatchSize largest number of slots filled by one recvmmsg.
+   */
+  SocketIngress(RingBuffer<T>& ringBuffer, SocketIngressAdapter<T>& adapter, const int maxBatchSize = 32)
+      : running_(false)
+      , ringBuffer_(ringBuffer)
+      , adapter_(adapter)
+      , maxBatchSize_(maxBatchSize)
+      , epollFd_(-1)
+      , haltFd_(-1)
+      , messages_(maxBatchSize)
+      , iovecs_(maxBatchSize)
+  {
+    if (maxBatchSize < 1 || maxBatchSize > ringBuffer.getBufferSize()) {
+      throw std::out_of_range("maxBatchSize must be between 1 and the buffer size");
+    }
+
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == epollFd_) {
+      throw std::system_error(errno, std::system_category(), "epoll_create1");
+    }
+
+    haltFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (-1 == haltFd_) {
+      const int error = errno;
+      ::close(epollFd_);
+      throw std::system_error(error, std::system_category(), "eventfd");
+    }
+
+    struct epoll_event event = { };
+    event.events = EPOLLIN;
+    event.data.u64 = (uint32_t)haltFd_;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, haltFd_, &event);
+  }
+
+  ~SocketIngress() {
+    ::close(haltFd_);
+    ::close(epollFd_);
+  }
+
+  /**
+   * Start receiving from a socket.  May be called while the ingress is running.
+   *
+   * @param fd of a datagram or stream socket, which remains owned by the caller.
+   */
+  void addSocket(const int fd) {
+    int type;
+    socklen_t length = sizeof(type);
+    if (-1 == ::getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &length)) {
+      throw std::system_error(errno, std::system_category(), "getsockopt");
+    }
+
+    struct epoll_event event = { };
+    event.events = EPOLLIN;
+    event.data.u64 = (uint32_t)fd | (SOCK_STREAM == type ? STREAM : 0UL);
+    if (-1 == ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event)) {
+      throw std::system_error(errno, std::system_category(), "epoll_ctl");
+    }
+  }
+
+  /**
+   * Stop receiving from a socket.
+   *
+   * @param fd of the socket.
+   */
+  void removeSocket(const int fd) {
+    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+  }
+
+  void halt() {
+    running_.store(false);
+    const uint64_t increment = 1;
+    ssize_t rc = ::write(haltFd_, &increment, sizeof(increment));
+    (void)rc;
+  }
+
+  /**
+   * It is ok to have another thread rerun this method after a halt().
+   */
+  void operator()() {
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+      throw IllegalStateException("Thread is already running");
+    }
+
+    uint64_t value;
+    ssize_t rc = ::read(haltFd_, &value, sizeof(value));
+    (void)rc;
+
+    struct epoll_event events[MAX_EVENTS];
+
+    while (running_.load()) {
+      const int ready = ::epoll_wait(epollFd_, events, MAX_EVENTS, -1);
+      if (-1 == ready && EINTR != errno) {
+        throw std::system_error(errno, std::system_category(), "epoll_wait");
+      }
+
+      for (int i = 0; i < ready && running_.load(); ++i) {
+        const int fd = (int)(uint32_t)events[i].data.u64;
+        if (fd != haltFd_) {
+          receive(fd, 0 != (events[i].data.u64 & STREAM));
+        }
+      }
+    }
+
+    running_.store(false);
+  }
+
+  SocketIngress(const SocketIngress&) = delete;
+  SocketIngress& operator=(const SocketIngress&) = delete;
+
+ private:
+  /* Receives until the socket would block, publishing one batch per recvmmsg. */
+  void receive(const int fd, const bool stream) {
+    int received;
+
+    do {
+      if (!awaitCapacity()) {
+        return;
+      }
+
+      const long first = ringBuffer_.getCursor() + 1L;
+      for (int i = 0; i < maxBatchSize_; ++i) {
+        T& event = ringBuffer_.get(first + i);
+        iovecs_[i].iov_base = adapter_.getPayload(event);
+        iovecs_[i].iov_len = adapter_.getPayloadCapacity();
+        messages_[i].msg_hdr = { };
+        messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+        messages_[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      received = ::recvmmsg(fd, messages_.data(), maxBatchSize_, MSG_DONTWAIT, nullptr);
+      if (-1 == received) {
+        if (EINTR == errno) {
+          received = maxBatchSize_;
+          continue;
+        }
+        if (EAGAIN != errno && EWOULDBLOCK != errno) {
+          close(fd, errno);
+        }
+        return;
+      }
+
+      int filled = received;
+      if (stream) {
+        for (int i = 0; i < received; ++i) {
+          if (0 == messages_[i].msg_len) {
+            filled = i;
+            break;
+          }
+        }
+      }
+
+      if (0 != filled) {
+        publish(first, filled, fd);
+      }
+
+      if (filled != received) {
+        close(fd, 0);
+        return;
+      }
+    } while (received == maxBatchSize_);
+  }
+
+  void publish(const long first, const int count, const int fd) {
+    for (int i = 0; i < count; ++i) {
+      adapter_.onReceive(ringBuffer_.get(first + i), (int)messages_[i].msg_len, fd);
+    }
+
+    BatchDescriptor batchDescriptor(count);
+    ringBuffer_.next(batchDescriptor);
+    ringBuffer_.publish(batchDescriptor);
+  }
+
+  /* Returns false if halted while waiting for the consumers to free maxBatchSize slots. */
+  bool awaitCapacity() {
+    while (!ringBuffer_.hasAvailableCapacity(maxBatchSize_)) {
+      if (!running_.load()) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+
+    return true;
+  }
+
+  void close(const int fd, const int error) {
+    removeSocket(fd);
+    adapter_.onClose(fd, error);
+  }
+};
+
+}
+
+#endif /* __VARONT_SOCKETINGRESS_HPP__ */
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SOCKETINGRESSADAPTER_HPP__
+#define __VARONT_SOCKETINGRESSADAPTER_HPP__
+
+namespace varont {
+
+/**
+ * Exposes the payload area of an event to a {@link SocketIngress} so that data can be
+ * received from a socket straight into the {@link RingBuffer}.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class SocketIngressAdapter {
+ public:
+  /**
+   * Get the buffer into which data for the event is received.
+   *
+   * @param event whose payload area is wanted.
+   * @return the start of the payload area, which holds getPayloadCapacity() bytes.
+   */
+  virtual char* getPayload(T& event) = 0;
+
+  /**
+   * Get the number of bytes in the payload area of every event.
+   */
+  virtual int getPayloadCapacity() = 0;
+
+  /**
+   * Called once data has been received into an event and before it is published.
+   *
+   * @param event holding the data.
+   * @param length of the datagram, or of the chunk read from a stream socket.
+   * @param fd of the socket the data was received from.
+   */
+  virtual void onReceive(T& event, int length, int fd) = 0;
+
+  /**
+   * Called when a socket has been removed after the peer closed it or an error occurred.
+   * The socket has not been closed.
+   *
+   * @param fd of the socket.
+   * @param error which caused the removal, or 0 at end of stream.
+   */
+  virtual void onClose(int fd, int error) { }
+
+ protected:
+  ~SocketIngressAdapter() {}
+};
+
+}
+
+#endif /* __VARONT_SOCKETINGRESSADAPTER_HPP__ */
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SOCKETSINKEVENTHANDLER_HPP__
+#define __VARONT_SOCKETSINKEVENTHANDLER_HPP__
+
+#include "LifecycleAwareEventHandler.hpp"
+#include "SocketBatchWriter.hpp"
+#include "SocketEncoder.hpp"
+#include "Util.hpp"
+
+namespace varont {
+
+/**
+ * Output stage sending each batch of events to a socket with one vectored send.
+ *
+ * Events are encoded into a {@link SocketBatchWriter} as they arrive and flushed at the
+ * end of each batch, when the writer fills up, or, during a long batch, once the oldest
+ * unsent event is older than the flush timeout.  Flushing waits for a non-blocking socket
+ * to become writable, so the stage applies back pressure to the {@link RingBuffer}.
+ * Each event is sent as its own datagram on a datagram socket.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class SocketSinkEventHandler
+    : public LifecycleAwareEventHandler<T>
+{
+  SocketBatchWriter& writer_;
+  SocketEncoder<T>& encoder_;
+  const long flushTimeoutNanos_;
+  long firstPendingTime_;
+
+ public:
+  /**
+   * @param writer for the socket.
+   * @param encoder of the events.
+   * @param flushTimeoutNanos longest an event waits for the end of its batch, 0 to wait for the end of the batch.
+   */
+  SocketSinkEventHandler(SocketBatchWriter& writer, SocketEncoder<T>& encoder, const long flushTimeoutNanos = 0L)
+      : writer_(writer)
+      , encoder_(encoder)
+      , flushTimeoutNanos_(flushTimeoutNanos)
+      , firstPendingTime_(0L)
+  {}
+
+  void onEvent(T& event, long sequence, bool endOfBatch) {
+    if (writer_.isFull() || !writer_.hasCapacity(encoder_.getMaxEncodedLength())) {
+      writer_.flush();
+    }
+
+    if (0L != flushTimeoutNanos_ && writer_.isEmpty()) {
+      firstPendingTime_ = util::nanoTime();
+    }
+
+    encoder_.encode(event, writer_);
+    writer_.endMessage();
+
+    if (endOfBatch || writer_.isFull()
+        || (0L != flushTimeoutNanos_ && util::nanoTime() - firstPendingTime_ >= flushTimeoutNanos_)) {
+      writer_.flush();
+    }
+  }
+
+  void onStart() { }
+
+  void onShutdown() {
+    writer_.flush();
+  }
+};
+
+}
+
+#endif /* __VARONT_SOCKETSINKEVENTHANDLER_HPP__ */
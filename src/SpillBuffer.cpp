@@ -0,0 +1,132 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "SpillBuffer.hpp"
+
+namespace varont {
+
+namespace {
+
+const char FILE_TEMPLATE[] = "/spill-XXXXXX";
+
+std::size_t getRecordLength(const int length) {
+  const std::size_t unpadded = (std::size_t)(SpillBuffer::HEADER_LENGTH + length);
+  return (unpadded + SpillBuffer::ALIGNMENT - 1) & ~(std::size_t)(SpillBuffer::ALIGNMENT - 1);
+}
+
+}
+
+SpillBuffer::SpillBuffer(const std::string& directory, const std::size_t capacity)
+    : path_(directory + FILE_TEMPLATE)
+    , capacity_(capacity)
+    , address_(nullptr)
+    , head_(0)
+    , tail_(0)
+    , end_(0)
+    , wrapped_(false)
+    , size_(0)
+{
+  const int fd = ::mkostemp(&path_[0], O_CLOEXEC);
+  if (-1 == fd) {
+    throw std::system_error(errno, std::system_category(), "mkostemp " + path_);
+  }
+  /* The mapping keeps the file alive; nothing else ever needs to open it. */
+  ::unlink(path_.c_str());
+
+  int rc = ::posix_fallocate(fd, 0, (off_t)capacity_);
+  if (EOPNOTSUPP == rc || EINVAL == rc) {
+    rc = (-1 == ::ftruncate(fd, (off_t)capacity_)) ? errno : 0;
+  }
+  if (0 != rc) {
+    ::close(fd);
+    throw std::system_error(rc, std::system_category(), "allocate " + path_);
+  }
+
+  void* address = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (MAP_FAILED == address) {
+    const int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::system_category(), "mmap " + path_);
+  }
+
+  ::close(fd);
+  address_ = static_cast<char*>(address);
+}
+
+SpillBuffer::~SpillBuffer() {
+  ::munmap(address_, capacity_);
+}
+
+bool SpillBuffer::append(const void* data, const int length) {
+  const std::size_t recordLength = getRecordLength(length);
+
+  if (wrapped_) {
+    /* Records run from head_ to end_ and then from the start of the file to tail_. */
+    if (head_ - tail_ < recordLength) {
+      return false;
+    }
+  }
+  else if (capacity_ - tail_ < recordLength) {
+    if (head_ < recordLength) {
+      return false;
+    }
+    end_ = tail_;
+    tail_ = 0;
+    wrapped_ = true;
+  }
+
+  write(tail_, data, length);
+  tail_ += recordLength;
+  ++size_;
+  return true;
+}
+
+const char* SpillBuffer::peek(int& length) const {
+  std::memcpy(&length, address_ + head_, sizeof(length));
+  return address_ + head_ + HEADER_LENGTH;
+}
+
+void SpillBuffer::pop() {
+  int length;
+  peek(length);
+  head_ += getRecordLength(length);
+
+  if (0 == --size_) {
+    head_ = 0;
+    tail_ = 0;
+    wrapped_ = false;
+  }
+  else if (wrapped_ && head_ == end_) {
+    head_ = 0;
+    wrapped_ = false;
+  }
+}
+
+void SpillBuffer::write(const std::size_t position, const void* data, const int length) {
+  const int32_t header = length;
+  std::memcpy(address_ + position, &header, sizeof(header));
+  std::memcpy(address_ + position + HEADER_LENGTH, data, (std::size_t)length);
+}
+
+}
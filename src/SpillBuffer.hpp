@@ -0,0 +1,121 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SPILLBUFFER_HPP__
+#define __VARONT_SPILLBUFFER_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace varont {
+
+/**
+ * First in, first out queue of records in a memory mapped scratch file, holding the events
+ * a {@link SpillingPublisher} could not fit in its {@link RingBuffer}.
+ *
+ * Records are a length header followed by the payload padded to ALIGNMENT bytes, written
+ * circularly: a record that does not fit before the end of the file wraps to its start once
+ * the records there have been removed.  The file is unlinked as soon as it is mapped, so it
+ * takes disk space only while the buffer exists and never survives a crash; the contents
+ * are never synced, leaving the page cache to write them out only under memory pressure.
+ *
+ * A SpillBuffer is not thread safe; it is meant to be used by a single publisher.
+ */
+class SpillBuffer {
+public:
+  static const int ALIGNMENT = 8;
+  static const int HEADER_LENGTH = 8;
+  static const std::size_t DEFAULT_CAPACITY = 64UL * 1024UL * 1024UL;
+
+private:
+  std::string path_;
+  std::size_t capacity_;
+  char* address_;
+  std::size_t head_;
+  std::size_t tail_;
+  std::size_t end_;
+  bool wrapped_;
+  long size_;
+
+public:
+  /**
+   * Create and map an empty scratch file.
+   *
+   * @param directory in which to create the file, which must exist.
+   * @param capacity of the file in bytes, a multiple of the page size.
+   * @throws std::system_error if the file cannot be created, allocated or mapped.
+   */
+  SpillBuffer(const std::string& directory, const std::size_t capacity = DEFAULT_CAPACITY);
+
+  /**
+   * Unmap the file, releasing its disk space.
+   */
+  ~SpillBuffer();
+
+  /**
+   * Add a record after the last one, unless there is no room for it.
+   *
+   * @param data payload of the record.
+   * @param length of the payload in bytes.
+   * @return true if the record was added, false if the buffer is too full to hold it.
+   */
+  bool append(const void* data, const int length);
+
+  /**
+   * Get the payload of the first record, which must exist.
+   *
+   * @param length set to the length of the payload in bytes.
+   * @return the payload, valid until the record is removed.
+   */
+  const char* peek(int& length) const;
+
+  /**
+   * Remove the first record, which must exist.
+   */
+  void pop();
+
+  /**
+   * Get the number of records held.
+   */
+  long getSize() const {
+    return size_;
+  }
+
+  bool isEmpty() const {
+    return 0 == size_;
+  }
+
+  std::size_t getCapacity() const {
+    return capacity_;
+  }
+
+  /**
+   * Get the path the file was created with, which no longer exists.
+   */
+  const std::string& getPath() const {
+    return path_;
+  }
+
+  SpillBuffer(const SpillBuffer&) = delete;
+  SpillBuffer& operator=(const SpillBuffer&) = delete;
+
+private:
+  void write(const std::size_t position, const void* data, const int length);
+};
+
+}
+
+#endif /* __VARONT_SPILLBUFFER_HPP__ */
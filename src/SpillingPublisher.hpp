@@ -0,0 +1,179 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_SPILLINGPUBLISHER_HPP__
+#define __VARONT_SPILLINGPUBLISHER_HPP__
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "JournalSerializer.hpp"
+#include "Metrics.hpp"
+#include "RingBuffer.hpp"
+#include "SpillBuffer.hpp"
+
+namespace varont {
+
+/**
+ * Publishes events to a {@link RingBuffer}, spilling them to a {@link SpillBuffer} instead of
+ * blocking when lagging consumers leave fewer than threshold slots free.
+ *
+ * Once anything has been spilled every later event is spilled behind it, and refill()
+ * re-injects the spilled events into the {@link RingBuffer} in publish order as consumers
+ * free capacity, so consumers see the same total order as if the producer had blocked.
+ * Every publish refills first; a producer that goes quiet should call refill() from its idle
+ * loop so that the last spilled events are not held back.  If the overflow file itself fills
+ * up the publisher falls back to blocking, draining the file before the new event.
+ *
+ * The publisher must be the only one publishing to its {@link RingBuffer}.
+ *
+ * @param <T> event implementation storing the data for sharing during exchange or parallel coordination of an event.
+ */
+template <typename T>
+class SpillingPublisher {
+  RingBuffer<T>& ringBuffer_;
+  JournalSerializer<T>& serializer_;
+  SpillBuffer spillBuffer_;
+  const long threshold_;
+  std::vector<char> buffer_;
+  PublisherMetrics metrics_;
+
+ public:
+  /**
+   * @param ringBuffer to publish to.
+   * @param serializer writing spilled events to the overflow file and reading them back.
+   * @param directory in which to create the overflow file.
+   * @param threshold of free slots below which events are spilled, between 1 and the buffer size.
+   * @param capacity of the overflow file in bytes, a multiple of the page size.
+   * @param maxRecordLength largest payload the serializer will write.
+   * @throws std::out_of_range if the threshold is outside its bounds.
+   * @throws std::system_error if the overflow file cannot be created.
+   */
+  SpillingPublisher(RingBuffer<T>& ringBuffer, JournalSerializer<T>& serializer, const std::string& directory,
+                    const long threshold = 1L, const std::size_t capacity = SpillBuffer::DEFAULT_CAPACITY,
+                    const int maxRecordLength = 4096)
+      : ringBuffer_(ringBuffer)
+      , serializer_(serializer)
+      , spillBuffer_(directory, capacity)
+      , threshold_(threshold)
+      , buffer_(maxRecordLength)
+  {
+    if (threshold < 1L || threshold > ringBuffer.getBufferSize()) {
+      throw std::out_of_range("threshold must be between 1 and the buffer size");
+    }
+  }
+
+  /**
+   * Publish a copy of an event, or spill it if the {@link RingBuffer} is short of capacity
+   * or earlier events are still spilled.
+   *
+   * @param event to publish.
+   * @return true if the event went straight to the {@link RingBuffer}, false if it was spilled.
+   * @throws std::length_error if a spilled event does not fit in maxRecordLength.
+   */
+  bool publishEvent(const T& event) {
+    refill();
+
+    if (spillBuffer_.isEmpty() && ringBuffer_.remainingCapacity() >= threshold_) {
+      publishDirect(event);
+      return true;
+    }
+
+    const int length = serializer_.serialize(event, buffer_.data(), (int)buffer_.size());
+    if (length < 0) {
+      throw std::length_error("event does not fit in the spill record buffer");
+    }
+
+    if (!spillBuffer_.append(buffer_.data(), length)) {
+      drain();
+      publishDirect(event);
+      return true;
+    }
+
+    metrics_.spilled.increment();
+    return false;
+  }
+
+  /**
+   * Re-inject as many spilled events as the {@link RingBuffer} has capacity for above the
+   * threshold, as a single batch.
+   *
+   * @return the number of events re-injected.
+   */
+  int refill() {
+    if (spillBuffer_.isEmpty()) {
+      return 0;
+    }
+
+    const long available = ringBuffer_.remainingCapacity() - threshold_ + 1L;
+    const int n = (int)std::min(available, spillBuffer_.getSize());
+    if (n <= 0) {
+      return 0;
+    }
+
+    inject(n);
+    return n;
+  }
+
+  /**
+   * Re-inject every spilled event, blocking while the {@link RingBuffer} is full.
+   */
+  void drain() {
+    while (!spillBuffer_.isEmpty()) {
+      inject((int)std::min((long)ringBuffer_.getBufferSize(), spillBuffer_.getSize()));
+    }
+  }
+
+  /**
+   * Get the number of events waiting in the overflow file.
+   */
+  long getSpilledCount() const {
+    return spillBuffer_.getSize();
+  }
+
+  /**
+   * Get the count of events written to the overflow file.
+   */
+  PublisherMetrics& getMetrics() {
+    return metrics_;
+  }
+
+  SpillingPublisher(const SpillingPublisher&) = delete;
+  SpillingPublisher& operator=(const SpillingPublisher&) = delete;
+
+ private:
+  void publishDirect(const T& event) {
+    const long sequence = ringBuffer_.next();
+    ringBuffer_.get(sequence) = event;
+    ringBuffer_.publish(sequence);
+  }
+
+  void inject(const int n) {
+    const long sequence = ringBuffer_.next(n);
+    for (long next = sequence - n + 1L; next <= sequence; ++next) {
+      int length;
+      const char* data = spillBuffer_.peek(length);
+      serializer_.deserialize(data, length, ringBuffer_.get(next));
+      spillBuffer_.pop();
+    }
+    ringBuffer_.publish(sequence, n);
+  }
+};
+
+}
+
+#endif /* __VARONT_SPILLINGPUBLISHER_HPP__ */
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <mutex>
+
+#include "Trace.hpp"
+#include "Util.hpp"
+
+namespace varont {
+namespace trace {
+
+namespace {
+
+std::mutex ringsMutex;
+std::vector<std::shared_ptr<ThreadRing> > rings;
+
+thread_local std::shared_ptr<ThreadRing> threadRing;
+
+}
+
+const char* getName(const TracePoint point) {
+  switch (point) {
+  case TracePoint::next:
+    return "next";
+  case TracePoint::publish:
+    return "publish";
+  case TracePoint::wait_for_entry:
+    return "wait_for_entry";
+  case TracePoint::wait_for_exit:
+    return "wait_for_exit";
+  case TracePoint::park:
+    return "park";
+  case TracePoint::wake:
+    return "wake";
+  case TracePoint::batch_start:
+    return "batch_start";
+  case TracePoint::batch_end:
+    return "batch_end";
+  }
+  return "unknown";
+}
+
+void ThreadRing::copyTo(std::vector<Record>& records) const {
+  const long next = next_.load(std::memory_order_acquire);
+  for (long index = std::max(0L, next - SIZE); index < next; ++index) {
+    records.push_back(records_[index & MASK]);
+  }
+}
+
+ThreadRing& currentThreadRing() {
+  if (!threadRing) {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    threadRing = std::make_shared<ThreadRing>((int)rings.size());
+    rings.push_back(threadRing);
+  }
+  return *threadRing;
+}
+
+void record(const TracePoint point, const long arg0, const long arg1) {
+  currentThreadRing().write(util::nanoTime(), point, arg0, arg1);
+}
+
+std::vector<Record> collect() {
+  std::vector<Record> records;
+  {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (std::shared_ptr<ThreadRing>& ring : rings) {
+      ring->copyTo(records);
+    }
+  }
+
+  std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+      return a.timestamp < b.timestamp;
+    });
+  return records;
+}
+
+void clear() {
+  std::lock_guard<std::mutex> lock(ringsMutex);
+  rings.erase(std::remove_if(rings.begin(), rings.end(), [](std::shared_ptr<ThreadRing>& ring) {
+        return ring.unique();
+      }), rings.end());
+  for (std::shared_ptr<ThreadRing>& ring : rings) {
+    ring->clear();
+  }
+}
+
+void writeText(std::ostream& out) {
+  for (const Record& record : collect()) {
+    out << record.timestamp << ' ' << record.thread << ' ' << getName(record.point)
+        << ' ' << record.arg0 << ' ' << record.arg1 << '\n';
+  }
+}
+
+}
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_TRACE_HPP__
+#define __VARONT_TRACE_HPP__
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+/**
+ * Trace points at the transitions of claiming, publishing, waiting and processing.
+ *
+ * VARONT_TRACE(point, arg0, arg1) compiles to nothing unless VARONT_ENABLE_TRACE is defined
+ * (configure --enable-trace).  When enabled each point is appended, with a timestamp, to
+ * a ring owned by the calling thread, and, if VARONT_HAVE_SDT is also defined, fires a
+ * USDT probe varont:point with the two arguments for perf or bpftrace:
+ *
+ * <pre>
+ *   bpftrace -e 'usdt:./app:varont:park { @[tid] = count(); }'
+ * </pre>
+ *
+ * The points and their arguments are:
+ *
+ *   next            claimed sequence, batch size
+ *   publish         published sequence, batch size
+ *   wait_for_entry  sequence waited for, 0
+ *   wait_for_exit   sequence waited for, available sequence
+ *   park            0, 0 as a waiting thread blocks or sleeps
+ *   wake            0, 0 as it resumes
+ *   batch_start     first sequence, last sequence
+ *   batch_end       last sequence processed, 0
+ *
+ * Most trace points are in inline code in the headers, so the flag must be the same for the
+ * library and for every translation unit using it; configure --enable-trace adds it to the
+ * flags of all of them.
+ *
+ * Each thread's ring holds ThreadRing::SIZE records of 32 bytes, 512 KB, allocated at its
+ * first trace point.  The ring is kept after the thread exits, so that its records can
+ * still be collected, and is only freed by the first clear() after the thread exits.
+ */
+#ifdef VARONT_ENABLE_TRACE
+#  ifdef VARONT_HAVE_SDT
+#    include <sys/sdt.h>
+#    define VARONT_TRACE_PROBE(point, arg0, arg1) DTRACE_PROBE2(varont, point, arg0, arg1)
+#  else
+#    define VARONT_TRACE_PROBE(point, arg0, arg1) do { } while (0)
+#  endif
+#  define VARONT_TRACE(point, arg0, arg1)                                      \
+  do {                                                                          \
+    ::varont::trace::record(::varont::trace::TracePoint::point, (long)(arg0), (long)(arg1)); \
+    VARONT_TRACE_PROBE(point, (long)(arg0), (long)(arg1));                     \
+  } while (0)
+#else
+#  define VARONT_TRACE(point, arg0, arg1) do { } while (0)
+#endif
+
+namespace varont {
+namespace trace {
+
+/**
+ * Named as the USDT probes they fire.
+ */
+enum class TracePoint : int {
+  next,
+  publish,
+  wait_for_entry,
+  wait_for_exit,
+  park,
+  wake,
+  batch_start,
+  batch_end
+};
+
+const char* getName(const TracePoint point);
+
+/**
+ * One trace point as held in a thread's ring.
+ */
+struct Record {
+  long timestamp;
+  long arg0;
+  long arg1;
+  int thread;
+  TracePoint point;
+};
+
+/**
+ * Fixed size ring of the most recent records of one thread.  Only the owning thread
+ * writes; older records are overwritten once the ring is full.
+ */
+class ThreadRing {
+public:
+  static const int SIZE = 1 << 14;
+  static const int MASK = SIZE - 1;
+
+private:
+  Record records_[SIZE];
+  std::atomic_long next_;
+  const int thread_;
+
+public:
+  ThreadRing(const int thread)
+    : next_(0L)
+    , thread_(thread)
+  {}
+
+  void write(const long timestamp, const TracePoint point, const long arg0, const long arg1) {
+    const long index = next_.load(std::memory_order_relaxed);
+    Record& record = records_[index & MASK];
+    record.timestamp = timestamp;
+    record.arg0 = arg0;
+    record.arg1 = arg1;
+    record.thread = thread_;
+    record.point = point;
+    next_.store(index + 1L, std::memory_order_release);
+  }
+
+  /**
+   * Append the records still held to records, oldest first.  Records written while
+   * copying may be torn, so collect once the traced threads are quiet.
+   */
+  void copyTo(std::vector<Record>& records) const;
+
+  void clear() {
+    next_.store(0L, std::memory_order_release);
+  }
+
+  ThreadRing(const ThreadRing&) = delete;
+  ThreadRing& operator=(const ThreadRing&) = delete;
+};
+
+/**
+ * Get the calling thread's ring, creating and registering it on first use.  Rings are
+ * kept after their thread exits so that its records can still be collected.
+ */
+ThreadRing& currentThreadRing();
+
+/**
+ * Append a record to the calling thread's ring.  Called through VARONT_TRACE.
+ */
+void record(const TracePoint point, const long arg0, const long arg1);
+
+/**
+ * Gather the records of every thread, ordered by timestamp.
+ */
+std::vector<Record> collect();
+
+/**
+ * Discard every thread's records.  Must not race with tracing threads.
+ */
+void clear();
+
+/**
+ * Write the collected records as text, one per line:
+ * timestamp thread point arg0 arg1.
+ */
+void writeText(std::ostream& out);
+
+}
+}
+
+#endif /* __VARONT_TRACE_HPP__ */
@@ -17,6 +17,7 @@
 #include "Sequence.hpp"
 
 #include <limits>
+#include <chrono>
 
 namespace varont {
 namespace util {
@@ -41,6 +42,53 @@ int bitCount(int v) {
   }
   return count;
 }
+long nanoTime() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long toNanos(const long timeout, const TimeUnit units) {
+  switch (units) {
+  case TimeUnit::Picoseconds:
+    return timeout / 1000L;
+  case TimeUnit::Nanoseconds:
+    return timeout;
+  case TimeUnit::Milliseconds:
+    return timeout * 1000000L;
+  case TimeUnit::Seconds:
+    return timeout * 1000000000L;
+  }
+  return timeout;
+}
+
+namespace {
+
+struct Crc32cTable {
+  uint32_t entries[256];
+
+  Crc32cTable() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc >> 1) ^ ((crc & 1u) ? 0x82f63b78u : 0u);
+      }
+      entries[i] = crc;
+    }
+  }
+};
+
+const Crc32cTable crc32cTable;
+
+}
+
+uint32_t crc32c(const void* data, const std::size_t length, const uint32_t crc) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint32_t value = ~crc;
+  for (std::size_t i = 0; i < length; ++i) {
+    value = crc32cTable.entries[(value ^ bytes[i]) & 0xffu] ^ (value >> 8);
+  }
+  return ~value;
+}
 
 }
 }
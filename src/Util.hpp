@@ -16,8 +16,12 @@
 #ifndef __VARONT_UTIL_HPP__
 #define __VARONT_UTIL_HPP__
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
+#include "TimeUnit.hpp"
+
 namespace varont {
 
 class Sequence;
@@ -34,6 +38,29 @@ long getMinimumSequence(std::vector<Sequence*>& sequences);
 
 int bitCount(int);
 
+/**
+ * Current value of a monotonic clock, in nanoseconds.  Only meaningful relative to other
+ * values returned by this function.
+ */
+long nanoTime();
+
+/**
+ * Convert a timeout to nanoseconds.
+ *
+ * @param timeout in units.
+ * @param units of the timeout.
+ * @return the timeout in nanoseconds, rounded down.
+ */
+long toNanos(const long timeout, const TimeUnit units);
+
+/**
+ * Continue a CRC-32C (Castagnoli) checksum over length bytes of data.
+ *
+ * @param crc of the preceding bytes, 0 to start.
+ * @return the checksum including data.
+ */
+uint32_t crc32c(const void* data, const std::size_t length, const uint32_t crc = 0);
+
 }
 }
 
@@ -19,11 +19,12 @@
 #include <vector>
 #include <chrono>
 
+#include "Sequence.hpp"
 #include "TimeUnit.hpp"
-#include "AlertException.hpp"
 
 namespace varont {
 class SequenceBarrier;
+struct WaitMetrics;
 
 /**
  * Strategy employed for making {@link EventProcessor}s wait on a cursor {@link Sequence}.
@@ -37,12 +38,10 @@ public:
    * @param cursor on which to wait.
    * @param dependents further back the chain that must advance first
    * @param barrier the processor is waiting on.
-   * @return the sequence that is available which may be greater than the requested sequence.
-   * @throws AlertException if the status of the Disruptor has changed.
-   * @throws InterruptedException if the thread is interrupted.
+   * @return the sequence that is available which may be greater than the requested sequence,
+   *   or SequenceBarrier::ALERTED if the status of the Disruptor has changed.
    */
-  virtual long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier)
-    throw(AlertException /*, InterruptedException */) = 0;
+  virtual long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier) = 0;
 
   /**
    * Wait for the given sequence to be available with a timeout specified.
@@ -53,19 +52,25 @@ public:
    * @param barrier the processor is waiting on.
    * @param timeout value to abort after.
    * @param sourceUnit of the timeout value.
-   * @return the sequence that is available which may be greater than the requested sequence.
-   * @throws AlertException if the status of the Disruptor has changed.
-   * @throws InterruptedException if the thread is interrupted.
+   * @return the sequence that is available which may be greater than the requested sequence,
+   *   or SequenceBarrier::ALERTED if the status of the Disruptor has changed.
    */
   virtual long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier,
-                 long timeout, TimeUnit sourceUnit)
-    throw(AlertException /*, InterruptedException */) = 0;
+                 long timeout, TimeUnit sourceUnit) = 0;
 
   /**
    * Signal those {@link EventProcessor}s waiting that the cursor has advanced.
    */
   virtual void signalAllWhenBlocking() = 0;
 
+  /**
+   * Count the times processors park, and are woken, into metrics.  Strategies that never
+   * park leave the metrics untouched.
+   *
+   * @param metrics to update, or nullptr to stop counting.
+   */
+  virtual void setMetrics(WaitMetrics* metrics) { }
+
 protected:
   ~WaitStrategy() {}
 };
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_YIELDINGWAITSTRATEGY_HPP__
+#define __VARONT_YIELDINGWAITSTRATEGY_HPP__
+
+#include <vector>
+#include <thread>
+
+#include "SequenceBarrier.hpp"
+#include "WaitStrategy.hpp"
+#include "Util.hpp"
+#include "TimeUnit.hpp"
+
+namespace varont {
+/**
+ * Yielding strategy that uses a Thread.yield() for {@link EventProcessor}s waiting on a barrier
+ * after an initially spinning.
+ *
+ * This strategy is a good compromise between performance and CPU resource without incurring significant latency spikes.
+ */
+class YieldingWaitStrategy
+  : public WaitStrategy
+{
+  static const int SPIN_TRIES = 100;
+
+public:
+  long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier)
+  {
+    long availableSequence;
+    int counter = SPIN_TRIES;
+
+    if (dependents.empty()) {
+      while ((availableSequence = cursor.get()) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        counter = applyWaitMethod(counter);
+      }
+    }
+    else {
+      while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        counter = applyWaitMethod(counter);
+      }
+    }
+
+    return availableSequence;
+  }
+
+  long waitFor(long sequence, Sequence& cursor, std::vector<Sequence*>& dependents, SequenceBarrier& barrier,
+               long timeout, TimeUnit sourceUnit)
+  {
+    const long deadline = util::nanoTime() + util::toNanos(timeout, sourceUnit);
+    long availableSequence;
+    int counter = SPIN_TRIES;
+
+    if (dependents.empty()) {
+      while ((availableSequence = cursor.get()) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        counter = applyWaitMethod(counter);
+
+        if (util::nanoTime() > deadline) {
+          break;
+        }
+      }
+    }
+    else {
+      while ((availableSequence = util::getMinimumSequence(dependents)) < sequence) {
+        if (barrier.isAlerted()) {
+          return SequenceBarrier::ALERTED;
+        }
+        counter = applyWaitMethod(counter);
+
+        if (util::nanoTime() > deadline) {
+          break;
+        }
+      }
+    }
+
+    return availableSequence;
+  }
+
+  void signalAllWhenBlocking() {
+  }
+
+  int applyWaitMethod(int counter) {
+    if (0 == counter) {
+      std::this_thread::yield();
+    }
+    else {
+      --counter;
+    }
+
+    return counter;
+  }
+};
+
+}
+
+#endif /* __VARONT_YIELDINGWAITSTRATEGY_HPP__ */
@@ -18,6 +18,8 @@
 #include <stdexcept>
 #include <string>
 #include <future>
+#include <system_error>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -33,6 +35,9 @@
 
 #include "BlockingWaitStrategy.hpp"
 #include "MultiThreadedClaimStrategy.hpp"
+#include "PublishTimestamps.hpp"
+#include "Histogram.hpp"
+#include "Metrics.hpp"
 
 #include "CountDownLatch.hpp"
 #include "CyclicBarrier.hpp"
@@ -156,5 +161,245 @@ TEST_F(BatchEventProcessorTest, shouldCallExceptionHandlerOnUncaughtException) {
   t1.join();
 }
 
+TEST_F(BatchEventProcessorTest, shouldHaltOnEventErrorWithoutThrowing) {
+  class HaltingExceptionHandler : public ExceptionHandler {
+   public:
+    void handleEventException(std::exception& ex, long sequence) { }
+    void handleOnStartException(std::exception& ex) { }
+    void handleOnShutdownException(std::exception& ex) { }
+  };
+
+  class ErrorReportingEventHandler
+      : public LifecycleAwareEventHandler<StubEvent>
+  {
+    CountDownLatch& shutdownLatch_;
+   public:
+    ErrorReportingEventHandler(CountDownLatch& shutdownLatch)
+        : shutdownLatch_(shutdownLatch)
+    { }
+
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch) { }
+
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch, std::error_code& error) {
+      if (1L == sequence) {
+        error = std::make_error_code(std::errc::io_error);
+      }
+    }
+
+    void onStart() { }
+    void onShutdown() { shutdownLatch_.countDown(); }
+  };
+
+  HaltingExceptionHandler exceptionHandler;
+  ErrorReportingEventHandler eventHandler_(latch);
+
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier.get(), eventHandler_);
+  batchEventProcessor.setExceptionHandler(exceptionHandler);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  ringBuffer.publish(ringBuffer.next());
+  ringBuffer.publish(ringBuffer.next());
+  ringBuffer.publish(ringBuffer.next());
+
+  std::thread t1(std::ref(batchEventProcessor));
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(3000)));
+  t1.join();
+
+  ASSERT_EQ(0L, batchEventProcessor.getSequence().get());
+}
+
+TEST_F(BatchEventProcessorTest, shouldReportEventErrorThroughFatalExceptionHandler) {
+  class FailingEventHandler
+      : public LifecycleAwareEventHandler<StubEvent>
+  {
+   public:
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch) { }
+
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch, std::error_code& error) {
+      error = std::make_error_code(std::errc::io_error);
+    }
+
+    void onStart() { }
+    void onShutdown() { }
+  };
+
+  FailingEventHandler eventHandler_;
+
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier.get(), eventHandler_);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  ringBuffer.publish(ringBuffer.next());
+
+  batchEventProcessor();
+
+  ASSERT_EQ((long)Sequencer::INITIAL_CURSOR_VALUE, batchEventProcessor.getSequence().get());
+}
+
+TEST_F(BatchEventProcessorTest, shouldReportAnErrorWhoseHandlerThrowsOnlyOnce) {
+  class ThrowingExceptionHandler : public ExceptionHandler {
+    std::vector<long> sequences_;
+   public:
+    void handleEventException(std::exception& ex, long sequence) {
+      sequences_.push_back(sequence);
+    }
+    bool handleEventError(const std::error_code& error, long sequence) {
+      throw std::system_error(error, "event error");
+    }
+    void handleOnStartException(std::exception& ex) { }
+    void handleOnShutdownException(std::exception& ex) { }
+
+    const std::vector<long>& sequences() const { return sequences_; }
+  };
+
+  class FailingFirstEventHandler
+      : public LifecycleAwareEventHandler<StubEvent>
+  {
+    CountDownLatch& latch_;
+   public:
+    FailingFirstEventHandler(CountDownLatch& latch)
+        : latch_(latch)
+    { }
+
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch) { }
+
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch, std::error_code& error) {
+      if (0L == sequence) {
+        error = std::make_error_code(std::errc::io_error);
+      }
+      if (2L == sequence) {
+        latch_.countDown();
+      }
+    }
+
+    void onStart() { }
+    void onShutdown() { }
+  };
+
+  ThrowingExceptionHandler exceptionHandler;
+  FailingFirstEventHandler eventHandler_(latch);
+  ProcessorMetrics metrics;
+
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier.get(), eventHandler_);
+  batchEventProcessor.setExceptionHandler(exceptionHandler);
+  batchEventProcessor.setMetrics(metrics);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  ringBuffer.publish(ringBuffer.next());
+  ringBuffer.publish(ringBuffer.next());
+  ringBuffer.publish(ringBuffer.next());
+
+  std::thread t1(std::ref(batchEventProcessor));
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(3000)));
+  batchEventProcessor.halt();
+  t1.join();
+
+  ASSERT_EQ(2L, batchEventProcessor.getSequence().get());
+  ASSERT_EQ(std::vector<long>({ 0L }), exceptionHandler.sequences());
+  ASSERT_EQ(1L, metrics.errors.get());
+  ASSERT_EQ(0L, metrics.exceptions.get());
+}
+
+TEST_F(BatchEventProcessorTest, shouldContinueWhenExceptionHandlerAcceptsEventError) {
+  class AcceptingExceptionHandler : public ExceptionHandler {
+    std::vector<long> sequences_;
+   public:
+    void handleEventException(std::exception& ex, long sequence) { }
+    bool handleEventError(const std::error_code& error, long sequence) {
+      sequences_.push_back(sequence);
+      return true;
+    }
+    void handleOnStartException(std::exception& ex) { }
+    void handleOnShutdownException(std::exception& ex) { }
+
+    const std::vector<long>& sequences() const { return sequences_; }
+  };
+
+  class FailingEventHandler
+      : public LifecycleAwareEventHandler<StubEvent>
+  {
+    CountDownLatch& latch_;
+   public:
+    FailingEventHandler(CountDownLatch& latch)
+        : latch_(latch)
+    { }
+
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch) { }
+
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch, std::error_code& error) {
+      error = std::make_error_code(std::errc::io_error);
+      if (endOfBatch) {
+        latch_.countDown();
+      }
+    }
+
+    void onStart() { }
+    void onShutdown() { }
+  };
+
+  AcceptingExceptionHandler exceptionHandler;
+  FailingEventHandler eventHandler_(latch);
+
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier.get(), eventHandler_);
+  batchEventProcessor.setExceptionHandler(exceptionHandler);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  ringBuffer.publish(ringBuffer.next());
+  ringBuffer.publish(ringBuffer.next());
+
+  std::thread t1(std::ref(batchEventProcessor));
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(3000)));
+  batchEventProcessor.halt();
+  t1.join();
+
+  ASSERT_EQ(1L, batchEventProcessor.getSequence().get());
+  ASSERT_EQ(2U, exceptionHandler.sequences().size());
+}
+
+TEST_F(BatchEventProcessorTest, shouldRecordPublishToConsumeLatency) {
+  CountDownLatch batchLatch(3);
+  class CountingEventHandler
+      : public LifecycleAwareEventHandler<StubEvent>
+  {
+    CountDownLatch& latch_;
+   public:
+    CountingEventHandler(CountDownLatch& latch)
+        : latch_(latch)
+    { }
+
+    void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+      latch_.countDown();
+    }
+
+    void onStart() { }
+    void onShutdown() { }
+  };
+
+  PublishTimestamps publishTimestamps(ringBuffer.getBufferSize());
+  ringBuffer.setPublishTimestamps(&publishTimestamps);
+
+  Histogram histogram;
+  CountingEventHandler eventHandler_(batchLatch);
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier.get(), eventHandler_);
+  batchEventProcessor.setLatencyHistogram(histogram);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  std::thread t1(std::ref(batchEventProcessor));
+
+  ringBuffer.publish(ringBuffer.next());
+  ringBuffer.publish(ringBuffer.next());
+  ringBuffer.publish(ringBuffer.next());
+
+  ASSERT_TRUE(batchLatch.await(std::chrono::milliseconds(3000)));
+  batchEventProcessor.halt();
+  t1.join();
+
+  Histogram::Snapshot snapshot = histogram.snapshot();
+  ASSERT_EQ(3L, snapshot.getTotalCount());
+  ASSERT_GE(snapshot.getMin(), 0L);
+}
+
 }
 }
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "BroadcastRingBuffer.hpp"
+#include "BroadcastReader.hpp"
+
+namespace varont {
+namespace test {
+
+struct Sample {
+  long value;
+  long check;
+};
+
+typedef BroadcastReader<Sample>::ReadStatus ReadStatus;
+
+void publishSamples(BroadcastRingBuffer<Sample>& ringBuffer, const long count) {
+  for (long i = 0; i < count; ++i) {
+    ringBuffer.publish(Sample { i, i * 3L });
+  }
+}
+
+TEST(BroadcastRingBufferTest, shouldReadEventsInOrder) {
+  BroadcastRingBuffer<Sample> ringBuffer(8);
+  BroadcastReader<Sample> reader(ringBuffer);
+  Sample sample;
+
+  ASSERT_EQ(ReadStatus::Unavailable, reader.read(sample));
+
+  publishSamples(ringBuffer, 5L);
+  for (long i = 0; i < 5L; ++i) {
+    ASSERT_EQ(ReadStatus::Ok, reader.read(sample));
+    ASSERT_EQ(i, sample.value);
+  }
+
+  ASSERT_EQ(ReadStatus::Unavailable, reader.read(sample));
+  ASSERT_EQ(5L, reader.getSequence());
+  ASSERT_EQ(0L, reader.getLostCount());
+}
+
+TEST(BroadcastRingBufferTest, shouldNotWaitForAReaderAndReportItLapped) {
+  BroadcastRingBuffer<Sample> ringBuffer(4);
+  BroadcastReader<Sample> reader(ringBuffer);
+  Sample sample;
+
+  publishSamples(ringBuffer, 10L);
+  ASSERT_EQ(9L, ringBuffer.getCursor());
+
+  ASSERT_EQ(ReadStatus::Lapped, reader.read(sample));
+  ASSERT_EQ(7L, reader.getSequence());
+  ASSERT_EQ(7L, reader.getLostCount());
+
+  for (long i = 7L; i < 10L; ++i) {
+    ASSERT_EQ(ReadStatus::Ok, reader.read(sample));
+    ASSERT_EQ(i, sample.value);
+  }
+  ASSERT_EQ(ReadStatus::Unavailable, reader.read(sample));
+}
+
+TEST(BroadcastRingBufferTest, shouldNotExposeASlotBeingWritten) {
+  BroadcastRingBuffer<Sample> ringBuffer(4);
+  BroadcastReader<Sample> reader(ringBuffer);
+  Sample sample;
+
+  const long sequence = ringBuffer.next();
+  ringBuffer.get(sequence) = Sample { 1L, 3L };
+  ASSERT_EQ(ReadStatus::Unavailable, reader.read(sample));
+
+  ringBuffer.publish(sequence);
+  ASSERT_EQ(ReadStatus::Ok, reader.read(sample));
+  ASSERT_EQ(1L, sample.value);
+}
+
+TEST(BroadcastRingBufferTest, shouldStartALateReaderAtTheNextEvent) {
+  BroadcastRingBuffer<Sample> ringBuffer(8);
+  publishSamples(ringBuffer, 3L);
+
+  BroadcastReader<Sample> reader(ringBuffer);
+  BroadcastReader<Sample> fromStart(ringBuffer, 0L);
+  Sample sample;
+
+  ASSERT_EQ(ReadStatus::Unavailable, reader.read(sample));
+  ASSERT_EQ(ReadStatus::Ok, fromStart.read(sample));
+  ASSERT_EQ(0L, sample.value);
+}
+
+TEST(BroadcastRingBufferTest, shouldOnlyReturnConsistentEventsToConcurrentReaders) {
+  const long numEvents = 1000000L;
+  const int numReaders = 3;
+  BroadcastRingBuffer<Sample> ringBuffer(8);
+  std::atomic_bool done(false);
+  std::atomic_int failures(0);
+  long counts[numReaders] = { };
+
+  std::vector<std::thread> threads;
+  for (int r = 0; r < numReaders; ++r) {
+    threads.emplace_back([&, r] {
+      BroadcastReader<Sample> reader(ringBuffer, 0L);
+      Sample sample;
+      long lastValue = -1L;
+
+      while (!done || reader.getSequence() <= ringBuffer.getCursor()) {
+        const ReadStatus status = reader.read(sample);
+        if (ReadStatus::Ok == status) {
+          if (sample.check != sample.value * 3L || sample.value <= lastValue) {
+            ++failures;
+          }
+          lastValue = sample.value;
+          ++counts[r];
+        }
+        else if (ReadStatus::Unavailable == status) {
+          std::this_thread::yield();
+        }
+      }
+
+      if (counts[r] + reader.getLostCount() != numEvents) {
+        ++failures;
+      }
+    });
+  }
+
+  publishSamples(ringBuffer, numEvents);
+  done = true;
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(0, failures.load());
+  ASSERT_EQ(numEvents - 1L, ringBuffer.getCursor());
+}
+
+}
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ByteRingBuffer.hpp"
+#include "ByteRecordHandler.hpp"
+#include "ByteRecordProcessor.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+
+namespace varont {
+namespace test {
+
+class CollectingRecordHandler
+    : public ByteRecordHandler
+{
+  const std::size_t expected_;
+  ByteRecordProcessor* processor_;
+
+ public:
+  std::vector<std::string> payloads;
+  std::vector<int> types;
+  bool lastEndOfBatch;
+
+  CollectingRecordHandler(const std::size_t expected)
+      : expected_(expected)
+      , processor_(nullptr)
+      , lastEndOfBatch(false)
+  { }
+
+  void setProcessor(ByteRecordProcessor& processor) {
+    processor_ = &processor;
+  }
+
+  void onRecord(const ByteRecord& record, long sequence, bool endOfBatch) {
+    payloads.push_back(std::string(record.data, record.length));
+    types.push_back(record.type);
+    lastEndOfBatch = endOfBatch;
+    if (expected_ == payloads.size()) {
+      processor_->halt();
+    }
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+struct ByteRingBufferTest : public testing::Test {
+ public:
+  SingleThreadedClaimStrategy claimStrategy;
+  SleepingWaitStrategy waitStrategy;
+  ByteRingBuffer ringBuffer;
+  Sequence gatingSequence;
+
+  ByteRingBufferTest()
+      : claimStrategy(8)
+      , waitStrategy()
+      , ringBuffer(claimStrategy, waitStrategy)
+      , gatingSequence(Sequencer::INITIAL_CURSOR_VALUE)
+  {
+    ringBuffer.setGatingSequences({ &gatingSequence });
+  }
+
+  long publish(const std::string& payload, const int type = 1) {
+    return ringBuffer.publish(type, payload.data(), (int)payload.size());
+  }
+};
+
+TEST_F(ByteRingBufferTest, shouldRoundRecordsUpToWholeUnits) {
+  ASSERT_EQ(1, ByteRingBuffer::getUnits(0));
+  ASSERT_EQ(2, ByteRingBuffer::getUnits(1));
+  ASSERT_EQ(2, ByteRingBuffer::getUnits(8));
+  ASSERT_EQ(3, ByteRingBuffer::getUnits(9));
+
+  ASSERT_EQ(1L, publish("hello"));
+  ASSERT_EQ(2L, publish(""));
+  ASSERT_EQ(2L, ringBuffer.getCursor());
+}
+
+TEST_F(ByteRingBufferTest, shouldGetPublishedRecordsInPlace) {
+  publish("hello", 3);
+  publish("a longer record", 4);
+
+  ByteRecord first = ringBuffer.get(0L);
+  ASSERT_EQ("hello", std::string(first.data, first.length));
+  ASSERT_EQ(3, first.type);
+
+  ByteRecord second = ringBuffer.get(2L);
+  ASSERT_EQ("a longer record", std::string(second.data, second.length));
+  ASSERT_EQ(4, second.type);
+}
+
+TEST_F(ByteRingBufferTest, shouldPadRecordsThatWouldStraddleTheEndOfTheBuffer) {
+  const std::string payload(16, 'x');
+  ASSERT_EQ(2L, publish(payload));
+  ASSERT_EQ(5L, publish(payload));
+  gatingSequence.set(5L);
+
+  ASSERT_EQ(11L, publish(payload));
+
+  ASSERT_EQ((int)ByteRingBuffer::PADDING_TYPE, ringBuffer.get(6L).type);
+  ASSERT_EQ(8, ringBuffer.get(6L).length);
+  ASSERT_EQ((int)ByteRingBuffer::PADDING_TYPE, ringBuffer.get(8L).type);
+  ASSERT_EQ(0, ringBuffer.get(8L).length);
+  ASSERT_EQ(payload, std::string(ringBuffer.get(9L).data, ringBuffer.get(9L).length));
+}
+
+TEST_F(ByteRingBufferTest, shouldClaimRecordsOfMaximumLengthAfterTheBufferWraps) {
+  const std::string payload(ringBuffer.getMaxRecordLength(), 'x');
+  ASSERT_EQ(1L, publish(std::string(8, 'a')));
+  ASSERT_EQ(5L, publish(payload));
+  gatingSequence.set(5L);
+
+  ASSERT_EQ(13L, publish(payload));
+
+  ASSERT_EQ((int)ByteRingBuffer::PADDING_TYPE, ringBuffer.get(6L).type);
+  ASSERT_EQ((int)ByteRingBuffer::PADDING_TYPE, ringBuffer.get(8L).type);
+  ASSERT_EQ(payload, std::string(ringBuffer.get(10L).data, ringBuffer.get(10L).length));
+  ASSERT_EQ(13L, ringBuffer.getCursor());
+}
+
+TEST_F(ByteRingBufferTest, shouldRejectRecordsThatCannotBeClaimed) {
+  ASSERT_EQ(24, ringBuffer.getMaxRecordLength());
+  ASSERT_THROW(ringBuffer.next(25, 1), std::out_of_range);
+  ASSERT_THROW(ringBuffer.next(-1, 1), std::out_of_range);
+  ASSERT_THROW(ringBuffer.next(8, ByteRingBuffer::PADDING_TYPE), std::out_of_range);
+  ASSERT_EQ((long)Sequencer::INITIAL_CURSOR_VALUE, ringBuffer.getCursor());
+}
+
+TEST_F(ByteRingBufferTest, shouldDeliverRecordsOfVaryingLengthToTheProcessor) {
+  const int count = 200;
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+  CollectingRecordHandler handler(count);
+  ByteRecordProcessor processor(ringBuffer, *sequenceBarrier, handler);
+  handler.setProcessor(processor);
+  ringBuffer.setGatingSequences({ &processor.getSequence() });
+
+  std::thread thread(std::ref(processor));
+
+  for (int i = 0; i < count; ++i) {
+    ByteRecordClaim claim = ringBuffer.next(i % 25, i);
+    for (int j = 0; j < claim.length; ++j) {
+      claim.data[j] = (char)('a' + (i + j) % 26);
+    }
+    ringBuffer.publish(claim);
+  }
+
+  thread.join();
+
+  ASSERT_EQ((std::size_t)count, handler.payloads.size());
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(i, handler.types[i]);
+    ASSERT_EQ((std::size_t)(i % 25), handler.payloads[i].size());
+    for (int j = 0; j < i % 25; ++j) {
+      ASSERT_EQ((char)('a' + (i + j) % 26), handler.payloads[i][j]);
+    }
+  }
+  ASSERT_TRUE(handler.lastEndOfBatch);
+  ASSERT_EQ(ringBuffer.getCursor(), processor.getSequence().get());
+}
+
+}
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "ConflatingPublisher.hpp"
+#include "ConflatingEventHandler.hpp"
+#include "BatchEventProcessor.hpp"
+#include "RingBuffer.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "YieldingWaitStrategy.hpp"
+
+namespace varont {
+namespace test {
+
+typedef ConflatedEvent<long, std::string> QuoteEvent;
+
+class RecordingHandler
+    : public ConflatingEventHandler<long, std::string>
+{
+ public:
+  std::vector<std::pair<std::string, long>> updates;
+  std::map<std::string, long> latest;
+  bool ordered;
+
+  RecordingHandler()
+      : ordered(true)
+  {}
+
+  void onUpdate(const std::string& key, const long& value, long sequence, bool endOfBatch) {
+    updates.push_back(std::make_pair(key, value));
+    if (latest.count(key) && latest[key] >= value) {
+      ordered = false;
+    }
+    latest[key] = value;
+  }
+};
+
+struct ConflatingPublisherTest : public testing::Test {
+ public:
+  SingleThreadedClaimStrategy claimStrategy;
+  YieldingWaitStrategy waitStrategy;
+  RingBuffer<QuoteEvent> ringBuffer;
+  Sequence sequence;
+  RecordingHandler handler;
+  ConflatingPublisher<long, std::string> publisher;
+
+  ConflatingPublisherTest()
+      : claimStrategy(4)
+      , ringBuffer(claimStrategy, waitStrategy)
+      , sequence((long)Sequencer::INITIAL_CURSOR_VALUE)
+      , publisher(ringBuffer)
+  {
+    ringBuffer.setGatingSequences({ &sequence });
+  }
+
+  /* Consumes every published update on the calling thread. */
+  void consume() {
+    for (long next = sequence.get() + 1L; next <= ringBuffer.getCursor(); ++next) {
+      handler.onEvent(ringBuffer.get(next), next, next == ringBuffer.getCursor());
+      sequence.set(next);
+    }
+  }
+};
+
+TEST_F(ConflatingPublisherTest, shouldReplaceAPendingUpdateForTheSameKey) {
+  ASSERT_FALSE(publisher.publish("ABC", 1L));
+  ASSERT_FALSE(publisher.publish("XYZ", 1L));
+  ASSERT_TRUE(publisher.publish("ABC", 2L));
+  ASSERT_TRUE(publisher.publish("ABC", 3L));
+
+  ASSERT_EQ(1L, ringBuffer.getCursor());
+  ASSERT_EQ(2L, publisher.getConflatedCount());
+
+  consume();
+
+  const std::vector<std::pair<std::string, long>> expected = { { "ABC", 3L }, { "XYZ", 1L } };
+  ASSERT_EQ(expected, handler.updates);
+}
+
+TEST_F(ConflatingPublisherTest, shouldClaimANewSlotOnceTheUpdateHasBeenTaken) {
+  publisher.publish("ABC", 1L);
+  consume();
+
+  ASSERT_FALSE(publisher.publish("ABC", 2L));
+  ASSERT_EQ(1L, ringBuffer.getCursor());
+
+  consume();
+  ASSERT_EQ(2L, handler.latest["ABC"]);
+}
+
+TEST_F(ConflatingPublisherTest, shouldNotOverwriteASlotReusedByAnotherKey) {
+  publisher.publish("A", 1L);
+  consume();
+
+  const char* keys[] = { "B", "C", "D" };
+  for (const char* key : keys) {
+    publisher.publish(key, 1L);
+    consume();
+  }
+
+  /* The pending update for E reuses the slot of the update taken for A. */
+  publisher.publish("E", 1L);
+  ASSERT_EQ(&ringBuffer.get(0L), &ringBuffer.get(4L));
+
+  ASSERT_FALSE(publisher.publish("A", 2L));
+  ASSERT_EQ(5L, ringBuffer.getCursor());
+
+  consume();
+  ASSERT_EQ(2L, handler.latest["A"]);
+  ASSERT_EQ(1L, handler.latest["E"]);
+}
+
+TEST_F(ConflatingPublisherTest, shouldDeliverTheLatestValueOfEachKeyToAConcurrentConsumer) {
+  SingleThreadedClaimStrategy claimStrategy(64);
+  RingBuffer<QuoteEvent> ringBuffer(claimStrategy, waitStrategy);
+  std::unique_ptr<SequenceBarrier> barrier = ringBuffer.newBarrier({ });
+  BatchEventProcessor<QuoteEvent> processor(ringBuffer, *barrier, handler);
+  ringBuffer.setGatingSequences({ &processor.getSequence() });
+  ConflatingPublisher<long, std::string> publisher(ringBuffer);
+
+  std::thread thread(std::ref(processor));
+
+  const int numKeys = 10;
+  const long numUpdates = 100000L;
+  for (long value = 0L; value < numUpdates; ++value) {
+    publisher.publish("key" + std::to_string(value % numKeys), value);
+  }
+
+  while (processor.getSequence().get() < ringBuffer.getCursor()) {
+    std::this_thread::yield();
+  }
+  processor.halt();
+  thread.join();
+
+  ASSERT_TRUE(handler.ordered);
+  ASSERT_EQ((std::size_t)numKeys, handler.latest.size());
+  for (int key = 0; key < numKeys; ++key) {
+    ASSERT_EQ(numUpdates - numKeys + key, handler.latest["key" + std::to_string(key)]);
+  }
+  ASSERT_EQ(numUpdates, ringBuffer.getCursor() + 1L + publisher.getConflatedCount());
+}
+
+}
+}
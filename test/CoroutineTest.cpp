@@ -0,0 +1,218 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "CoroutineScheduler.hpp"
+#include "CoroutineWaitStrategy.hpp"
+#include "RingBuffer.hpp"
+#include "Sequence.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+Task consume(CoroutineWaitStrategy& waitStrategy, RingBuffer<StubEvent>& ringBuffer, SequenceBarrier& barrier,
+             Sequence& sequence, std::atomic_long& sum)
+{
+  long nextSequence = sequence.get() + 1L;
+
+  for (;;) {
+    const long availableSequence = co_await waitStrategy.wait(barrier, nextSequence);
+    if (SequenceBarrier::ALERTED == availableSequence) {
+      co_return;
+    }
+
+    for (; nextSequence <= availableSequence; ++nextSequence) {
+      sum += ringBuffer.get(nextSequence).get();
+    }
+    sequence.set(availableSequence);
+  }
+}
+
+Task publish(CoroutineWaitStrategy& waitStrategy, RingBuffer<StubEvent>& ringBuffer, const int count) {
+  for (int i = 0; i < count; ++i) {
+    const long sequence = co_await waitStrategy.claim(ringBuffer);
+    ringBuffer.get(sequence).setValue(i);
+    ringBuffer.publish(sequence);
+  }
+}
+
+Task record(std::vector<std::string>& log, const std::string name) {
+  for (int i = 0; i < 3; ++i) {
+    log.push_back(name + std::to_string(i));
+    co_await CoroutineScheduler::yield();
+  }
+}
+
+long getProcessCpuNanos() {
+  struct timespec time;
+  ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return time.tv_sec * 1000000000L + time.tv_nsec;
+}
+
+struct CoroutineTest : public testing::Test {
+ public:
+  CoroutineWaitStrategy waitStrategy;
+  SingleThreadedClaimStrategy claimStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  std::unique_ptr<SequenceBarrier> barrier;
+
+  CoroutineTest()
+      : claimStrategy(8)
+      , ringBuffer(claimStrategy, waitStrategy)
+      , barrier(ringBuffer.newBarrier({ }))
+  {}
+};
+
+TEST_F(CoroutineTest, shouldRunManyConsumersOnFewThreads) {
+  const int numConsumers = 50;
+  const int numEvents = 1000;
+  std::vector<std::unique_ptr<Sequence>> sequences;
+  std::vector<Sequence*> gatingSequences;
+  std::atomic_long sums[numConsumers];
+
+  CoroutineScheduler scheduler(2);
+  for (int i = 0; i < numConsumers; ++i) {
+    sequences.emplace_back(new Sequence((long)Sequencer::INITIAL_CURSOR_VALUE));
+    gatingSequences.push_back(sequences.back().get());
+    sums[i] = 0L;
+    scheduler.spawn(consume(waitStrategy, ringBuffer, *barrier, *sequences.back(), sums[i]));
+  }
+  ringBuffer.setGatingSequences(gatingSequences);
+
+  for (int i = 0; i < numEvents; ++i) {
+    const long sequence = ringBuffer.next();
+    ringBuffer.get(sequence).setValue(i);
+    ringBuffer.publish(sequence);
+  }
+
+  while (util::getMinimumSequence(gatingSequences) < numEvents - 1L) {
+    std::this_thread::yield();
+  }
+  barrier->alert();
+  scheduler.join();
+
+  for (int i = 0; i < numConsumers; ++i) {
+    ASSERT_EQ(numEvents * (numEvents - 1L) / 2L, sums[i].load());
+  }
+}
+
+TEST_F(CoroutineTest, shouldWaitForCapacityWhenClaiming) {
+  const int numEvents = 100;
+  Sequence sequence((long)Sequencer::INITIAL_CURSOR_VALUE);
+  std::atomic_long sum(0L);
+  ringBuffer.setGatingSequences({ &sequence });
+
+  CoroutineScheduler scheduler(1);
+  scheduler.spawn(publish(waitStrategy, ringBuffer, numEvents));
+  scheduler.spawn(consume(waitStrategy, ringBuffer, *barrier, sequence, sum));
+
+  while (sequence.get() < numEvents - 1L) {
+    std::this_thread::yield();
+  }
+  barrier->alert();
+  scheduler.join();
+
+  ASSERT_EQ(numEvents - 1L, ringBuffer.getCursor());
+  ASSERT_EQ(numEvents * (numEvents - 1L) / 2L, sum.load());
+}
+
+TEST_F(CoroutineTest, shouldNotSpinWhileWaitingForDependentProcessors) {
+  Sequence dependentSequence((long)Sequencer::INITIAL_CURSOR_VALUE);
+  Sequence sequence((long)Sequencer::INITIAL_CURSOR_VALUE);
+  std::unique_ptr<SequenceBarrier> dependentBarrier = ringBuffer.newBarrier({ &dependentSequence });
+  std::atomic_long sum(0L);
+  ringBuffer.setGatingSequences({ &sequence });
+
+  const long published = ringBuffer.next();
+  ringBuffer.get(published).setValue(7);
+  ringBuffer.publish(published);
+
+  CoroutineScheduler scheduler(1);
+  scheduler.spawn(consume(waitStrategy, ringBuffer, *dependentBarrier, sequence, sum));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  const long start = getProcessCpuNanos();
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_GT(20000000L, getProcessCpuNanos() - start);
+
+  dependentSequence.set(published);
+  while (sequence.get() < published) {
+    std::this_thread::yield();
+  }
+  dependentBarrier->alert();
+  scheduler.join();
+
+  ASSERT_EQ(7L, sum.load());
+}
+
+TEST_F(CoroutineTest, shouldNotSpinWhileWaitingForCapacity) {
+  Sequence sequence((long)Sequencer::INITIAL_CURSOR_VALUE);
+  ringBuffer.setGatingSequences({ &sequence });
+
+  CoroutineScheduler scheduler(1);
+  scheduler.spawn(publish(waitStrategy, ringBuffer, 9));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_EQ(7L, ringBuffer.getCursor());
+
+  const long start = getProcessCpuNanos();
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_GT(20000000L, getProcessCpuNanos() - start);
+
+  sequence.set(0L);
+  scheduler.join();
+
+  ASSERT_EQ(8L, ringBuffer.getCursor());
+}
+
+TEST_F(CoroutineTest, shouldResumeAParkedWaiterWhenAlerted) {
+  Sequence sequence((long)Sequencer::INITIAL_CURSOR_VALUE);
+  std::atomic_long sum(0L);
+  ringBuffer.setGatingSequences({ &sequence });
+
+  CoroutineScheduler scheduler(1);
+  scheduler.spawn(consume(waitStrategy, ringBuffer, *barrier, sequence, sum));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  barrier->alert();
+  scheduler.join();
+
+  ASSERT_EQ((long)Sequencer::INITIAL_CURSOR_VALUE, sequence.get());
+}
+
+TEST_F(CoroutineTest, shouldTakeTurnsWhenYielding) {
+  std::vector<std::string> log;
+
+  CoroutineScheduler scheduler(1);
+  scheduler.spawn(record(log, "a"));
+  scheduler.spawn(record(log, "b"));
+  scheduler.join();
+
+  ASSERT_EQ(std::vector<std::string>({ "a0", "b0", "a1", "b1", "a2", "b2" }), log);
+}
+
+}
+}
@@ -41,7 +41,7 @@ public:
    */
   void await() {
     std::unique_lock<std::mutex> lock(m_);
-    if (0 < count_) {
+    while (0 < count_) {
       cond_.wait(lock);
     }
   }
@@ -54,13 +54,8 @@ public:
    */
   bool await(std::chrono::milliseconds duration) {
     std::unique_lock<std::mutex> lock(m_);
-    if (0 < count_) {
-      return std::cv_status::no_timeout == cond_.wait_for(lock, duration);
-    }
-    else {
-      /* count reached zero */
-      return true;
-    }
+    /* count reached zero */
+    return cond_.wait_for(lock, duration, [this] { return 0 == count_; });
   }
 
   /**
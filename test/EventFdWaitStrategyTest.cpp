@@ -0,0 +1,205 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <chrono>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "EventFdWaitStrategy.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "BatchEventProcessor.hpp"
+#include "EventPoller.hpp"
+#include "RingBuffer.hpp"
+
+#include "CountDownLatch.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+class LatchEventHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+{
+  CountDownLatch& latch_;
+ public:
+  LatchEventHandler(CountDownLatch& latch)
+      : latch_(latch)
+  { }
+
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    latch_.countDown();
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+class NullPollHandler
+    : public EventPoller<StubEvent>::Handler
+{
+ public:
+  bool onEvent(StubEvent& event, long sequence, bool endOfBatch) { return true; }
+};
+
+struct EventFdWaitStrategyTest : public testing::Test {
+ public:
+  SingleThreadedClaimStrategy claimStrategy;
+  EventFdWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+
+  EventFdWaitStrategyTest()
+      : claimStrategy(16)
+      , waitStrategy()
+      , ringBuffer(claimStrategy, waitStrategy)
+  { }
+
+  bool isReadable(int timeoutMillis) {
+    struct pollfd pfd = { waitStrategy.getFd(), POLLIN, 0 };
+    return 1 == ::poll(&pfd, 1, timeoutMillis);
+  }
+};
+
+TEST_F(EventFdWaitStrategyTest, shouldNotSignalWithoutSleepers) {
+  EventPoller<StubEvent> poller(ringBuffer, { });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+
+  ringBuffer.publish(ringBuffer.next());
+
+  ASSERT_FALSE(isReadable(0));
+}
+
+TEST_F(EventFdWaitStrategyTest, shouldSignalAnnouncedSleeper) {
+  EventPoller<StubEvent> poller(ringBuffer, { });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+  NullPollHandler handler;
+
+  waitStrategy.beginSleep();
+  ASSERT_EQ(EventPoller<StubEvent>::PollState::Idle, poller.poll(handler));
+
+  std::thread publisher([&] {
+      ringBuffer.publish(ringBuffer.next());
+    });
+
+  ASSERT_TRUE(isReadable(3000));
+  waitStrategy.endSleep();
+  publisher.join();
+
+  ASSERT_FALSE(isReadable(0));
+  ASSERT_EQ(EventPoller<StubEvent>::PollState::Processing, poller.poll(handler));
+}
+
+TEST_F(EventFdWaitStrategyTest, shouldLeaveOneWakeUpPerSleeper) {
+  EventPoller<StubEvent> poller(ringBuffer, { });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+
+  waitStrategy.beginSleep();
+  waitStrategy.beginSleep();
+  ringBuffer.publish(ringBuffer.next());
+
+  /* The first sleeper to leave must not take the second sleeper's wake-up. */
+  waitStrategy.endSleep();
+  ASSERT_TRUE(isReadable(0));
+
+  waitStrategy.endSleep();
+  ASSERT_FALSE(isReadable(0));
+}
+
+TEST_F(EventFdWaitStrategyTest, shouldHoldOneWakeUpPerSleeperWhateverIsPublished) {
+  EventPoller<StubEvent> poller(ringBuffer, { });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+  NullPollHandler handler;
+
+  waitStrategy.beginSleep();
+  for (int i = 0; i < 10; ++i) {
+    ringBuffer.publish(ringBuffer.next());
+  }
+  waitStrategy.endSleep();
+  ASSERT_FALSE(isReadable(0));
+
+  poller.poll(handler);
+  waitStrategy.beginSleep();
+  for (int i = 0; i < 10; ++i) {
+    ringBuffer.publish(ringBuffer.next());
+  }
+
+  uint64_t value;
+  ASSERT_EQ((ssize_t)sizeof(value), ::read(waitStrategy.getFd(), &value, sizeof(value)));
+  ASSERT_EQ(1UL, value);
+  ASSERT_FALSE(isReadable(0));
+}
+
+TEST_F(EventFdWaitStrategyTest, shouldConvertTimeoutToSourceUnit) {
+  EventPoller<StubEvent> poller(ringBuffer, { });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ((long)Sequencer::INITIAL_CURSOR_VALUE, sequenceBarrier->waitFor(0L, 20000000L, TimeUnit::Nanoseconds));
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  ASSERT_LE(std::chrono::milliseconds(20), elapsed);
+  ASSERT_GT(std::chrono::milliseconds(2000), elapsed);
+}
+
+TEST_F(EventFdWaitStrategyTest, shouldWakeAndHaltBatchEventProcessor) {
+  CountDownLatch latch(2);
+  LatchEventHandler handler(latch);
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier.get(), handler);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  std::thread t1(std::ref(batchEventProcessor));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  ringBuffer.publish(ringBuffer.next());
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  ringBuffer.publish(ringBuffer.next());
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(3000)));
+
+  batchEventProcessor.halt();
+  t1.join();
+}
+
+TEST_F(EventFdWaitStrategyTest, shouldLeaveTheEventFdEmptyAfterABurst) {
+  const int count = 200000;
+  SingleThreadedClaimStrategy burstClaimStrategy(1024);
+  RingBuffer<StubEvent> burstRingBuffer(burstClaimStrategy, waitStrategy);
+  CountDownLatch latch(count);
+  LatchEventHandler handler(latch);
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = burstRingBuffer.newBarrier({ });
+  BatchEventProcessor<StubEvent> batchEventProcessor(burstRingBuffer, *sequenceBarrier.get(), handler);
+  burstRingBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  std::thread t1(std::ref(batchEventProcessor));
+
+  for (int i = 0; i < count; ++i) {
+    burstRingBuffer.publish(burstRingBuffer.next());
+  }
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(10000)));
+  batchEventProcessor.halt();
+  t1.join();
+
+  ASSERT_FALSE(isReadable(0));
+}
+
+}
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "EventPoller.hpp"
+#include "RingBuffer.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+class CollectingHandler
+    : public EventPoller<StubEvent>::Handler
+{
+  const int limit_;
+ public:
+  std::vector<int> values;
+
+  CollectingHandler(int limit = -1)
+      : limit_(limit)
+  { }
+
+  bool onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    values.push_back(event.get());
+    return limit_ < 0 || (int)values.size() < limit_;
+  }
+};
+
+/* Throws on the first event with the failing value, then accepts it when polled again. */
+class FailingHandler
+    : public EventPoller<StubEvent>::Handler
+{
+  int failOn_;
+ public:
+  std::vector<int> values;
+
+  FailingHandler(int failOn)
+      : failOn_(failOn)
+  { }
+
+  bool onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    if (event.get() == failOn_) {
+      failOn_ = -1;
+      throw std::runtime_error("handler failed");
+    }
+    values.push_back(event.get());
+    return true;
+  }
+};
+
+struct EventPollerTest : public testing::Test {
+ public:
+  typedef EventPoller<StubEvent>::PollState PollState;
+
+  SingleThreadedClaimStrategy claimStrategy;
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  Sequence gatingSequence;
+
+  EventPollerTest()
+      : claimStrategy(16)
+      , waitStrategy()
+      , ringBuffer(claimStrategy, waitStrategy)
+      , gatingSequence(Sequencer::INITIAL_CURSOR_VALUE)
+  { }
+
+  void publish(int value) {
+    long sequence = ringBuffer.next();
+    ringBuffer.get(sequence).setValue(value);
+    ringBuffer.publish(sequence);
+  }
+};
+
+TEST_F(EventPollerTest, shouldPollForEvents) {
+  EventPoller<StubEvent> poller(ringBuffer, { });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+  CollectingHandler handler;
+
+  ASSERT_EQ(PollState::Idle, poller.poll(handler));
+
+  publish(7);
+  publish(8);
+
+  ASSERT_EQ(PollState::Processing, poller.poll(handler));
+  ASSERT_EQ(2U, handler.values.size());
+  ASSERT_EQ(7, handler.values[0]);
+  ASSERT_EQ(8, handler.values[1]);
+  ASSERT_EQ(1L, poller.getSequence().get());
+
+  ASSERT_EQ(PollState::Idle, poller.poll(handler));
+}
+
+TEST_F(EventPollerTest, shouldReportGatingWhenDependentSequenceIsBehind) {
+  EventPoller<StubEvent> poller(ringBuffer, { &gatingSequence });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+  CollectingHandler handler;
+
+  publish(1);
+
+  ASSERT_EQ(PollState::Gating, poller.poll(handler));
+  ASSERT_TRUE(handler.values.empty());
+
+  gatingSequence.set(0L);
+
+  ASSERT_EQ(PollState::Processing, poller.poll(handler));
+  ASSERT_EQ(1U, handler.values.size());
+}
+
+TEST_F(EventPollerTest, shouldStopWhenHandlerReturnsFalse) {
+  EventPoller<StubEvent> poller(ringBuffer, { });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+  CollectingHandler handler(1);
+
+  publish(1);
+  publish(2);
+  publish(3);
+
+  ASSERT_EQ(PollState::Processing, poller.poll(handler));
+  ASSERT_EQ(0L, poller.getSequence().get());
+
+  ASSERT_EQ(PollState::Processing, poller.poll(handler));
+  ASSERT_EQ(1L, poller.getSequence().get());
+  ASSERT_EQ(2U, handler.values.size());
+}
+
+TEST_F(EventPollerTest, shouldAdvanceOverHandledEventsWhenHandlerThrows) {
+  EventPoller<StubEvent> poller(ringBuffer, { });
+  ringBuffer.setGatingSequences({ &poller.getSequence() });
+  FailingHandler handler(2);
+
+  publish(1);
+  publish(2);
+  publish(3);
+
+  ASSERT_THROW(poller.poll(handler), std::runtime_error);
+  ASSERT_EQ(0L, poller.getSequence().get());
+  ASSERT_EQ(std::vector<int>({ 1 }), handler.values);
+
+  ASSERT_EQ(PollState::Processing, poller.poll(handler));
+  ASSERT_EQ(2L, poller.getSequence().get());
+  ASSERT_EQ(std::vector<int>({ 1, 2, 3 }), handler.values);
+}
+
+}
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "EventPublisher.hpp"
+#include "EventTranslator.hpp"
+#include "OverflowHandler.hpp"
+#include "RingBuffer.hpp"
+#include "Sequence.hpp"
+#include "MultiThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+/* Translates consecutive values starting at value. */
+class ValueTranslator
+    : public EventTranslator<StubEvent>
+{
+ public:
+  int value;
+
+  void translateTo(StubEvent& event, long sequence) {
+    event.setValue(value++);
+  }
+};
+
+class RecordingOverflowHandler
+    : public OverflowHandler<StubEvent>
+{
+ public:
+  std::vector<int> values;
+
+  void onOverflow(EventTranslator<StubEvent>& translator, int n) {
+    for (int i = 0; i < n; ++i) {
+      StubEvent event(0);
+      translator.translateTo(event, i);
+      values.push_back(event.get());
+    }
+  }
+};
+
+struct EventPublisherTest : public testing::Test {
+ public:
+  MultiThreadedClaimStrategy claimStrategy;
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  Sequence gatingSequence;
+  ValueTranslator translator;
+
+  EventPublisherTest()
+      : claimStrategy(4)
+      , ringBuffer(claimStrategy, waitStrategy)
+      , gatingSequence((long)Sequencer::INITIAL_CURSOR_VALUE)
+  {
+    ringBuffer.setGatingSequences({ &gatingSequence });
+  }
+
+  bool publish(EventPublisher<StubEvent>& publisher, const int value) {
+    translator.value = value;
+    return publisher.publishEvent(translator);
+  }
+};
+
+TEST_F(EventPublisherTest, shouldDropTheNewestEventsWhenFull) {
+  EventPublisher<StubEvent> publisher(ringBuffer, BackPressurePolicy::DropNewest);
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(publish(publisher, i));
+  }
+  ASSERT_FALSE(publish(publisher, 4));
+  ASSERT_FALSE(publish(publisher, 5));
+
+  ASSERT_EQ(3L, ringBuffer.getCursor());
+  ASSERT_EQ(3, ringBuffer.get(3L).get());
+  ASSERT_EQ(2L, publisher.getMetrics().dropped.get());
+  ASSERT_EQ(0L, publisher.getMetrics().timedOut.get());
+}
+
+TEST_F(EventPublisherTest, shouldGiveUpAfterTheTimeout) {
+  EventPublisher<StubEvent> publisher(ringBuffer, BackPressurePolicy::BlockWithTimeout, 1000000L);
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(publish(publisher, i));
+  }
+
+  const long start = util::nanoTime();
+  ASSERT_FALSE(publish(publisher, 4));
+  ASSERT_LE(1000000L, util::nanoTime() - start);
+  ASSERT_EQ(1L, publisher.getMetrics().timedOut.get());
+}
+
+TEST_F(EventPublisherTest, shouldPublishOnceASlotIsFreedWithinTheTimeout) {
+  EventPublisher<StubEvent> publisher(ringBuffer, BackPressurePolicy::BlockWithTimeout, 5000000000L);
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(publish(publisher, i));
+  }
+
+  std::thread consumer([this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    gatingSequence.set(0L);
+  });
+  ASSERT_TRUE(publish(publisher, 4));
+  consumer.join();
+
+  ASSERT_EQ(4, ringBuffer.get(4L).get());
+  ASSERT_EQ(0L, publisher.getMetrics().timedOut.get());
+}
+
+TEST_F(EventPublisherTest, shouldRedirectEventsThatDoNotFit) {
+  RecordingOverflowHandler overflowHandler;
+  EventPublisher<StubEvent> publisher(ringBuffer, BackPressurePolicy::Redirect, 0L, &overflowHandler);
+
+  translator.value = 10;
+  ASSERT_TRUE(publisher.publishEvents(translator, 3));
+
+  translator.value = 20;
+  ASSERT_FALSE(publisher.publishEvents(translator, 2));
+
+  ASSERT_EQ(2L, ringBuffer.getCursor());
+  ASSERT_EQ(12, ringBuffer.get(2L).get());
+  ASSERT_EQ(std::vector<int>({ 20, 21 }), overflowHandler.values);
+  ASSERT_EQ(2L, publisher.getMetrics().redirected.get());
+}
+
+TEST_F(EventPublisherTest, shouldBlockUntilASlotIsFreed) {
+  EventPublisher<StubEvent> publisher(ringBuffer);
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(publish(publisher, i));
+  }
+
+  std::thread consumer([this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    gatingSequence.set(0L);
+  });
+  ASSERT_TRUE(publish(publisher, 4));
+  consumer.join();
+
+  ASSERT_EQ(4L, ringBuffer.getCursor());
+}
+
+TEST_F(EventPublisherTest, shouldRequireAnOverflowHandlerToRedirect) {
+  ASSERT_THROW(EventPublisher<StubEvent>(ringBuffer, BackPressurePolicy::Redirect), std::out_of_range);
+}
+
+}
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Histogram.hpp"
+
+namespace varont {
+namespace test {
+
+TEST(HistogramTest, shouldMapValuesToContiguousBuckets) {
+  for (int index = 0; index < Histogram::BUCKET_COUNT; ++index) {
+    const long lowest = Histogram::lowestEquivalentValue(index);
+    const long highest = Histogram::highestEquivalentValue(index);
+
+    ASSERT_EQ(index, Histogram::indexOf(lowest));
+    ASSERT_EQ(index, Histogram::indexOf(highest));
+    if (index + 1 < Histogram::BUCKET_COUNT) {
+      ASSERT_EQ(highest + 1L, Histogram::lowestEquivalentValue(index + 1));
+    }
+  }
+}
+
+TEST(HistogramTest, shouldReportPercentilesWithinPrecision) {
+  Histogram histogram;
+  for (long value = 1; value <= 100000; ++value) {
+    histogram.record(value * 1000L);
+  }
+
+  Histogram::Snapshot snapshot = histogram.snapshot();
+
+  ASSERT_EQ(100000L, snapshot.getTotalCount());
+  ASSERT_EQ(1000L, snapshot.getMin());
+  ASSERT_EQ(100000000L, snapshot.getMax());
+  ASSERT_NEAR(50000500.0, snapshot.getMean(), 1.0);
+  ASSERT_NEAR(50000000.0, (double)snapshot.getValueAtPercentile(50.0), 50000000.0 * 0.01);
+  ASSERT_NEAR(99000000.0, (double)snapshot.getValueAtPercentile(99.0), 99000000.0 * 0.01);
+  ASSERT_EQ(100000000L, snapshot.getValueAtPercentile(100.0));
+}
+
+TEST(HistogramTest, shouldRecordFromSeveralThreads) {
+  Histogram histogram;
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 4; ++t) {
+    threads.push_back(std::thread([&histogram] {
+          for (long value = 0; value < 10000; ++value) {
+            histogram.record(value);
+          }
+        }));
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(40000L, histogram.snapshot().getTotalCount());
+
+  histogram.reset();
+  ASSERT_EQ(0L, histogram.snapshot().getTotalCount());
+}
+
+}
+}
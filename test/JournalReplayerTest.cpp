@@ -0,0 +1,204 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Journal.hpp"
+#include "JournalReader.hpp"
+#include "JournalReplayer.hpp"
+#include "ReplaySkippingEventHandler.hpp"
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+
+#include "support/JournalTestSupport.hpp"
+
+namespace varont {
+namespace test {
+
+class RecordingEventHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+{
+ public:
+  std::vector<long> sequences;
+  std::vector<int> values;
+
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    sequences.push_back(sequence);
+    values.push_back(event.get());
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+/* Passes events on to every handler, in order. */
+class PairEventHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+{
+  LifecycleAwareEventHandler<StubEvent>& first_;
+  LifecycleAwareEventHandler<StubEvent>& second_;
+
+ public:
+  PairEventHandler(LifecycleAwareEventHandler<StubEvent>& first, LifecycleAwareEventHandler<StubEvent>& second)
+      : first_(first)
+      , second_(second)
+  { }
+
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    first_.onEvent(event, sequence, endOfBatch);
+    second_.onEvent(event, sequence, endOfBatch);
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+struct JournalReplayerTest : public testing::Test {
+ public:
+  static const std::size_t SEGMENT_SIZE = 4096;
+
+  TemporaryDirectory directory;
+  StubEventSerializer serializer;
+
+  SingleThreadedClaimStrategy claimStrategy;
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  std::unique_ptr<SequenceBarrier> sequenceBarrier;
+
+  JournalReplayerTest()
+      : claimStrategy(16)
+      , waitStrategy()
+      , ringBuffer(claimStrategy, waitStrategy)
+      , sequenceBarrier(ringBuffer.newBarrier({ }))
+  { }
+
+  void journal(const long count) {
+    Journal journal(directory.getPath(), SEGMENT_SIZE);
+    char buffer[16];
+    for (long sequence = 0; sequence < count; ++sequence) {
+      const int length = serializer.serialize(StubEvent((int)sequence * 2), buffer, sizeof(buffer));
+      journal.append(sequence, buffer, length);
+    }
+    journal.sync();
+  }
+
+  void waitForSequence(BatchEventProcessor<StubEvent>& batchEventProcessor, const long sequence) {
+    while (batchEventProcessor.getSequence().get() < sequence) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+TEST_F(JournalReplayerTest, shouldReadRecordsInBatchesAcrossSegments) {
+  journal(1000);
+  ASSERT_LT(1U, Journal::listSegments(directory.getPath()).size());
+
+  JournalReader reader(directory.getPath());
+  std::vector<JournalRecord> records;
+  long expected = 0L;
+  int count;
+  while (0 != (count = reader.read(records, 64))) {
+    ASSERT_GE(64, count);
+    for (const JournalRecord& record : records) {
+      ASSERT_EQ(expected++, record.sequence);
+    }
+  }
+
+  ASSERT_EQ(1000L, expected);
+}
+
+TEST_F(JournalReplayerTest, shouldReadFromASequence) {
+  journal(1000);
+
+  JournalReader reader(directory.getPath(), 700L);
+  std::vector<JournalRecord> records;
+
+  ASSERT_LT(0, reader.read(records, 8));
+  ASSERT_EQ(700L, records[0].sequence);
+}
+
+TEST_F(JournalReplayerTest, shouldReplayThenContinueWithLiveEvents) {
+  journal(100);
+
+  JournalReplayer<StubEvent> replayer(directory.getPath(), ringBuffer, serializer, 8);
+  RecordingEventHandler stateHandler;
+  RecordingEventHandler outputHandler;
+  ReplaySkippingEventHandler<StubEvent> skippingHandler(outputHandler, replayer.getReplayedSequence());
+  PairEventHandler handler(stateHandler, skippingHandler);
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  std::thread thread(std::ref(batchEventProcessor));
+
+  ASSERT_EQ(99L, replayer.replay());
+
+  const long sequence = ringBuffer.next();
+  ringBuffer.get(sequence).setValue(-1);
+  ringBuffer.publish(sequence);
+
+  waitForSequence(batchEventProcessor, 100L);
+  batchEventProcessor.halt();
+  thread.join();
+
+  ASSERT_EQ(101U, stateHandler.values.size());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(i * 2, stateHandler.values[i]);
+  }
+  ASSERT_EQ(std::vector<long>({ 100L }), outputHandler.sequences);
+}
+
+TEST_F(JournalReplayerTest, shouldReplayFromAPositionedSequence) {
+  journal(50);
+
+  JournalReplayer<StubEvent> replayer(directory.getPath(), ringBuffer, serializer, 8, 20L);
+  RecordingEventHandler handler;
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  replayer.positionAt(20L, { &batchEventProcessor.getSequence() });
+  ASSERT_EQ(19L, ringBuffer.getCursor());
+
+  std::thread thread(std::ref(batchEventProcessor));
+
+  ASSERT_EQ(49L, replayer.replay());
+
+  waitForSequence(batchEventProcessor, 49L);
+  batchEventProcessor.halt();
+  thread.join();
+
+  ASSERT_EQ(30U, handler.sequences.size());
+  ASSERT_EQ(20L, handler.sequences.front());
+  ASSERT_EQ(40, handler.values.front());
+}
+
+TEST_F(JournalReplayerTest, shouldRefuseToReplayAtTheWrongSequence) {
+  journal(50);
+
+  JournalReplayer<StubEvent> replayer(directory.getPath(), ringBuffer, serializer, 8, 20L);
+  Sequence gatingSequence(Sequencer::INITIAL_CURSOR_VALUE);
+  ringBuffer.setGatingSequences({ &gatingSequence });
+
+  ASSERT_THROW(replayer.replay(), IllegalStateException);
+  ASSERT_EQ((long)Sequencer::INITIAL_CURSOR_VALUE, ringBuffer.getCursor());
+}
+
+}
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Journal.hpp"
+#include "JournalEventHandler.hpp"
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+
+#include "support/JournalTestSupport.hpp"
+
+namespace varont {
+namespace test {
+
+struct JournalTest : public testing::Test {
+ public:
+  static const std::size_t SEGMENT_SIZE = 4096;
+
+  TemporaryDirectory directory;
+
+  static void append(Journal& journal, const long sequence, const int length = 8) {
+    const std::vector<char> payload(length, (char)sequence);
+    journal.append(sequence, payload.data(), length);
+  }
+};
+
+TEST_F(JournalTest, shouldSyncAppendedRecordsAsAGroup) {
+  Journal journal(directory.getPath(), SEGMENT_SIZE);
+  ASSERT_EQ(-1L, journal.getLastSequence());
+
+  append(journal, 0L);
+  append(journal, 1L);
+
+  ASSERT_EQ(1L, journal.getLastSequence());
+  ASSERT_EQ(-1L, journal.getSyncedSequence());
+
+  journal.sync();
+
+  ASSERT_EQ(1L, journal.getSyncedSequence());
+  ASSERT_EQ(std::vector<long>({ 0L, 1L }), readJournalSequences(directory.getPath()));
+}
+
+TEST_F(JournalTest, shouldRollToANewSegmentWhenARecordDoesNotFit) {
+  Journal journal(directory.getPath(), SEGMENT_SIZE);
+
+  for (long sequence = 0; sequence < 10; ++sequence) {
+    append(journal, sequence, 1000);
+  }
+  journal.sync();
+
+  std::vector<std::string> segments = Journal::listSegments(directory.getPath());
+  ASSERT_EQ(3U, segments.size());
+  ASSERT_EQ(0L, Journal::getFirstSequence(segments[0]));
+  ASSERT_EQ(4L, Journal::getFirstSequence(segments[1]));
+  ASSERT_EQ(8L, Journal::getFirstSequence(segments[2]));
+  ASSERT_EQ(10U, readJournalSequences(directory.getPath()).size());
+}
+
+TEST_F(JournalTest, shouldRejectRecordsLargerThanASegment) {
+  Journal journal(directory.getPath(), SEGMENT_SIZE);
+
+  ASSERT_THROW(append(journal, 0L, journal.getMaxRecordLength() + 1), std::out_of_range);
+}
+
+TEST_F(JournalTest, shouldContinueAfterTheLastRecordWhenReopened) {
+  {
+    Journal journal(directory.getPath(), SEGMENT_SIZE);
+    append(journal, 0L);
+    append(journal, 1L);
+  }
+
+  Journal journal(directory.getPath(), SEGMENT_SIZE);
+  ASSERT_EQ(1L, journal.getLastSequence());
+  ASSERT_EQ(1L, journal.getSyncedSequence());
+
+  append(journal, 2L);
+  journal.sync();
+
+  ASSERT_EQ(std::vector<long>({ 0L, 1L, 2L }), readJournalSequences(directory.getPath()));
+}
+
+TEST_F(JournalTest, shouldDiscardATornRecordWhenReopened) {
+  {
+    Journal journal(directory.getPath(), SEGMENT_SIZE);
+    append(journal, 0L);
+    append(journal, 1L);
+    append(journal, 2L);
+  }
+
+  /* Corrupt the payload of the second record. */
+  const std::string path = Journal::listSegments(directory.getPath())[0];
+  std::fstream segment(path, std::ios::in | std::ios::out | std::ios::binary);
+  segment.seekp(Journal::getRecordLength(8) + Journal::HEADER_LENGTH);
+  segment.put('x');
+  segment.close();
+
+  Journal journal(directory.getPath(), SEGMENT_SIZE);
+  ASSERT_EQ(0L, journal.getLastSequence());
+
+  append(journal, 1L, 100);
+  journal.sync();
+
+  ASSERT_EQ(std::vector<long>({ 0L, 1L }), readJournalSequences(directory.getPath()));
+}
+
+TEST_F(JournalTest, shouldAdvanceTheDurableSequenceAtTheEndOfEachBatch) {
+  Journal journal(directory.getPath(), SEGMENT_SIZE);
+  StubEventSerializer serializer;
+  JournalEventHandler<StubEvent> handler(journal, serializer, 64);
+
+  SingleThreadedClaimStrategy claimStrategy(16);
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer(claimStrategy, waitStrategy);
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  ASSERT_EQ(-1L, handler.getDurableSequence().get());
+
+  std::thread thread(std::ref(batchEventProcessor));
+
+  for (int i = 0; i < 100; ++i) {
+    const long sequence = ringBuffer.next();
+    ringBuffer.get(sequence).setValue(i);
+    ringBuffer.publish(sequence);
+  }
+
+  std::unique_ptr<SequenceBarrier> durableBarrier = ringBuffer.newBarrier({ &handler.getDurableSequence() });
+  ASSERT_EQ(99L, durableBarrier->waitFor(99L));
+
+  batchEventProcessor.halt();
+  thread.join();
+
+  ASSERT_EQ(99L, journal.getSyncedSequence());
+  ASSERT_EQ(100U, readJournalSequences(directory.getPath()).size());
+}
+
+}
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <gtest/gtest.h>
+
+#include "MetricsRegistry.hpp"
+#include "Metrics.hpp"
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "BlockingWaitStrategy.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+class NoOpEventHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+{
+ public:
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) { }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+struct MetricsRegistryTest : public testing::Test {
+ public:
+  SingleThreadedClaimStrategy claimStrategy;
+  BlockingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  Sequence gatingSequence;
+  ProducerMetrics producerMetrics;
+  WaitMetrics waitMetrics;
+  MetricsRegistry registry;
+
+  MetricsRegistryTest()
+      : claimStrategy(8)
+      , waitStrategy()
+      , ringBuffer(claimStrategy, waitStrategy)
+      , gatingSequence(Sequencer::INITIAL_CURSOR_VALUE)
+  {
+    ringBuffer.setGatingSequences({ &gatingSequence });
+    claimStrategy.setMetrics(&producerMetrics);
+    waitStrategy.setMetrics(&waitMetrics);
+    registry.addRingBuffer("orders", ringBuffer, &producerMetrics, &waitMetrics);
+  }
+
+  void publish(const int count) {
+    for (int i = 0; i < count; ++i) {
+      ringBuffer.publish(ringBuffer.next());
+    }
+  }
+
+  bool contains(const std::string& line) {
+    return std::string::npos != registry.toPrometheusText().find(line + "\n");
+  }
+
+  template <typename Predicate>
+  static bool eventually(Predicate predicate) {
+    for (int i = 0; i < 5000 && !predicate(); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return predicate();
+  }
+};
+
+TEST_F(MetricsRegistryTest, shouldCountProducerStallsWhenFull) {
+  publish(8);
+  ASSERT_EQ(0L, producerMetrics.stalls.get());
+
+  std::thread publisher([this] { publish(1); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  gatingSequence.set(0L);
+  publisher.join();
+
+  ASSERT_EQ(1L, producerMetrics.stalls.get());
+  ASSERT_LT(0L, producerMetrics.stallNanos.get());
+  ASSERT_TRUE(contains("varont_producer_stalls_total{ring_buffer=\"orders\"} 1"));
+}
+
+TEST_F(MetricsRegistryTest, shouldReportLagAndRemainingCapacity) {
+  Sequence processorSequence(Sequencer::INITIAL_CURSOR_VALUE);
+  registry.addProcessor("orders", "journal", ringBuffer, processorSequence);
+
+  publish(3);
+
+  ASSERT_TRUE(contains("varont_ring_buffer_cursor{ring_buffer=\"orders\"} 2"));
+  ASSERT_TRUE(contains("varont_ring_buffer_remaining_capacity{ring_buffer=\"orders\"} 5"));
+  ASSERT_TRUE(contains("varont_processor_lag{ring_buffer=\"orders\",processor=\"journal\"} 3"));
+
+  processorSequence.set(1L);
+
+  ASSERT_TRUE(contains("varont_processor_lag{ring_buffer=\"orders\",processor=\"journal\"} 1"));
+}
+
+TEST_F(MetricsRegistryTest, shouldRecordBatchSizesParksAndWakeups) {
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+  NoOpEventHandler handler;
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+  ProcessorMetrics processorMetrics;
+  batchEventProcessor.setMetrics(processorMetrics);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+  registry.addProcessor("orders", "journal", ringBuffer, batchEventProcessor.getSequence(), &processorMetrics);
+
+  publish(3);
+
+  std::thread thread(std::ref(batchEventProcessor));
+
+  ASSERT_TRUE(eventually([&] { return 0L < waitMetrics.parks.get(); }));
+  publish(1);
+  ASSERT_TRUE(eventually([&] { return 3L == batchEventProcessor.getSequence().get(); }));
+
+  batchEventProcessor.halt();
+  thread.join();
+
+  ASSERT_LE(1L, waitMetrics.wakeups.get());
+  ASSERT_EQ(2L, processorMetrics.batchSizes.snapshot().getTotalCount());
+  ASSERT_TRUE(contains("varont_processor_batch_size_sum{ring_buffer=\"orders\",processor=\"journal\"} 4"));
+  ASSERT_TRUE(contains("varont_processor_batch_size_count{ring_buffer=\"orders\",processor=\"journal\"} 2"));
+  ASSERT_TRUE(contains("varont_processor_batch_size{ring_buffer=\"orders\",processor=\"journal\",quantile=\"0.999\"} 3"));
+  ASSERT_TRUE(contains("varont_processor_lag{ring_buffer=\"orders\",processor=\"journal\"} 0"));
+}
+
+TEST_F(MetricsRegistryTest, shouldEscapeLabelValues) {
+  Sequence processorSequence(Sequencer::INITIAL_CURSOR_VALUE);
+  registry.addProcessor("orders", "say \"hi\"\\", ringBuffer, processorSequence);
+
+  ASSERT_TRUE(contains("varont_processor_lag{ring_buffer=\"orders\",processor=\"say \\\"hi\\\"\\\\\"} 0"));
+}
+
+TEST_F(MetricsRegistryTest, shouldWriteSnapshotToFileAndUnixSocket) {
+  char directory[] = "/tmp/varont-metrics-XXXXXX";
+  ASSERT_NE(nullptr, ::mkdtemp(directory));
+  const std::string filePath = std::string(directory) + "/varont.prom";
+  const std::string socketPath = std::string(directory) + "/metrics.sock";
+
+  publish(2);
+  const std::string expected = registry.toPrometheusText();
+
+  registry.writeFile(filePath);
+
+  std::ifstream file(filePath);
+  std::stringstream fileContents;
+  fileContents << file.rdbuf();
+  ASSERT_EQ(expected, fileContents.str());
+  ASSERT_NE(0, ::access((filePath + ".tmp").c_str(), F_OK));
+
+  const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_NE(-1, listener);
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(0, ::bind(listener, (struct sockaddr*)&address, sizeof(address)));
+  ASSERT_EQ(0, ::listen(listener, 1));
+
+  std::string received;
+  std::thread reader([&] {
+      const int connection = ::accept(listener, nullptr, nullptr);
+      char buffer[1024];
+      ssize_t n;
+      while ((n = ::read(connection, buffer, sizeof(buffer))) > 0) {
+        received.append(buffer, n);
+      }
+      ::close(connection);
+    });
+
+  registry.sendToUnixSocket(socketPath);
+  reader.join();
+  ::close(listener);
+
+  ASSERT_EQ(expected, received);
+
+  ::unlink(socketPath.c_str());
+  ::unlink(filePath.c_str());
+  ::rmdir(directory);
+}
+
+TEST_F(MetricsRegistryTest, shouldThrowWhenSocketCannotBeReached) {
+  ASSERT_THROW(registry.sendToUnixSocket("/nonexistent/varont.sock"), std::system_error);
+}
+
+}
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <mutex>
+
+#include <gtest/gtest.h>
+
+#include "MultiBufferBatchEventProcessor.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+#include "BlockingWaitStrategy.hpp"
+#include "Metrics.hpp"
+#include "RingBuffer.hpp"
+
+#include "CountDownLatch.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+class RecordingEventHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+{
+  CountDownLatch& latch_;
+  std::mutex mutex_;
+  std::vector<int> values_;
+ public:
+  RecordingEventHandler(CountDownLatch& latch)
+      : latch_(latch)
+  { }
+
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      values_.push_back(event.get());
+    }
+    latch_.countDown();
+  }
+
+  std::vector<int> values() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_;
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+struct MultiBufferBatchEventProcessorTest : public testing::Test {
+ public:
+  SingleThreadedClaimStrategy claimStrategy0;
+  SingleThreadedClaimStrategy claimStrategy1;
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer0;
+  RingBuffer<StubEvent> ringBuffer1;
+  std::unique_ptr<SequenceBarrier> sequenceBarrier0;
+  std::unique_ptr<SequenceBarrier> sequenceBarrier1;
+  std::vector<RingBuffer<StubEvent>*> ringBuffers;
+  std::vector<SequenceBarrier*> sequenceBarriers;
+
+  MultiBufferBatchEventProcessorTest()
+      : claimStrategy0(16)
+      , claimStrategy1(16)
+      , waitStrategy()
+      , ringBuffer0(claimStrategy0, waitStrategy)
+      , ringBuffer1(claimStrategy1, waitStrategy)
+      , sequenceBarrier0(ringBuffer0.newBarrier({ }))
+      , sequenceBarrier1(ringBuffer1.newBarrier({ }))
+      , ringBuffers({ &ringBuffer0, &ringBuffer1 })
+      , sequenceBarriers({ sequenceBarrier0.get(), sequenceBarrier1.get() })
+  { }
+
+  void gate(MultiBufferBatchEventProcessor<StubEvent>& processor) {
+    ringBuffer0.setGatingSequences({ &processor.getSequence(0) });
+    ringBuffer1.setGatingSequences({ &processor.getSequence(1) });
+  }
+
+  void publish(RingBuffer<StubEvent>& ringBuffer, int value) {
+    long sequence = ringBuffer.next();
+    ringBuffer.get(sequence).setValue(value);
+    ringBuffer.publish(sequence);
+  }
+};
+
+TEST_F(MultiBufferBatchEventProcessorTest, shouldConsumeEventsFromEveryRingBuffer) {
+  CountDownLatch latch(4);
+  RecordingEventHandler handler(latch);
+  MultiBufferBatchEventProcessor<StubEvent> processor(ringBuffers, sequenceBarriers, handler);
+  gate(processor);
+
+  std::thread t1(std::ref(processor));
+
+  publish(ringBuffer0, 0);
+  publish(ringBuffer1, 10);
+  publish(ringBuffer1, 11);
+  publish(ringBuffer0, 1);
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(3000)));
+  processor.halt();
+  t1.join();
+
+  ASSERT_EQ(1L, processor.getSequence(0).get());
+  ASSERT_EQ(1L, processor.getSequence(1).get());
+
+  std::vector<int> values = handler.values();
+  ASSERT_EQ(4U, values.size());
+}
+
+TEST_F(MultiBufferBatchEventProcessorTest, shouldServiceRingBuffersInPriorityOrder) {
+  CountDownLatch latch(6);
+  RecordingEventHandler handler(latch);
+  MultiBufferBatchEventProcessor<StubEvent> processor(ringBuffers, sequenceBarriers, handler,
+                                                      ProcessingOrder::Priority);
+  gate(processor);
+
+  publish(ringBuffer1, 10);
+  publish(ringBuffer1, 11);
+  publish(ringBuffer1, 12);
+  publish(ringBuffer0, 0);
+  publish(ringBuffer0, 1);
+  publish(ringBuffer0, 2);
+
+  std::thread t1(std::ref(processor));
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(3000)));
+  processor.halt();
+  t1.join();
+
+  std::vector<int> expected = { 0, 1, 2, 10, 11, 12 };
+  ASSERT_EQ(expected, handler.values());
+}
+
+TEST_F(MultiBufferBatchEventProcessorTest, shouldParkThroughTheWaitStrategiesWhenIdle) {
+  SingleThreadedClaimStrategy claimStrategy2(16);
+  SingleThreadedClaimStrategy claimStrategy3(16);
+  BlockingWaitStrategy blockingWaitStrategy;
+  RingBuffer<StubEvent> ringBuffer2(claimStrategy2, blockingWaitStrategy);
+  RingBuffer<StubEvent> ringBuffer3(claimStrategy3, blockingWaitStrategy);
+  std::unique_ptr<SequenceBarrier> sequenceBarrier2(ringBuffer2.newBarrier({ }));
+  std::unique_ptr<SequenceBarrier> sequenceBarrier3(ringBuffer3.newBarrier({ }));
+  std::vector<RingBuffer<StubEvent>*> blockingRingBuffers({ &ringBuffer2, &ringBuffer3 });
+  std::vector<SequenceBarrier*> blockingSequenceBarriers({ sequenceBarrier2.get(), sequenceBarrier3.get() });
+  WaitMetrics waitMetrics;
+  blockingWaitStrategy.setMetrics(&waitMetrics);
+
+  CountDownLatch latch(2);
+  RecordingEventHandler handler(latch);
+  MultiBufferBatchEventProcessor<StubEvent> processor(blockingRingBuffers, blockingSequenceBarriers, handler);
+  ringBuffer2.setGatingSequences({ &processor.getSequence(0) });
+  ringBuffer3.setGatingSequences({ &processor.getSequence(1) });
+
+  std::thread t1(std::ref(processor));
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(3000);
+  while (0L == waitMetrics.parks.get() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const long firstParks = waitMetrics.parks.get();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  /* Each park lasts up to a millisecond, rather than the processor spinning. */
+  const long parks = waitMetrics.parks.get() - firstParks;
+  EXPECT_LT(0L, firstParks);
+  EXPECT_GT(1000L, parks);
+
+  publish(ringBuffer2, 1);
+  publish(ringBuffer3, 2);
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(3000)));
+  processor.halt();
+  t1.join();
+}
+
+TEST_F(MultiBufferBatchEventProcessorTest, shouldBeManagedAsAnEventProcessor) {
+  CountDownLatch latch(1);
+  RecordingEventHandler handler(latch);
+  MultiBufferBatchEventProcessor<StubEvent> processor(ringBuffers, sequenceBarriers, handler);
+  gate(processor);
+  EventProcessor& eventProcessor = processor;
+
+  std::thread t1(std::ref(eventProcessor));
+  publish(ringBuffer1, 1);
+
+  ASSERT_TRUE(latch.await(std::chrono::milliseconds(3000)));
+  eventProcessor.halt();
+  t1.join();
+
+  ASSERT_THROW(eventProcessor.getSequence(), IllegalStateException);
+}
+
+}
+}
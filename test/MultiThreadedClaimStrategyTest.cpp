@@ -147,6 +147,14 @@ TEST_F(MultiThreadedClaimStrategyTest, shouldThrowExceptionIfCapacityIsNotAvaila
   EXPECT_THROW(claimStrategy.checkAndIncrement(9, 1, dependentSequences), InsufficientCapacityException);
 }
 
+TEST_F(MultiThreadedClaimStrategyTest, shouldReturnInsufficientCapacityIfCapacityIsNotAvailable) {
+  Sequence dependentSequence;
+  std::vector<Sequence*> dependentSequences = { &dependentSequence };
+
+  EXPECT_EQ((long)ClaimStrategy::INSUFFICIENT_CAPACITY, claimStrategy.checkAndIncrement(9, 1, dependentSequences, std::nothrow));
+  EXPECT_EQ(3L, claimStrategy.checkAndIncrement(4, 4, dependentSequences, std::nothrow));
+}
+
 TEST_F(MultiThreadedClaimStrategyTest, shouldSuccessfullyGetNextValueIfLessThanCapacityIsAvailable) {
   Sequence dependentSequence;
   std::vector<Sequence*> dependentSequences = { &dependentSequence };
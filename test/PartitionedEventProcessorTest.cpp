@@ -0,0 +1,183 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "PartitionedEventProcessor.hpp"
+#include "SequenceGroup.hpp"
+#include "KeyHasher.hpp"
+#include "RingBuffer.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "YieldingWaitStrategy.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+const int NUM_KEYS = 13;
+
+/* The key of an event is its value modulo NUM_KEYS. */
+class StubEventKeyHasher
+    : public KeyHasher<StubEvent>
+{
+ public:
+  std::size_t hash(const StubEvent& event) {
+    return event.get() % NUM_KEYS;
+  }
+};
+
+class RecordingHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+{
+ public:
+  std::vector<int> values;
+  std::vector<long> batchEnds;
+
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    values.push_back(event.get());
+    if (endOfBatch) {
+      batchEnds.push_back(sequence);
+    }
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+TEST(SequenceGroupTest, shouldStandForTheMinimumOfItsMembers) {
+  Sequence a(5L);
+  Sequence b(3L);
+  SequenceGroup group;
+
+  ASSERT_EQ((long)Sequencer::INITIAL_CURSOR_VALUE, group.get());
+
+  group.add(a);
+  group.add(b);
+  ASSERT_EQ(2, group.size());
+  ASSERT_EQ(3L, group.get());
+
+  b.set(7L);
+  ASSERT_EQ(5L, group.get());
+
+  group.set(9L);
+  ASSERT_EQ(9L, a.get());
+  ASSERT_EQ(9L, b.get());
+}
+
+TEST(PartitionedEventProcessorTest, shouldHandleEachKeyInOrderOnExactlyOneProcessor) {
+  const int numPartitions = 4;
+  const int numEvents = 10000;
+
+  SingleThreadedClaimStrategy claimStrategy(64);
+  YieldingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer(claimStrategy, waitStrategy);
+  std::unique_ptr<SequenceBarrier> barrier = ringBuffer.newBarrier({ });
+  StubEventKeyHasher keyHasher;
+
+  RecordingHandler handlers[numPartitions];
+  std::vector<std::unique_ptr<PartitionedEventProcessor<StubEvent>>> processors;
+  SequenceGroup group;
+  for (int i = 0; i < numPartitions; ++i) {
+    processors.emplace_back(
+        new PartitionedEventProcessor<StubEvent>(ringBuffer, *barrier, handlers[i], keyHasher, i, numPartitions));
+    group.add(processors.back()->getSequence());
+  }
+  ringBuffer.setGatingSequences({ &group });
+
+  std::vector<std::thread> threads;
+  for (std::unique_ptr<PartitionedEventProcessor<StubEvent>>& processor : processors) {
+    threads.emplace_back(std::ref(*processor));
+  }
+
+  for (int i = 0; i < numEvents; ++i) {
+    const long sequence = ringBuffer.next();
+    ringBuffer.get(sequence).setValue(i);
+    ringBuffer.publish(sequence);
+  }
+
+  while (group.get() < numEvents - 1L) {
+    std::this_thread::yield();
+  }
+  for (std::unique_ptr<PartitionedEventProcessor<StubEvent>>& processor : processors) {
+    processor->halt();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::size_t total = 0;
+  for (int i = 0; i < numPartitions; ++i) {
+    std::map<int, int> lastValueByKey;
+    for (int value : handlers[i].values) {
+      const int key = value % NUM_KEYS;
+      ASSERT_EQ(i, key % numPartitions);
+      if (lastValueByKey.count(key)) {
+        ASSERT_EQ(lastValueByKey[key] + NUM_KEYS, value);
+      }
+      lastValueByKey[key] = value;
+    }
+    total += handlers[i].values.size();
+  }
+  ASSERT_EQ((std::size_t)numEvents, total);
+}
+
+TEST(PartitionedEventProcessorTest, shouldEndTheBatchOnTheLastEventOfThePartition) {
+  SingleThreadedClaimStrategy claimStrategy(16);
+  YieldingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer(claimStrategy, waitStrategy);
+  std::unique_ptr<SequenceBarrier> barrier = ringBuffer.newBarrier({ });
+  StubEventKeyHasher keyHasher;
+  RecordingHandler handler;
+  PartitionedEventProcessor<StubEvent> processor(ringBuffer, *barrier, handler, keyHasher, 0, 2);
+  ringBuffer.setGatingSequences({ &processor.getSequence() });
+
+  /* Keys 0, 1, 2, 3, 5: partition 0 owns sequences 0 and 2. */
+  const int values[] = { 0, 1, 2, 3, 5 };
+  for (int value : values) {
+    const long sequence = ringBuffer.next();
+    ringBuffer.get(sequence).setValue(value);
+    ringBuffer.publish(sequence);
+  }
+
+  std::thread thread(std::ref(processor));
+  while (processor.getSequence().get() < 4L) {
+    std::this_thread::yield();
+  }
+  processor.halt();
+  thread.join();
+
+  ASSERT_EQ(std::vector<int>({ 0, 2 }), handler.values);
+  ASSERT_EQ(std::vector<long>({ 2L }), handler.batchEnds);
+}
+
+TEST(PartitionedEventProcessorTest, shouldRejectAPartitionOutsideTheGroup) {
+  SingleThreadedClaimStrategy claimStrategy(16);
+  YieldingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer(claimStrategy, waitStrategy);
+  std::unique_ptr<SequenceBarrier> barrier = ringBuffer.newBarrier({ });
+  StubEventKeyHasher keyHasher;
+  RecordingHandler handler;
+
+  ASSERT_THROW(PartitionedEventProcessor<StubEvent>(ringBuffer, *barrier, handler, keyHasher, 2, 2), std::out_of_range);
+}
+
+}
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ProcessorScheduler.hpp"
+#include "ScheduledEventProcessor.hpp"
+#include "RingBuffer.hpp"
+#include "EventFdWaitStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+class RecordingHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+{
+ public:
+  const std::string name;
+  std::vector<std::string>& log;
+  std::vector<long> batchEnds;
+  std::atomic_long sum;
+  std::atomic_long lastSequence;
+  int startCount;
+  int shutdownCount;
+
+  RecordingHandler(const std::string& name, std::vector<std::string>& log)
+      : name(name)
+      , log(log)
+      , sum(0L)
+      , lastSequence((long)Sequencer::INITIAL_CURSOR_VALUE)
+      , startCount(0)
+      , shutdownCount(0)
+  {}
+
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    log.push_back(name + std::to_string(sequence));
+    if (endOfBatch) {
+      batchEnds.push_back(sequence);
+    }
+    sum += event.get();
+    lastSequence = sequence;
+  }
+
+  void onStart() {
+    ++startCount;
+  }
+
+  void onShutdown() {
+    ++shutdownCount;
+  }
+};
+
+/* A ring buffer and the unit consuming from it. */
+template <typename W>
+struct Stage {
+  SingleThreadedClaimStrategy claimStrategy;
+  W waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  std::unique_ptr<SequenceBarrier> barrier;
+  RecordingHandler handler;
+  ScheduledEventProcessor<StubEvent> processor;
+
+  Stage(const std::string& name, std::vector<std::string>& log)
+      : claimStrategy(16)
+      , ringBuffer(claimStrategy, waitStrategy)
+      , barrier(ringBuffer.newBarrier({ }))
+      , handler(name, log)
+      , processor(ringBuffer, *barrier, handler)
+  {
+    ringBuffer.setGatingSequences({ &processor.getSequence() });
+  }
+
+  void publish(const int count) {
+    for (int i = 0; i < count; ++i) {
+      const long sequence = ringBuffer.next();
+      ringBuffer.get(sequence).setValue(i);
+      ringBuffer.publish(sequence);
+    }
+  }
+};
+
+template <typename W>
+void awaitSequence(Stage<W>& stage, const long sequence) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (stage.handler.lastSequence < sequence && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
+TEST(ProcessorSchedulerTest, shouldLimitEachCallToTheQuantum) {
+  std::vector<std::string> log;
+  Stage<SleepingWaitStrategy> stage("a", log);
+  stage.publish(10);
+
+  ASSERT_EQ(4, stage.processor.process(4));
+  ASSERT_EQ(4, stage.processor.process(4));
+  ASSERT_EQ(2, stage.processor.process(4));
+  ASSERT_EQ(0, stage.processor.process(4));
+
+  ASSERT_EQ(std::vector<long>({ 3L, 7L, 9L }), stage.handler.batchEnds);
+  ASSERT_EQ(9L, stage.processor.getSequence().get());
+}
+
+TEST(ProcessorSchedulerTest, shouldServiceUnitsInTurn) {
+  std::vector<std::string> log;
+  Stage<SleepingWaitStrategy> a("a", log);
+  Stage<SleepingWaitStrategy> b("b", log);
+  a.publish(3);
+  b.publish(3);
+
+  ProcessorScheduler scheduler(1, ProcessingOrder::RoundRobin);
+  scheduler.add(a.processor);
+  scheduler.add(b.processor);
+  std::thread thread(std::ref(scheduler));
+
+  awaitSequence(a, 2L);
+  awaitSequence(b, 2L);
+  scheduler.halt();
+  thread.join();
+
+  ASSERT_EQ(std::vector<std::string>({ "a0", "b0", "a1", "b1", "a2", "b2" }), log);
+}
+
+TEST(ProcessorSchedulerTest, shouldServiceEarlierUnitsFirstInPriorityOrder) {
+  std::vector<std::string> log;
+  Stage<SleepingWaitStrategy> a("a", log);
+  Stage<SleepingWaitStrategy> b("b", log);
+  a.publish(3);
+  b.publish(3);
+
+  ProcessorScheduler scheduler(1, ProcessingOrder::Priority);
+  scheduler.add(a.processor);
+  scheduler.add(b.processor);
+  std::thread thread(std::ref(scheduler));
+
+  awaitSequence(b, 2L);
+  scheduler.halt();
+  thread.join();
+
+  ASSERT_EQ(std::vector<std::string>({ "a0", "a1", "a2", "b0", "b1", "b2" }), log);
+  ASSERT_EQ(1, a.handler.startCount);
+  ASSERT_EQ(1, b.handler.shutdownCount);
+}
+
+TEST(ProcessorSchedulerTest, shouldParkOnEveryEventFdAndWakeOnAnyPublish) {
+  const int numStages = 20;
+  std::vector<std::string> logs[numStages];
+  std::vector<std::unique_ptr<Stage<EventFdWaitStrategy>>> stages;
+
+  ProcessorScheduler scheduler(8);
+  for (int i = 0; i < numStages; ++i) {
+    stages.emplace_back(new Stage<EventFdWaitStrategy>(std::to_string(i), logs[i]));
+    scheduler.add(stages.back()->processor, stages.back()->waitStrategy);
+  }
+  std::thread thread(std::ref(scheduler));
+
+  for (int round = 0; round < 5; ++round) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    for (std::unique_ptr<Stage<EventFdWaitStrategy>>& stage : stages) {
+      stage->publish(10);
+    }
+  }
+
+  for (std::unique_ptr<Stage<EventFdWaitStrategy>>& stage : stages) {
+    awaitSequence(*stage, 49L);
+  }
+  scheduler.halt();
+  thread.join();
+
+  for (std::unique_ptr<Stage<EventFdWaitStrategy>>& stage : stages) {
+    ASSERT_EQ(50U, stage->handler.log.size());
+    ASSERT_EQ(5L * 45L, stage->handler.sum.load());
+  }
+}
+
+TEST(ProcessorSchedulerTest, shouldNotParkWhileWaitingForDependents) {
+  const int numHops = 11;
+  std::vector<std::string> log;
+  SingleThreadedClaimStrategy claimStrategy(16);
+  EventFdWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer(claimStrategy, waitStrategy);
+  Sequence dependentSequence((long)Sequencer::INITIAL_CURSOR_VALUE);
+  std::unique_ptr<SequenceBarrier> barrier = ringBuffer.newBarrier({ &dependentSequence });
+  RecordingHandler handler("a", log);
+  ScheduledEventProcessor<StubEvent> processor(ringBuffer, *barrier, handler);
+  ringBuffer.setGatingSequences({ &processor.getSequence() });
+
+  ProcessorScheduler scheduler;
+  scheduler.add(processor, waitStrategy);
+  std::thread thread(std::ref(scheduler));
+
+  /* Parked, each hop would wait for the poll begun at the publish to time out, about 8 ms. */
+  std::vector<long> latencies;
+  for (long sequence = 0L; sequence < numHops; ++sequence) {
+    ringBuffer.publish(ringBuffer.next());
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+    const auto start = std::chrono::steady_clock::now();
+    dependentSequence.set(sequence);
+    while (handler.lastSequence < sequence) {
+      std::this_thread::yield();
+    }
+    latencies.push_back(
+      (long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  scheduler.halt();
+  thread.join();
+
+  std::sort(latencies.begin(), latencies.end());
+  ASSERT_GT(4000L, latencies[numHops / 2]);
+}
+
+TEST(ProcessorSchedulerTest, shouldHaltWhileParked) {
+  std::vector<std::string> log;
+  Stage<EventFdWaitStrategy> stage("a", log);
+
+  ProcessorScheduler scheduler;
+  scheduler.add(stage.processor, stage.waitStrategy);
+  std::thread thread(std::ref(scheduler));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  scheduler.halt();
+  thread.join();
+
+  ASSERT_EQ(1, stage.handler.shutdownCount);
+}
+
+}
+}
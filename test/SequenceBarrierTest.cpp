@@ -225,6 +225,33 @@ TEST_F(SequenceBarrierTest, shouldInterruptDuringBusySpin) {
   ASSERT_TRUE(alerted);
 }
 
+TEST_F(SequenceBarrierTest, shouldReturnAlertedWithoutThrowingDuringBusySpin) {
+  long expectedNumberMessages = 10;
+  fillRingBuffer(expectedNumberMessages);
+
+  CountDownLatch latch(3);
+  CountDownLatchSequence sequence1(8, latch);
+  CountDownLatchSequence sequence2(8, latch);
+  CountDownLatchSequence sequence3(8, latch);
+
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({
+      &sequence1,
+      &sequence2,
+      &sequence3
+    });
+
+  long availableSequence = 0;
+  std::thread t1([&] {
+      availableSequence = sequenceBarrier->waitFor(expectedNumberMessages - 1, std::nothrow);
+    });
+
+  latch.await(std::chrono::milliseconds(3000));
+  sequenceBarrier->alert();
+  t1.join();
+
+  ASSERT_EQ((long)SequenceBarrier::ALERTED, availableSequence);
+}
+
 TEST_F(SequenceBarrierTest, shouldWaitForWorkCompleteWhereCompleteWorkThresholdIsBehind) {
   long expectedNumberMessages = 10;
   fillRingBuffer(expectedNumberMessages);
@@ -183,6 +183,33 @@ TEST_F(SequencerTest, shouldRejectAvailableCapacityLessThanOne) {
   EXPECT_THROW(sequencer.tryNext(0), std::out_of_range);
 }
 
+TEST_F(SequencerTest, shouldReturnInsufficientCapacityWithoutThrowingWhenSequencerIsFull) {
+  EXPECT_EQ((long)Sequencer::INSUFFICIENT_CAPACITY, sequencer.tryNext(5, std::nothrow));
+
+  fillBuffer();
+  EXPECT_EQ((long)Sequencer::INSUFFICIENT_CAPACITY, sequencer.tryNext(1, std::nothrow));
+  EXPECT_EQ(3L, sequencer.getCursor());
+}
+
+TEST_F(SequencerTest, shouldTryToClaimSequencesWithoutThrowing) {
+  EXPECT_EQ(0L, sequencer.tryNext(1, std::nothrow));
+  sequencer.publish(0L);
+
+  BatchDescriptor batchDescriptor(3);
+  EXPECT_TRUE(sequencer.tryNext(batchDescriptor, std::nothrow));
+  EXPECT_EQ(1L, batchDescriptor.getStart());
+  EXPECT_EQ(3L, batchDescriptor.getEnd());
+  sequencer.publish(batchDescriptor);
+
+  BatchDescriptor fullBatchDescriptor(1);
+  EXPECT_FALSE(sequencer.tryNext(fullBatchDescriptor, std::nothrow));
+  EXPECT_EQ(3L, sequencer.getCursor());
+
+  gatingSequence.set(1L);
+  EXPECT_TRUE(sequencer.tryNext(fullBatchDescriptor, std::nothrow));
+  EXPECT_EQ(4L, fullBatchDescriptor.getEnd());
+}
+
 TEST_F(SequencerTest, shouldCalculateRemainingCapacity) {
   EXPECT_EQ(4L, sequencer.remainingCapacity());
   sequencer.publish(sequencer.next());
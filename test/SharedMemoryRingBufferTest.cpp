@@ -0,0 +1,259 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <gtest/gtest.h>
+
+#include "SharedMemory.hpp"
+#include "SharedMemoryRingBuffer.hpp"
+
+namespace varont {
+namespace test {
+
+struct Quote {
+  long instrument;
+  double price;
+};
+
+struct SharedMemoryRingBufferTest : public testing::Test {
+ public:
+  typedef SharedMemoryRingBuffer<Quote> QuoteRingBuffer;
+
+  std::string name;
+
+  SharedMemoryRingBufferTest()
+      : name("/varont-test-" + std::to_string(::getpid()))
+  { }
+
+  static void publish(QuoteRingBuffer& ringBuffer, const long instrument, const double price) {
+    const long sequence = ringBuffer.next();
+    Quote& quote = ringBuffer.get(sequence);
+    quote.instrument = instrument;
+    quote.price = price;
+    ringBuffer.publish(sequence);
+  }
+};
+
+TEST_F(SharedMemoryRingBufferTest, shouldShareEntriesWithAnAttachedInstance) {
+  std::unique_ptr<QuoteRingBuffer> creator = QuoteRingBuffer::create(name, 8, 2);
+  std::unique_ptr<QuoteRingBuffer> attached = QuoteRingBuffer::attach(name);
+
+  ASSERT_EQ(8, attached->getBufferSize());
+  ASSERT_EQ(2, attached->getMaxConsumers());
+  ASSERT_EQ(-1L, attached->getCursor());
+
+  publish(*creator, 7L, 1.5);
+
+  ASSERT_EQ(0L, attached->getCursor());
+  ASSERT_EQ(7L, attached->get(0L).instrument);
+  ASSERT_EQ(1.5, attached->get(0L).price);
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldRejectAttachingToAMissingSegment) {
+  ASSERT_THROW(QuoteRingBuffer::attach(name, 5L, TimeUnit::Milliseconds), std::system_error);
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldWaitForTheSegmentToBeCreated) {
+  std::unique_ptr<QuoteRingBuffer> attached;
+  std::thread attacher([&] {
+      attached = QuoteRingBuffer::attach(name, 5L, TimeUnit::Seconds);
+    });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::unique_ptr<QuoteRingBuffer> creator = QuoteRingBuffer::create(name, 8, 2);
+  attacher.join();
+
+  ASSERT_EQ(8, attached->getBufferSize());
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldRejectCreatingAnExistingSegment) {
+  std::unique_ptr<QuoteRingBuffer> creator = QuoteRingBuffer::create(name, 8, 1);
+
+  ASSERT_THROW(QuoteRingBuffer::create(name, 8, 1), std::system_error);
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldRejectEventsOfADifferentSize) {
+  std::unique_ptr<QuoteRingBuffer> creator = QuoteRingBuffer::create(name, 8, 1);
+
+  ASSERT_THROW(SharedMemoryRingBuffer<long>::attach(name), std::runtime_error);
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldWaitForTheCreatorToLayOutTheSegment) {
+  const std::string layoutName = name + "-layout";
+  std::unique_ptr<QuoteRingBuffer> layout = QuoteRingBuffer::create(layoutName, 8, 2);
+  std::unique_ptr<SharedMemory> source(SharedMemory::attach(layoutName));
+  const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  ASSERT_NE(-1, fd);
+
+  std::unique_ptr<QuoteRingBuffer> attached;
+  std::thread attacher([&] {
+      attached = QuoteRingBuffer::attach(name, 5L, TimeUnit::Seconds);
+    });
+
+  /* Size and lay out the segment as the creator does, storing the magic at its start last. */
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(0, ::ftruncate(fd, (off_t)source->getSize()));
+  ::close(fd);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::unique_ptr<SharedMemory> memory(SharedMemory::attach(name));
+  char* target = static_cast<char*>(memory->getAddress());
+  const char* layoutBytes = static_cast<const char*>(source->getAddress());
+  std::memcpy(target + sizeof(uint64_t), layoutBytes + sizeof(uint64_t), source->getSize() - sizeof(uint64_t));
+  reinterpret_cast<std::atomic<uint64_t>*>(target)->store((uint64_t)QuoteRingBuffer::MAGIC);
+  attacher.join();
+  ::shm_unlink(name.c_str());
+
+  ASSERT_EQ(8, attached->getBufferSize());
+  ASSERT_EQ(2, attached->getMaxConsumers());
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldGiveUpAttachingToASegmentThatIsNotLaidOut) {
+  std::unique_ptr<SharedMemory> memory(SharedMemory::create(name, 4096));
+
+  ASSERT_THROW(QuoteRingBuffer::attach(name, 5L, TimeUnit::Milliseconds), std::runtime_error);
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldRegisterConsumersUpToTheLimit) {
+  std::unique_ptr<QuoteRingBuffer> ringBuffer = QuoteRingBuffer::create(name, 8, 2);
+  publish(*ringBuffer, 1L, 1.0);
+
+  const int first = ringBuffer->registerConsumer();
+  const int second = ringBuffer->registerConsumer();
+
+  ASSERT_NE(first, second);
+  ASSERT_EQ(0L, ringBuffer->getConsumerSequence(first));
+  ASSERT_EQ((int)QuoteRingBuffer::NO_CONSUMER_SLOT, ringBuffer->registerConsumer());
+
+  ringBuffer->unregisterConsumer(first);
+
+  ASSERT_EQ(first, ringBuffer->registerConsumer());
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldGatePublishersOnRegisteredConsumers) {
+  std::unique_ptr<QuoteRingBuffer> ringBuffer = QuoteRingBuffer::create(name, 4, 1);
+  const int slot = ringBuffer->registerConsumer();
+
+  for (int i = 0; i < 4; ++i) {
+    publish(*ringBuffer, i, 0.0);
+  }
+
+  std::atomic_bool published(false);
+  std::thread publisher([&] {
+      publish(*ringBuffer, 4L, 0.0);
+      published.store(true);
+    });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_FALSE(published.load());
+
+  ringBuffer->setConsumerSequence(slot, 0L);
+  publisher.join();
+
+  ASSERT_TRUE(published.load());
+  ASSERT_EQ(4L, ringBuffer->getCursor());
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldReclaimTheSlotOfAConsumerWhoseProcessExited) {
+  std::unique_ptr<QuoteRingBuffer> ringBuffer = QuoteRingBuffer::create(name, 4, 1);
+
+  const pid_t pid = ::fork();
+  ASSERT_NE(-1, pid);
+  if (0 == pid) {
+    std::unique_ptr<QuoteRingBuffer> consumer = QuoteRingBuffer::attach(name);
+    ::_exit(QuoteRingBuffer::NO_CONSUMER_SLOT == consumer->registerConsumer() ? 1 : 0);
+  }
+
+  int status;
+  ASSERT_EQ(pid, ::waitpid(pid, &status, 0));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+  ASSERT_EQ((int)QuoteRingBuffer::NO_CONSUMER_SLOT, ringBuffer->registerConsumer());
+
+  for (int i = 0; i < 8; ++i) {
+    publish(*ringBuffer, i, 0.0);
+  }
+
+  ASSERT_EQ(7L, ringBuffer->getCursor());
+  ASSERT_EQ(0, ringBuffer->registerConsumer());
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldKeepTheSlotsOfRunningConsumers) {
+  std::unique_ptr<QuoteRingBuffer> ringBuffer = QuoteRingBuffer::create(name, 4, 1);
+  const int slot = ringBuffer->registerConsumer();
+
+  ASSERT_EQ(0, ringBuffer->reclaimExitedConsumers());
+  ASSERT_EQ((int)QuoteRingBuffer::NO_CONSUMER_SLOT, ringBuffer->registerConsumer());
+
+  ringBuffer->unregisterConsumer(slot);
+
+  ASSERT_EQ(slot, ringBuffer->registerConsumer());
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldReturnTheCursorWhenTheWaitTimesOut) {
+  std::unique_ptr<QuoteRingBuffer> ringBuffer = QuoteRingBuffer::create(name, 4, 1);
+
+  ASSERT_EQ(-1L, ringBuffer->waitFor(0L, 5L, TimeUnit::Milliseconds));
+
+  publish(*ringBuffer, 1L, 1.0);
+
+  ASSERT_EQ(0L, ringBuffer->waitFor(0L, 5L, TimeUnit::Milliseconds));
+}
+
+TEST_F(SharedMemoryRingBufferTest, shouldExchangeEventsWithAnotherProcess) {
+  const long count = 10000L;
+  std::unique_ptr<QuoteRingBuffer> ringBuffer = QuoteRingBuffer::create(name, 64, 1);
+  const int slot = ringBuffer->registerConsumer();
+
+  const pid_t pid = ::fork();
+  ASSERT_NE(-1, pid);
+  if (0 == pid) {
+    std::unique_ptr<QuoteRingBuffer> publisher = QuoteRingBuffer::attach(name);
+    for (long i = 0; i < count; ++i) {
+      publish(*publisher, i, i * 0.5);
+    }
+    ::_exit(0);
+  }
+
+  long nextSequence = 0L;
+  while (nextSequence < count) {
+    const long availableSequence = ringBuffer->waitFor(nextSequence, 5L, TimeUnit::Seconds);
+    ASSERT_LE(nextSequence, availableSequence);
+
+    for (; nextSequence <= availableSequence; ++nextSequence) {
+      ASSERT_EQ(nextSequence, ringBuffer->get(nextSequence).instrument);
+      ASSERT_EQ(nextSequence * 0.5, ringBuffer->get(nextSequence).price);
+    }
+    ringBuffer->setConsumerSequence(slot, availableSequence);
+  }
+
+  int status;
+  ASSERT_EQ(pid, ::waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+}
+
+}
+}
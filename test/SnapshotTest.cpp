@@ -0,0 +1,273 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "SnapshotCoordinator.hpp"
+#include "SnapshotEventHandler.hpp"
+#include "Snapshotable.hpp"
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+#include "Util.hpp"
+
+#include "IllegalStateException.hpp"
+
+#include "support/JournalTestSupport.hpp"
+
+namespace varont {
+namespace test {
+
+class SummingEventHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+    , public Snapshotable
+{
+ public:
+  long count;
+  long sum;
+
+  SummingEventHandler()
+      : count(0L)
+      , sum(0L)
+  { }
+
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    ++count;
+    sum += event.get();
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+
+  void writeSnapshot(std::ostream& out) {
+    out << count << ' ' << sum;
+  }
+
+  void readSnapshot(std::istream& in) {
+    in >> count >> sum;
+  }
+};
+
+class HangingState
+    : public Snapshotable
+{
+ public:
+  void writeSnapshot(std::ostream& out) {
+    std::this_thread::sleep_for(std::chrono::seconds(60));
+  }
+
+  void readSnapshot(std::istream& in) { }
+};
+
+class LargeState
+    : public Snapshotable
+{
+ public:
+  std::vector<char> data;
+
+  LargeState(const std::size_t size)
+      : data(size)
+  {
+    for (std::size_t i = 0; i < size; ++i) {
+      data[i] = (char)(i % 251);
+    }
+  }
+
+  void writeSnapshot(std::ostream& out) {
+    out.write(data.data(), data.size());
+  }
+
+  void readSnapshot(std::istream& in) {
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+};
+
+struct SnapshotTest : public testing::Test {
+ public:
+  TemporaryDirectory directory;
+  SnapshotCoordinator coordinator;
+
+  SingleThreadedClaimStrategy claimStrategy;
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  std::unique_ptr<SequenceBarrier> sequenceBarrier;
+
+  SummingEventHandler firstState;
+  SummingEventHandler secondState;
+  SnapshotEventHandler<StubEvent> firstHandler;
+  SnapshotEventHandler<StubEvent> secondHandler;
+  BatchEventProcessor<StubEvent> firstProcessor;
+  BatchEventProcessor<StubEvent> secondProcessor;
+
+  SnapshotTest()
+      : coordinator(directory.getPath())
+      , claimStrategy(16)
+      , waitStrategy()
+      , ringBuffer(claimStrategy, waitStrategy)
+      , sequenceBarrier(ringBuffer.newBarrier({ }))
+      , firstHandler(firstState, firstState, coordinator, "first")
+      , secondHandler(secondState, secondState, coordinator, "second")
+      , firstProcessor(ringBuffer, *sequenceBarrier, firstHandler)
+      , secondProcessor(ringBuffer, *sequenceBarrier, secondHandler)
+  {
+    ringBuffer.setGatingSequences({ &firstProcessor.getSequence(), &secondProcessor.getSequence() });
+  }
+
+  void publish(const int count) {
+    for (int i = 0; i < count; ++i) {
+      const long sequence = ringBuffer.next();
+      ringBuffer.get(sequence).setValue((int)sequence);
+      ringBuffer.publish(sequence);
+    }
+  }
+
+  bool snapshotDirectoryExists(const long sequence) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "/%020ld.snapshot", sequence);
+    return 0 == ::access((directory.getPath() + name).c_str(), F_OK);
+  }
+
+  void waitForProcessors() {
+    while (firstProcessor.getSequence().get() < ringBuffer.getCursor()
+           || secondProcessor.getSequence().get() < ringBuffer.getCursor()) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+TEST_F(SnapshotTest, shouldSnapshotEveryParticipantAtTheTargetSequence) {
+  std::thread first(std::ref(firstProcessor));
+  std::thread second(std::ref(secondProcessor));
+
+  publish(10);
+  const long target = coordinator.requestSnapshot(ringBuffer);
+  ASSERT_EQ(25L, target);
+  ASSERT_TRUE(coordinator.isPending());
+
+  publish(30);
+  waitForProcessors();
+
+  ASSERT_EQ(SnapshotCoordinator::State::Complete, coordinator.await(5000L));
+  ASSERT_FALSE(coordinator.isPending());
+  ASSERT_EQ((long)SnapshotCoordinator::NO_SNAPSHOT, coordinator.getTargetSequence());
+  ASSERT_EQ(target, coordinator.getLatestSnapshot());
+  ASSERT_EQ(target, SnapshotCoordinator::findLatestSnapshot(directory.getPath()));
+
+  firstProcessor.halt();
+  secondProcessor.halt();
+  first.join();
+  second.join();
+
+  ASSERT_EQ(40L, firstState.count);
+
+  SummingEventHandler restored;
+  SnapshotCoordinator::restore(directory.getPath(), target, "second", restored);
+  ASSERT_EQ(26L, restored.count);
+  ASSERT_EQ(25L * 26L / 2L, restored.sum);
+}
+
+TEST_F(SnapshotTest, shouldFailASnapshotWhoseTargetWasAlreadyPassed) {
+  std::thread first(std::ref(firstProcessor));
+  std::thread second(std::ref(secondProcessor));
+
+  publish(10);
+  waitForProcessors();
+  coordinator.requestSnapshot(5L);
+  publish(1);
+  waitForProcessors();
+
+  ASSERT_EQ(SnapshotCoordinator::State::Failed, coordinator.await(5000L));
+  ASSERT_EQ(-1L, SnapshotCoordinator::findLatestSnapshot(directory.getPath()));
+  ASSERT_FALSE(snapshotDirectoryExists(5L));
+
+  firstProcessor.halt();
+  secondProcessor.halt();
+  first.join();
+  second.join();
+}
+
+TEST_F(SnapshotTest, shouldAllowOnlyOneSnapshotInProgress) {
+  coordinator.requestSnapshot(100L);
+
+  ASSERT_THROW(coordinator.requestSnapshot(200L), IllegalStateException);
+  ASSERT_EQ(SnapshotCoordinator::State::InProgress, coordinator.poll());
+}
+
+TEST_F(SnapshotTest, shouldCancelASnapshotWhoseTargetIsNeverReached) {
+  coordinator.requestSnapshot(100L);
+  ASSERT_TRUE(snapshotDirectoryExists(100L));
+
+  ASSERT_EQ(SnapshotCoordinator::State::InProgress, coordinator.await(10L));
+  ASSERT_EQ(SnapshotCoordinator::State::Failed, coordinator.cancel());
+
+  ASSERT_FALSE(coordinator.isPending());
+  ASSERT_EQ((long)SnapshotCoordinator::NO_SNAPSHOT, coordinator.getTargetSequence());
+  ASSERT_FALSE(snapshotDirectoryExists(100L));
+
+  coordinator.requestSnapshot(200L);
+  ASSERT_TRUE(coordinator.isPending());
+}
+
+TEST_F(SnapshotTest, shouldKillTheChildrenOfACancelledSnapshot) {
+  HangingState hangingState;
+  coordinator.requestSnapshot(5L);
+  coordinator.snapshot("first", 5L, hangingState);
+
+  ASSERT_EQ(SnapshotCoordinator::State::InProgress, coordinator.await(10L));
+
+  const long start = util::nanoTime();
+  ASSERT_EQ(SnapshotCoordinator::State::Failed, coordinator.cancel());
+  ASSERT_GT(5000000000L, util::nanoTime() - start);
+
+  ASSERT_FALSE(coordinator.isPending());
+  ASSERT_FALSE(snapshotDirectoryExists(5L));
+  ASSERT_EQ(SnapshotCoordinator::State::Failed, coordinator.cancel());
+}
+
+TEST_F(SnapshotTest, shouldWriteStateLargerThanTheStreamBuffer) {
+  SnapshotCoordinator largeCoordinator(directory.getPath());
+  largeCoordinator.addParticipant("large");
+  LargeState state(1000000);
+
+  largeCoordinator.requestSnapshot(7L);
+  largeCoordinator.snapshot("large", 7L, state);
+
+  ASSERT_EQ(SnapshotCoordinator::State::Complete, largeCoordinator.await(5000L));
+
+  LargeState restored(0);
+  SnapshotCoordinator::restore(directory.getPath(), 7L, "large", restored);
+  ASSERT_TRUE(state.data == restored.data);
+}
+
+TEST_F(SnapshotTest, shouldRefuseToRestoreAMissingParticipant) {
+  SummingEventHandler restored;
+
+  ASSERT_THROW(SnapshotCoordinator::restore(directory.getPath(), 0L, "first", restored), std::system_error);
+}
+
+}
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+#include "SocketIngress.hpp"
+#include "SocketIngressAdapter.hpp"
+#include "RingBuffer.hpp"
+#include "Sequence.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+
+namespace varont {
+namespace test {
+
+struct PacketEvent {
+  char payload[16];
+  int length;
+  int fd;
+};
+
+class PacketAdapter
+    : public SocketIngressAdapter<PacketEvent>
+{
+ public:
+  std::atomic_int closedFd;
+  std::atomic_int closedError;
+
+  PacketAdapter()
+      : closedFd(-1)
+      , closedError(-1)
+  {}
+
+  char* getPayload(PacketEvent& event) {
+    return event.payload;
+  }
+
+  int getPayloadCapacity() {
+    return sizeof(PacketEvent::payload);
+  }
+
+  void onReceive(PacketEvent& event, int length, int fd) {
+    event.length = length;
+    event.fd = fd;
+  }
+
+  void onClose(int fd, int error) {
+    closedError = error;
+    closedFd = fd;
+  }
+};
+
+struct SocketIngressTest : public testing::Test {
+ public:
+  SingleThreadedClaimStrategy claimStrategy;
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<PacketEvent> ringBuffer;
+  Sequence consumerSequence;
+  PacketAdapter adapter;
+  struct sockaddr_in address;
+  socklen_t addressLength;
+  std::vector<int> fds;
+
+  SocketIngressTest()
+      : claimStrategy(8)
+      , ringBuffer(claimStrategy, waitStrategy)
+      , consumerSequence((long)Sequencer::INITIAL_CURSOR_VALUE)
+      , addressLength(sizeof(address))
+  {
+    ringBuffer.setGatingSequences({ &consumerSequence });
+  }
+
+  ~SocketIngressTest() {
+    for (int fd : fds) {
+      ::close(fd);
+    }
+  }
+
+  int bindLoopback(const int type) {
+    const int fd = ::socket(AF_INET, type, 0);
+    fds.push_back(fd);
+    address = { };
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(fd, (struct sockaddr*)&address, sizeof(address));
+    ::getsockname(fd, (struct sockaddr*)&address, &addressLength);
+    return fd;
+  }
+
+  int connectLoopback(const int type) {
+    const int fd = ::socket(AF_INET, type, 0);
+    fds.push_back(fd);
+    ::connect(fd, (struct sockaddr*)&address, addressLength);
+    return fd;
+  }
+
+  /* Consumes events up to sequence, returning the payloads in order. */
+  std::vector<std::string> consumeTo(const long sequence) {
+    std::vector<std::string> payloads;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (consumerSequence.get() < sequence && std::chrono::steady_clock::now() < deadline) {
+      const long available = std::min(ringBuffer.getCursor(), sequence);
+      for (long next = consumerSequence.get() + 1L; next <= available; ++next) {
+        PacketEvent& event = ringBuffer.get(next);
+        payloads.push_back(std::string(event.payload, event.length));
+      }
+      consumerSequence.set(std::max(available, consumerSequence.get()));
+      std::this_thread::yield();
+    }
+
+    return payloads;
+  }
+};
+
+TEST_F(SocketIngressTest, shouldPublishEachDatagramIntoItsOwnSlot) {
+  const int receiver = bindLoopback(SOCK_DGRAM);
+  const int sender = connectLoopback(SOCK_DGRAM);
+
+  for (int i = 0; i < 20; ++i) {
+    const std::string datagram = "datagram " + std::to_string(i);
+    ::send(sender, datagram.data(), datagram.size(), 0);
+  }
+
+  SocketIngress<PacketEvent> ingress(ringBuffer, adapter, 4);
+  ingress.addSocket(receiver);
+  std::thread thread(std::ref(ingress));
+
+  const std::vector<std::string> payloads = consumeTo(19L);
+  ingress.halt();
+  thread.join();
+
+  ASSERT_EQ(20U, payloads.size());
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_EQ("datagram " + std::to_string(i), payloads[i]);
+  }
+  ASSERT_EQ(receiver, ringBuffer.get(19L).fd);
+  ASSERT_EQ(19L, ringBuffer.getCursor());
+}
+
+TEST_F(SocketIngressTest, shouldPublishOnlyTheSlotsThatWereFilled) {
+  const int receiver = bindLoopback(SOCK_DGRAM);
+  const int sender = connectLoopback(SOCK_DGRAM);
+
+  SocketIngress<PacketEvent> ingress(ringBuffer, adapter, 8);
+  ingress.addSocket(receiver);
+  std::thread thread(std::ref(ingress));
+
+  ::send(sender, "one", 3, 0);
+  ::send(sender, "two", 3, 0);
+  ::send(sender, "three", 5, 0);
+
+  const std::vector<std::string> payloads = consumeTo(2L);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ingress.halt();
+  thread.join();
+
+  ASSERT_EQ(std::vector<std::string>({ "one", "two", "three" }), payloads);
+  ASSERT_EQ(2L, ringBuffer.getCursor());
+}
+
+TEST_F(SocketIngressTest, shouldReceiveAStreamInChunksUntilItIsClosed) {
+  const int listener = bindLoopback(SOCK_STREAM);
+  ::listen(listener, 1);
+  const int sender = connectLoopback(SOCK_STREAM);
+  const int receiver = ::accept(listener, nullptr, nullptr);
+  fds.push_back(receiver);
+
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    expected += std::to_string(i) + ",";
+  }
+
+  SocketIngress<PacketEvent> ingress(ringBuffer, adapter, 4);
+  ingress.addSocket(receiver);
+  std::thread thread(std::ref(ingress));
+
+  ASSERT_EQ((ssize_t)expected.size(), ::send(sender, expected.data(), expected.size(), 0));
+  ::shutdown(sender, SHUT_WR);
+
+  std::string received;
+  long sequence = Sequencer::INITIAL_CURSOR_VALUE;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (received.size() < expected.size() && std::chrono::steady_clock::now() < deadline) {
+    sequence = ringBuffer.getCursor();
+    for (const std::string& chunk : consumeTo(sequence)) {
+      ASSERT_LT(0U, chunk.size());
+      received += chunk;
+    }
+  }
+  while (-1 == adapter.closedFd && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+
+  ingress.halt();
+  thread.join();
+
+  ASSERT_EQ(expected, received);
+  ASSERT_EQ(receiver, adapter.closedFd.load());
+  ASSERT_EQ(0, adapter.closedError.load());
+  ASSERT_EQ(sequence, ringBuffer.getCursor());
+}
+
+TEST_F(SocketIngressTest, shouldHaltWhileWaitingForCapacity) {
+  const int receiver = bindLoopback(SOCK_DGRAM);
+  const int sender = connectLoopback(SOCK_DGRAM);
+
+  for (int i = 0; i < 12; ++i) {
+    ::send(sender, "x", 1, 0);
+  }
+
+  SocketIngress<PacketEvent> ingress(ringBuffer, adapter, 4);
+  ingress.addSocket(receiver);
+  std::thread thread(std::ref(ingress));
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (ringBuffer.getCursor() < 7L && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+
+  ingress.halt();
+  thread.join();
+
+  ASSERT_EQ(7L, ringBuffer.getCursor());
+}
+
+TEST_F(SocketIngressTest, shouldRejectABatchLargerThanTheBuffer) {
+  ASSERT_THROW(SocketIngress<PacketEvent>(ringBuffer, adapter, 9), std::out_of_range);
+}
+
+}
+}
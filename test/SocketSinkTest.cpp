@@ -0,0 +1,217 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+#include "SocketBatchWriter.hpp"
+#include "SocketEncoder.hpp"
+#include "SocketSinkEventHandler.hpp"
+#include "RingBuffer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+class LineEncoder
+    : public SocketEncoder<StubEvent>
+{
+ public:
+  int getMaxEncodedLength() {
+    return 16;
+  }
+
+  void encode(const StubEvent& event, SocketBatchWriter& writer) {
+    char* buffer = writer.reserve(16);
+    writer.commit(std::snprintf(buffer, 16, "%d\n", event.get()));
+  }
+};
+
+struct SocketSinkTest : public testing::Test {
+ public:
+  int fds[2];
+
+  void open(const int type) {
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, type, 0, fds));
+  }
+
+  ~SocketSinkTest() {
+    ::close(fds[0]);
+    ::close(fds[1]);
+  }
+
+  std::string readAvailable() {
+    ::fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    std::string data;
+    char buffer[4096];
+    ssize_t rc;
+    while ((rc = ::read(fds[1], buffer, sizeof(buffer))) > 0) {
+      data.append(buffer, rc);
+    }
+    return data;
+  }
+
+  std::string readExactly(const std::size_t length) {
+    std::string data;
+    char buffer[4096];
+    while (data.size() < length) {
+      const ssize_t rc = ::read(fds[1], buffer, std::min(sizeof(buffer), length - data.size()));
+      if (rc <= 0) {
+        break;
+      }
+      data.append(buffer, rc);
+    }
+    return data;
+  }
+};
+
+TEST_F(SocketSinkTest, shouldWriteReservedAndReferencedDataInOrder) {
+  open(SOCK_STREAM);
+  SocketBatchWriter writer(fds[0], SocketBatchWriter::Mode::Stream);
+  const std::string header = "header:";
+
+  ASSERT_TRUE(writer.add(header.data(), header.size()));
+  char* buffer = writer.reserve(8);
+  ASSERT_NE(nullptr, buffer);
+  std::memcpy(buffer, "one,", 4);
+  writer.commit(4);
+  std::memcpy(writer.reserve(8), "two", 3);
+  writer.commit(3);
+
+  ASSERT_FALSE(writer.isEmpty());
+  ASSERT_EQ(14U, writer.flush());
+  ASSERT_TRUE(writer.isEmpty());
+  ASSERT_EQ("header:one,two", readExactly(14));
+}
+
+TEST_F(SocketSinkTest, shouldResumeAfterAPartialWrite) {
+  open(SOCK_STREAM);
+  const int sendBufferSize = 4096;
+  ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sendBufferSize, sizeof(sendBufferSize));
+  ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+  std::string payload;
+  for (int i = 0; payload.size() < 1024 * 1024; ++i) {
+    payload += std::to_string(i) + ",";
+  }
+
+  SocketBatchWriter writer(fds[0], SocketBatchWriter::Mode::Stream);
+  ASSERT_TRUE(writer.add(payload.data(), payload.size() / 2));
+  ASSERT_TRUE(writer.add(payload.data() + payload.size() / 2, payload.size() - payload.size() / 2));
+
+  const std::size_t written = writer.flush(false);
+  ASSERT_LT(0U, written);
+  ASSERT_GT(payload.size(), written);
+  ASSERT_FALSE(writer.isEmpty());
+
+  std::string received;
+  std::thread reader([&] { received = readExactly(payload.size()); });
+  ASSERT_EQ(payload.size() - written, writer.flush());
+  reader.join();
+
+  ASSERT_TRUE(writer.isEmpty());
+  ASSERT_EQ(payload, received);
+}
+
+TEST_F(SocketSinkTest, shouldSendEachMessageAsADatagram) {
+  open(SOCK_DGRAM);
+  SocketBatchWriter writer(fds[0], SocketBatchWriter::Mode::Datagram);
+  const std::string parts[] = { "a", "bc", "def", "g" };
+
+  writer.add(parts[0].data(), parts[0].size());
+  writer.add(parts[1].data(), parts[1].size());
+  writer.endMessage();
+  writer.add(parts[2].data(), parts[2].size());
+  writer.endMessage();
+  writer.add(parts[3].data(), parts[3].size());
+
+  ASSERT_EQ(3U, writer.flush());
+
+  char buffer[16];
+  ASSERT_EQ(3, ::recv(fds[1], buffer, sizeof(buffer), 0));
+  ASSERT_EQ("abc", std::string(buffer, 3));
+  ASSERT_EQ(3, ::recv(fds[1], buffer, sizeof(buffer), 0));
+  ASSERT_EQ("def", std::string(buffer, 3));
+  ASSERT_EQ(1, ::recv(fds[1], buffer, sizeof(buffer), 0));
+  ASSERT_EQ("g", std::string(buffer, 1));
+}
+
+TEST_F(SocketSinkTest, shouldSendEventsFromTheBatchEventProcessor) {
+  open(SOCK_STREAM);
+  SocketBatchWriter writer(fds[0], SocketBatchWriter::Mode::Stream, 8, 64);
+  LineEncoder encoder;
+  SocketSinkEventHandler<StubEvent> handler(writer, encoder);
+
+  SingleThreadedClaimStrategy claimStrategy(64);
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer(claimStrategy, waitStrategy);
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    expected += std::to_string(i) + "\n";
+  }
+
+  std::string received;
+  std::thread reader([&] { received = readExactly(expected.size()); });
+  std::thread thread(std::ref(batchEventProcessor));
+
+  for (int i = 0; i < 100; ++i) {
+    const long sequence = ringBuffer.next();
+    ringBuffer.get(sequence).setValue(i);
+    ringBuffer.publish(sequence);
+  }
+
+  reader.join();
+  batchEventProcessor.halt();
+  thread.join();
+
+  ASSERT_EQ(expected, received);
+}
+
+TEST_F(SocketSinkTest, shouldFlushALongBatchAfterTheTimeout) {
+  open(SOCK_STREAM);
+  SocketBatchWriter writer(fds[0], SocketBatchWriter::Mode::Stream);
+  LineEncoder encoder;
+  SocketSinkEventHandler<StubEvent> handler(writer, encoder, 1000000L);
+  StubEvent event(1);
+
+  handler.onEvent(event, 0L, false);
+  ASSERT_EQ("", readAvailable());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  handler.onEvent(event, 1L, false);
+
+  ASSERT_EQ("1\n1\n", readAvailable());
+}
+
+}
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "RingBuffer.hpp"
+#include "Sequence.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+#include "SpillBuffer.hpp"
+#include "SpillingPublisher.hpp"
+
+#include "support/JournalTestSupport.hpp"
+
+namespace varont {
+namespace test {
+
+struct SpillingPublisherTest : public testing::Test {
+ public:
+  SingleThreadedClaimStrategy claimStrategy;
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  Sequence gatingSequence;
+  StubEventSerializer serializer;
+  TemporaryDirectory directory;
+
+  SpillingPublisherTest()
+      : claimStrategy(4)
+      , ringBuffer(claimStrategy, waitStrategy)
+      , gatingSequence((long)Sequencer::INITIAL_CURSOR_VALUE)
+  {
+    ringBuffer.setGatingSequences({ &gatingSequence });
+  }
+
+  /* Consumes every event up to the cursor, returning their values. */
+  std::vector<int> consume() {
+    std::vector<int> values;
+    const long cursor = ringBuffer.getCursor();
+    for (long sequence = gatingSequence.get() + 1L; sequence <= cursor; ++sequence) {
+      values.push_back(ringBuffer.get(sequence).get());
+    }
+    gatingSequence.set(cursor);
+    return values;
+  }
+};
+
+TEST_F(SpillingPublisherTest, shouldRemoveTheOverflowFileFromTheDirectory) {
+  SpillBuffer spillBuffer(directory.getPath(), 4096);
+
+  ASSERT_EQ(-1, ::access(spillBuffer.getPath().c_str(), F_OK));
+  ASSERT_TRUE(spillBuffer.isEmpty());
+}
+
+TEST_F(SpillingPublisherTest, shouldWrapRecordsAroundTheEndOfTheFile) {
+  SpillBuffer spillBuffer(directory.getPath(), 4096);
+  const std::vector<char> record(1000, 'x');
+  const std::vector<char> wrapped(1000, 'y');
+
+  /* Each record takes 1008 bytes, so four fit and leave only 64 at the end. */
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(spillBuffer.append(record.data(), (int)record.size()));
+  }
+  ASSERT_FALSE(spillBuffer.append(record.data(), (int)record.size()));
+
+  spillBuffer.pop();
+  ASSERT_TRUE(spillBuffer.append(wrapped.data(), (int)wrapped.size()));
+  ASSERT_FALSE(spillBuffer.append(record.data(), (int)record.size()));
+
+  int length;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ('x', *spillBuffer.peek(length));
+    spillBuffer.pop();
+  }
+
+  ASSERT_EQ('y', *spillBuffer.peek(length));
+  ASSERT_EQ(1000, length);
+  spillBuffer.pop();
+  ASSERT_TRUE(spillBuffer.isEmpty());
+  ASSERT_TRUE(spillBuffer.append(record.data(), (int)record.size()));
+}
+
+TEST_F(SpillingPublisherTest, shouldRejectAThresholdOutsideTheBuffer) {
+  ASSERT_THROW(SpillingPublisher<StubEvent>(ringBuffer, serializer, directory.getPath(), 0L, 4096), std::out_of_range);
+  ASSERT_THROW(SpillingPublisher<StubEvent>(ringBuffer, serializer, directory.getPath(), 5L, 4096), std::out_of_range);
+}
+
+TEST_F(SpillingPublisherTest, shouldSpillBelowTheThresholdAndRefillInOrder) {
+  SpillingPublisher<StubEvent> publisher(ringBuffer, serializer, directory.getPath(), 2L, 4096);
+
+  ASSERT_TRUE(publisher.publishEvent(StubEvent(0)));
+  ASSERT_TRUE(publisher.publishEvent(StubEvent(1)));
+  ASSERT_TRUE(publisher.publishEvent(StubEvent(2)));
+  ASSERT_FALSE(publisher.publishEvent(StubEvent(3)));
+  ASSERT_FALSE(publisher.publishEvent(StubEvent(4)));
+
+  ASSERT_EQ(2L, ringBuffer.getCursor());
+  ASSERT_EQ(2L, publisher.getSpilledCount());
+  ASSERT_EQ(2L, publisher.getMetrics().spilled.get());
+
+  ASSERT_EQ(std::vector<int>({ 0, 1, 2 }), consume());
+
+  /* There is capacity again, so the spilled events are refilled ahead of the new one. */
+  ASSERT_TRUE(publisher.publishEvent(StubEvent(5)));
+  ASSERT_EQ(std::vector<int>({ 3, 4, 5 }), consume());
+  ASSERT_EQ(0L, publisher.getSpilledCount());
+
+  ASSERT_TRUE(publisher.publishEvent(StubEvent(6)));
+  ASSERT_EQ(std::vector<int>({ 6 }), consume());
+}
+
+TEST_F(SpillingPublisherTest, shouldRefillWhenIdle) {
+  SpillingPublisher<StubEvent> publisher(ringBuffer, serializer, directory.getPath(), 1L, 4096);
+
+  for (int i = 0; i < 6; ++i) {
+    publisher.publishEvent(StubEvent(i));
+  }
+  ASSERT_EQ(0, publisher.refill());
+  ASSERT_EQ(std::vector<int>({ 0, 1, 2, 3 }), consume());
+
+  ASSERT_EQ(2, publisher.refill());
+  ASSERT_EQ(std::vector<int>({ 4, 5 }), consume());
+}
+
+TEST_F(SpillingPublisherTest, shouldBlockWhenTheOverflowFileIsFull) {
+  SpillingPublisher<StubEvent> publisher(ringBuffer, serializer, directory.getPath(), 1L, 4096);
+  std::atomic_bool stop(false);
+  std::vector<int> values;
+
+  std::thread consumer([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    while (!stop.load() || gatingSequence.get() < ringBuffer.getCursor()) {
+      std::vector<int> batch = consume();
+      values.insert(values.end(), batch.begin(), batch.end());
+    }
+  });
+
+  /* 16 byte records: 4 fit in the ring buffer and 256 in the file before it blocks. */
+  for (int i = 0; i < 1000; ++i) {
+    publisher.publishEvent(StubEvent(i));
+  }
+  publisher.drain();
+  stop.store(true);
+  consumer.join();
+
+  ASSERT_EQ(1000u, values.size());
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(i, values[i]);
+  }
+}
+
+}
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Trace.hpp"
+#include "RingBuffer.hpp"
+#include "Sequencer.hpp"
+#include "BatchEventProcessor.hpp"
+#include "LifecycleAwareEventHandler.hpp"
+#include "ProcessingSequenceBarrier.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "SleepingWaitStrategy.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+using trace::Record;
+using trace::TracePoint;
+
+class HaltingEventHandler
+    : public LifecycleAwareEventHandler<StubEvent>
+{
+  BatchEventProcessor<StubEvent>*& processor_;
+  const long lastSequence_;
+
+ public:
+  HaltingEventHandler(BatchEventProcessor<StubEvent>*& processor, const long lastSequence)
+      : processor_(processor)
+      , lastSequence_(lastSequence)
+  {}
+
+  void onEvent(StubEvent& event, long sequence, bool endOfBatch) {
+    if (lastSequence_ == sequence) {
+      processor_->halt();
+    }
+  }
+
+  void onStart() { }
+  void onShutdown() { }
+};
+
+struct TraceTest : public testing::Test {
+ public:
+  TraceTest() {
+    trace::clear();
+  }
+
+  static std::vector<Record> collect(const TracePoint point) {
+    std::vector<Record> records = trace::collect();
+    records.erase(std::remove_if(records.begin(), records.end(), [point](const Record& record) {
+          return point != record.point;
+        }), records.end());
+    return records;
+  }
+};
+
+TEST_F(TraceTest, shouldCollectRecordsInTimestampOrder) {
+  trace::record(TracePoint::next, 0L, 1L);
+  std::thread thread([] { trace::record(TracePoint::publish, 0L, 1L); });
+  thread.join();
+  trace::record(TracePoint::next, 1L, 1L);
+
+  std::vector<Record> records = trace::collect();
+
+  ASSERT_EQ(3U, records.size());
+  ASSERT_EQ(TracePoint::next, records[0].point);
+  ASSERT_EQ(TracePoint::publish, records[1].point);
+  ASSERT_EQ(TracePoint::next, records[2].point);
+  ASSERT_NE(records[0].thread, records[1].thread);
+  ASSERT_EQ(records[0].thread, records[2].thread);
+  ASSERT_LE(records[0].timestamp, records[1].timestamp);
+  ASSERT_LE(records[1].timestamp, records[2].timestamp);
+}
+
+TEST_F(TraceTest, shouldKeepOnlyTheMostRecentRecords) {
+  const long count = trace::ThreadRing::SIZE + 10L;
+  for (long i = 0; i < count; ++i) {
+    trace::record(TracePoint::next, i, 1L);
+  }
+
+  std::vector<Record> records = trace::collect();
+
+  ASSERT_EQ((std::size_t)trace::ThreadRing::SIZE, records.size());
+  ASSERT_EQ(10L, records.front().arg0);
+  ASSERT_EQ(count - 1L, records.back().arg0);
+}
+
+TEST_F(TraceTest, shouldTraceNextAndPublish) {
+#ifndef VARONT_ENABLE_TRACE
+  GTEST_SKIP() << "trace points are compiled out; configure with --enable-trace";
+#endif
+  SingleThreadedClaimStrategy claimStrategy(16);
+  SleepingWaitStrategy waitStrategy;
+  Sequencer sequencer(claimStrategy, waitStrategy);
+  Sequence gatingSequence(Sequencer::INITIAL_CURSOR_VALUE);
+  sequencer.setGatingSequences({ &gatingSequence });
+
+  const long sequence = sequencer.next(2);
+  sequencer.publish(sequence, 2);
+
+  std::vector<Record> nexts = collect(TracePoint::next);
+  std::vector<Record> publishes = collect(TracePoint::publish);
+  ASSERT_EQ(1U, nexts.size());
+  ASSERT_EQ(1L, nexts[0].arg0);
+  ASSERT_EQ(2L, nexts[0].arg1);
+  ASSERT_EQ(1U, publishes.size());
+  ASSERT_EQ(1L, publishes[0].arg0);
+  ASSERT_EQ(2L, publishes[0].arg1);
+}
+
+TEST_F(TraceTest, shouldTraceWaitForEntryAndExit) {
+#ifndef VARONT_ENABLE_TRACE
+  GTEST_SKIP() << "trace points are compiled out; configure with --enable-trace";
+#endif
+  SleepingWaitStrategy waitStrategy;
+  Sequence cursor(4L);
+  std::vector<Sequence*> dependents;
+  ProcessingSequenceBarrier sequenceBarrier(waitStrategy, cursor, dependents);
+
+  ASSERT_EQ(4L, sequenceBarrier.waitFor(2L, std::nothrow));
+
+  std::vector<Record> entries = collect(TracePoint::wait_for_entry);
+  std::vector<Record> exits = collect(TracePoint::wait_for_exit);
+  ASSERT_EQ(1U, entries.size());
+  ASSERT_EQ(2L, entries[0].arg0);
+  ASSERT_EQ(1U, exits.size());
+  ASSERT_EQ(2L, exits[0].arg0);
+  ASSERT_EQ(4L, exits[0].arg1);
+}
+
+TEST_F(TraceTest, shouldTraceBatchesOfTheBatchEventProcessor) {
+#ifndef VARONT_ENABLE_TRACE
+  GTEST_SKIP() << "trace points are compiled out; configure with --enable-trace";
+#endif
+  SingleThreadedClaimStrategy claimStrategy(16);
+  SleepingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer(claimStrategy, waitStrategy);
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+
+  BatchEventProcessor<StubEvent>* processor = nullptr;
+  HaltingEventHandler handler(processor, 2L);
+  BatchEventProcessor<StubEvent> batchEventProcessor(ringBuffer, *sequenceBarrier, handler);
+  processor = &batchEventProcessor;
+  ringBuffer.setGatingSequences({ &batchEventProcessor.getSequence() });
+
+  for (int i = 0; i < 3; ++i) {
+    ringBuffer.publish(ringBuffer.next());
+  }
+
+  std::thread thread(std::ref(batchEventProcessor));
+  thread.join();
+
+  std::vector<Record> starts = collect(TracePoint::batch_start);
+  std::vector<Record> ends = collect(TracePoint::batch_end);
+  ASSERT_EQ(1U, starts.size());
+  ASSERT_EQ(0L, starts[0].arg0);
+  ASSERT_EQ(2L, starts[0].arg1);
+  ASSERT_EQ(1U, ends.size());
+  ASSERT_EQ(2L, ends[0].arg0);
+  ASSERT_LE(starts[0].timestamp, ends[0].timestamp);
+}
+
+TEST_F(TraceTest, shouldWriteOneLinePerRecord) {
+  trace::record(TracePoint::park, 0L, 0L);
+  trace::record(TracePoint::wake, 0L, 0L);
+
+  std::ostringstream out;
+  trace::writeText(out);
+
+  const std::string text = out.str();
+  ASSERT_EQ(2, std::count(text.begin(), text.end(), '\n'));
+  ASSERT_NE(std::string::npos, text.find(" park 0 0\n"));
+  ASSERT_NE(std::string::npos, text.find(" wake 0 0\n"));
+}
+
+}
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <new>
+
+#include <gtest/gtest.h>
+
+#include "YieldingWaitStrategy.hpp"
+#include "AlertException.hpp"
+#include "SingleThreadedClaimStrategy.hpp"
+#include "RingBuffer.hpp"
+
+#include "support/StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+struct YieldingWaitStrategyTest : public testing::Test {
+ public:
+  SingleThreadedClaimStrategy claimStrategy;
+  YieldingWaitStrategy waitStrategy;
+  RingBuffer<StubEvent> ringBuffer;
+  Sequence gatingSequence;
+
+  YieldingWaitStrategyTest()
+      : claimStrategy(16)
+      , waitStrategy()
+      , ringBuffer(claimStrategy, waitStrategy)
+      , gatingSequence(Sequencer::INITIAL_CURSOR_VALUE)
+  {
+    ringBuffer.setGatingSequences({ &gatingSequence });
+  }
+};
+
+TEST_F(YieldingWaitStrategyTest, shouldWaitForPublishedSequence) {
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+
+  std::thread publisher([this] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      ringBuffer.publish(ringBuffer.next());
+    });
+
+  ASSERT_EQ(0L, sequenceBarrier->waitFor(0L));
+  publisher.join();
+}
+
+TEST_F(YieldingWaitStrategyTest, shouldWaitForDependentSequence) {
+  Sequence dependentSequence(Sequencer::INITIAL_CURSOR_VALUE);
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ &dependentSequence });
+  ringBuffer.publish(ringBuffer.next());
+  ringBuffer.publish(ringBuffer.next());
+
+  std::thread dependent([&dependentSequence] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      dependentSequence.set(1L);
+    });
+
+  ASSERT_EQ(1L, sequenceBarrier->waitFor(1L));
+  dependent.join();
+}
+
+TEST_F(YieldingWaitStrategyTest, shouldReturnCursorWhenTimeoutElapses) {
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ((long)Sequencer::INITIAL_CURSOR_VALUE, sequenceBarrier->waitFor(0L, 10L, TimeUnit::Milliseconds));
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  ASSERT_LE(std::chrono::milliseconds(10), elapsed);
+  ASSERT_GT(std::chrono::milliseconds(2000), elapsed);
+}
+
+TEST_F(YieldingWaitStrategyTest, shouldConvertTimeoutToSourceUnit) {
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ((long)Sequencer::INITIAL_CURSOR_VALUE, sequenceBarrier->waitFor(0L, 20000000L, TimeUnit::Nanoseconds));
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  ASSERT_LE(std::chrono::milliseconds(20), elapsed);
+  ASSERT_GT(std::chrono::milliseconds(2000), elapsed);
+}
+
+TEST_F(YieldingWaitStrategyTest, shouldReturnWhenAlerted) {
+  std::unique_ptr<SequenceBarrier> sequenceBarrier = ringBuffer.newBarrier({ });
+
+  std::thread alerter([&sequenceBarrier] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      sequenceBarrier->alert();
+    });
+
+  ASSERT_EQ((long)SequenceBarrier::ALERTED, sequenceBarrier->waitFor(0L, std::nothrow));
+  alerter.join();
+
+  ASSERT_THROW(sequenceBarrier->waitFor(0L), AlertException);
+  ASSERT_THROW(sequenceBarrier->waitFor(0L, 10L, TimeUnit::Milliseconds), AlertException);
+}
+
+}
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2012 Leonard Clark
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __VARONT_TEST_JOURNALTESTSUPPORT_HPP__
+#define __VARONT_TEST_JOURNALTESTSUPPORT_HPP__
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "Journal.hpp"
+#include "JournalSerializer.hpp"
+
+#include "StubEvent.hpp"
+
+namespace varont {
+namespace test {
+
+/**
+ * Directory under /tmp removed, with the files in it, on destruction.
+ */
+class TemporaryDirectory {
+  std::string path_;
+
+ public:
+  TemporaryDirectory() {
+    char path[] = "/tmp/varont-test-XXXXXX";
+    if (nullptr == ::mkdtemp(path)) {
+      throw std::runtime_error("mkdtemp failed");
+    }
+    path_ = path;
+  }
+
+  ~TemporaryDirectory() {
+    remove(path_);
+  }
+
+  const std::string& getPath() const {
+    return path_;
+  }
+
+ private:
+  static void remove(const std::string& path) {
+    if (DIR* dir = ::opendir(path.c_str())) {
+      while (struct dirent* entry = ::readdir(dir)) {
+        const std::string name = entry->d_name;
+        if ("." != name && ".." != name) {
+          remove(path + "/" + name);
+        }
+      }
+      ::closedir(dir);
+      ::rmdir(path.c_str());
+    }
+    else {
+      ::unlink(path.c_str());
+    }
+  }
+};
+
+class StubEventSerializer
+    : public JournalSerializer<StubEvent>
+{
+ public:
+  int serialize(const StubEvent& event, char* buffer, int capacity) {
+    const int value = event.get();
+    if (capacity < (int)sizeof(value)) {
+      return -1;
+    }
+    std::memcpy(buffer, &value, sizeof(value));
+    return sizeof(value);
+  }
+
+  void deserialize(const char* data, int length, StubEvent& event) {
+    int value;
+    std::memcpy(&value, data, sizeof(value));
+    event.setValue(value);
+  }
+};
+
+/**
+ * Read the sequences of the valid records of every segment in a journal directory.
+ */
+inline std::vector<long> readJournalSequences(const std::string& directory) {
+  std::vector<long> sequences;
+  for (const std::string& path : Journal::listSegments(directory)) {
+    std::ifstream in(path, std::ios::binary);
+    const std::string segment((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::size_t offset = 0;
+    while (const Journal::RecordHeader* header = Journal::getRecord(segment.data(), segment.size(), offset)) {
+      sequences.push_back(header->sequence);
+      offset += Journal::getRecordLength(header->length);
+    }
+  }
+  return sequences;
+}
+
+}
+}
+
+#endif /* __VARONT_TEST_JOURNALTESTSUPPORT_HPP__ */